@@ -0,0 +1,104 @@
+#include "BatchBench.hpp"
+#include "service/AudioService.hpp"
+#include "worker/WorkerManager.hpp"
+#include "worker/WorkerMain.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace app { namespace bench {
+
+using namespace app::worker;
+
+namespace {
+
+constexpr int WORKERS = 2;
+constexpr int CLIENTS = 16;
+constexpr int REQUESTS_PER_CLIENT = 100;
+const uint32_t BATCH_SIZES[] = {1, 4, 8, 16};
+const uint32_t LINGERS_US[] = {0, 200, 500};
+
+struct Point {
+    double requestsPerSec;
+    double p50Us;
+    double p99Us;
+};
+
+Point measure(uint32_t batchMax, uint32_t lingerUs, const oatpp::String& clip) {
+    IpcConfig config;
+    config.batchMax = batchMax;
+    config.batchLingerUs = lingerUs;
+    config.featureCacheBytes = 0; // the same clip every time: measure the mel pass, not the cache
+    auto manager = std::make_shared<WorkerManager>(config);
+    manager->start(0, nullptr);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < WORKERS; ++i) {
+        workers.emplace_back([] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            runWorker();
+        });
+    }
+    service::AudioService service(manager);
+    service.extractFeatures(clip); // warm up (and wait for the workers to attach)
+
+    std::vector<std::vector<double>> latencies(CLIENTS);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < CLIENTS; ++c) {
+        clients.emplace_back([&, c] {
+            latencies[c].reserve(REQUESTS_PER_CLIENT);
+            for (int i = 0; i < REQUESTS_PER_CLIENT; ++i) {
+                auto t0 = std::chrono::steady_clock::now();
+                service.extractFeatures(clip);
+                auto t1 = std::chrono::steady_clock::now();
+                latencies[c].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+            }
+        });
+    }
+    for (auto& th : clients) th.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int i = 0; i < WORKERS; ++i) {
+        manager->sendShutdownSignal();
+    }
+    for (auto& th : workers) th.join();
+    manager->stop();
+
+    std::vector<double> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    return Point{all.size() / seconds, all[all.size() / 2], all[all.size() * 99 / 100]};
+}
+
+}
+
+void runBatchBench(BenchReport& report) {
+    // 250 ms of 16 kHz PCM16 noise: short enough that several fit one batch (BATCH_MAX_SAMPLES)
+    std::vector<int16_t> pcm(4000);
+    uint32_t seed = 1;
+    for (auto& s : pcm) {
+        seed = seed * 1664525u + 1013904223u;
+        s = (int16_t)(seed >> 16);
+    }
+    oatpp::String clip(reinterpret_cast<const char*>(pcm.data()), pcm.size() * sizeof(int16_t));
+
+    std::printf("batching: 250 ms clips, %d clients x %d requests, %d workers\n", CLIENTS, REQUESTS_PER_CLIENT, WORKERS);
+    std::printf("%6s %10s %12s %10s %10s\n", "batch", "linger us", "req/s", "p50 us", "p99 us");
+
+    for (uint32_t batch : BATCH_SIZES) {
+        for (uint32_t linger : LINGERS_US) {
+            if (batch == 1 && linger > 0) continue; // linger only matters when batching
+            Point p = measure(batch, linger, clip);
+            std::printf("%6u %10u %12.1f %10.1f %10.1f\n", batch, linger, p.requestsPerSec, p.p50Us, p.p99Us);
+            report.add("batching", "extract_250ms",
+                       {{"batch_max", batch}, {"linger_us", linger}, {"clients", CLIENTS}, {"workers", WORKERS}},
+                       {{"requests_per_s", p.requestsPerSec}, {"p50_us", p.p50Us}, {"p99_us", p.p99Us}});
+        }
+    }
+}
+
+}}
@@ -0,0 +1,17 @@
+#ifndef BatchBench_hpp
+#define BatchBench_hpp
+
+#include "BenchReport.hpp"
+
+namespace app { namespace bench {
+
+/**
+ * Worker micro-batching: throughput and latency of short (250 ms) feature requests from
+ * a fixed pool of closed-loop clients, across batch size x linger time.
+ * Workers run as threads in this process, same as AudioServiceTest.
+ */
+void runBatchBench(BenchReport& report);
+
+}}
+
+#endif // BatchBench_hpp
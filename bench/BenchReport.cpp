@@ -0,0 +1,135 @@
+#include "BenchReport.hpp"
+#include "worker/cpu/MelKernels.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace app { namespace bench {
+
+namespace {
+
+void appendString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void appendNumber(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        out += "null"; // JSON has no inf / nan
+        return;
+    }
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.10g", value);
+    out += number;
+}
+
+void appendValues(std::string& out, const BenchReport::Values& values) {
+    out += '{';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) out += ',';
+        appendString(out, values[i].first);
+        out += ':';
+        appendNumber(out, values[i].second);
+    }
+    out += '}';
+}
+
+const char* compiler() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+const char* buildType() {
+#ifdef WHISPER_BUILD_TYPE
+    return WHISPER_BUILD_TYPE;
+#else
+    return "";
+#endif
+}
+
+const char* backend() {
+#ifdef WHISPER_ENABLE_CUDA
+    return "cuda";
+#else
+    return "cpu";
+#endif
+}
+
+}
+
+void BenchReport::add(const char* suite, const std::string& name, Values params, Values metrics) {
+    m_results.push_back(Result{suite, name, std::move(params), std::move(metrics)});
+}
+
+std::string BenchReport::toJson() const {
+    std::string out;
+    out += "{\"schema\":1,\"label\":";
+    appendString(out, m_label);
+    out += ",\"timestamp\":";
+    appendNumber(out, (double)std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    out += ",\"build\":{\"compiler\":";
+    appendString(out, compiler());
+    out += ",\"build_type\":";
+    appendString(out, buildType());
+    out += ",\"backend\":";
+    appendString(out, backend());
+    out += ",\"mel_kernels\":";
+    appendString(out, worker::cpu::selectKernels().name);
+    out += ",\"hardware_threads\":";
+    appendNumber(out, std::thread::hardware_concurrency());
+    out += "},\n\"results\":[";
+
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        const Result& result = m_results[i];
+        out += i > 0 ? ",\n" : "\n";
+        out += "{\"suite\":";
+        appendString(out, result.suite);
+        out += ",\"name\":";
+        appendString(out, result.name);
+        out += ",\"params\":";
+        appendValues(out, result.params);
+        out += ",\"metrics\":";
+        appendValues(out, result.metrics);
+        out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool BenchReport::writeJson(const char* path) const {
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) {
+        std::fprintf(stderr, "Can't write %s\n", path);
+        return false;
+    }
+    std::string json = toJson();
+    bool ok = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::fprintf(stderr, "Can't write %s\n", path);
+    }
+    return ok;
+}
+
+}}
@@ -0,0 +1,47 @@
+#ifndef BenchReport_hpp
+#define BenchReport_hpp
+
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace app { namespace bench {
+
+/**
+ * Collects every measurement of a my-bench run for the --json output, next to the
+ * tables on stdout. One result is a suite ("ring", "mel", ...), a case name, the
+ * parameters it ran with and what it measured; names carry their unit (p99_ns, frames_per_s).
+ * The document also records the build, so two runs can be told apart when compared.
+ */
+class BenchReport {
+public:
+    typedef std::vector<std::pair<std::string, double>> Values;
+
+    struct Result {
+        std::string suite;
+        std::string name;
+        Values params;
+        Values metrics;
+    };
+
+private:
+    std::string m_label;
+    std::vector<Result> m_results;
+
+public:
+    explicit BenchReport(std::string label = std::string()) : m_label(std::move(label)) {}
+
+    void add(const char* suite, const std::string& name, Values params, Values metrics);
+
+    const std::vector<Result>& results() const { return m_results; }
+
+    std::string toJson() const;
+
+    // False (and a message on stderr) if the file can't be written
+    bool writeJson(const char* path) const;
+};
+
+}}
+
+#endif // BenchReport_hpp
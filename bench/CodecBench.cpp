@@ -0,0 +1,106 @@
+#include "CodecBench.hpp"
+#include "service/FeatureFormat.hpp"
+#include "service/PcmConvert.hpp"
+#include "dto/AudioFeatureDto.hpp"
+#include "utils/FloatJson.hpp"
+#include "worker/cpu/MelEngine.hpp"
+
+#include "oatpp/parser/json/mapping/ObjectMapper.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace app { namespace bench {
+
+using namespace app::worker;
+using namespace app::service;
+
+namespace {
+
+constexpr size_t CLIP_SAMPLES = 30 * 16000;
+constexpr int PCM_RUNS = 200;
+constexpr int ENCODE_RUNS = 20;
+
+// Mean over the runs: single-threaded, nothing to wait on
+template<typename Body>
+double nsPerRun(int runs, Body body) {
+    body(); // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) {
+        body();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs;
+}
+
+}
+
+void runCodecBench(BenchReport& report) {
+    std::vector<int16_t> pcm(CLIP_SAMPLES);
+    uint32_t seed = 3;
+    for (auto& s : pcm) {
+        seed = seed * 1664525u + 1013904223u;
+        s = (int16_t)(seed >> 16);
+    }
+    std::vector<float> audio(CLIP_SAMPLES);
+
+    std::printf("codec: PCM16 conversion of %zu s, responses for its %zu frames\n",
+                CLIP_SAMPLES / 16000, numFrames(CLIP_SAMPLES));
+    std::printf("%-16s %12s %12s %12s\n", "case", "ms", "MB/s out", "bytes");
+
+    double pcmNs = nsPerRun(PCM_RUNS, [&] {
+        convertPcm16(pcm.data(), pcm.size(), audio.data());
+    });
+    std::printf("%-16s %12.3f %12.0f %12zu\n", "pcm16_to_f32", pcmNs / 1e6, audio.size() * sizeof(float) / (pcmNs / 1e3),
+                audio.size() * sizeof(float));
+    report.add("codec", "pcm16_to_f32", {{"samples", (double)CLIP_SAMPLES}},
+               {{"ns_per_sample", pcmNs / CLIP_SAMPLES}, {"ms", pcmNs / 1e6}});
+
+    // Real log-mel values, so the JSON has realistic digit counts
+    std::vector<float> features(numFrames(CLIP_SAMPLES) * N_MELS);
+    cpu::MelEngine engine;
+    engine.compute(audio.data(), audio.size(), features.data());
+
+    auto add = [&](const char* name, double ns, size_t bytes) {
+        std::printf("%-16s %12.3f %12.0f %12zu\n", name, ns / 1e6, bytes / (ns / 1e3), bytes);
+        report.add("codec", name, {{"frames", (double)numFrames(CLIP_SAMPLES)}},
+                   {{"ms", ns / 1e6}, {"bytes", (double)bytes}, {"mb_per_s", bytes / (ns / 1e3)}});
+    };
+
+    // What /audio/stream answers by default: the DTO through the server's ObjectMapper setup
+    auto mapper = oatpp::parser::json::mapping::ObjectMapper::createShared();
+    mapper->getSerializer()->setSerializerMethod(app::dto::FloatVector::Class::CLASS_ID, &app::dto::serializeFloatVector);
+    auto dto = app::dto::AudioFeatureDto::createShared();
+    dto->features = app::dto::FloatArray::view(features.data(), features.size(), nullptr);
+    dto->sample_count = (v_int64)CLIP_SAMPLES;
+    oatpp::String json;
+    double dtoNs = nsPerRun(ENCODE_RUNS, [&] {
+        json = mapper->writeToString(dto);
+    });
+    add("json_dto", dtoNs, json->size());
+
+    std::string out;
+    double arrayNs = nsPerRun(ENCODE_RUNS, [&] {
+        out.clear();
+        utils::FloatJson::appendArray(out, features.data(), features.size());
+    });
+    add("json_array", arrayNs, out.size());
+
+    const struct { const char* name; FeatureFormat format; } BINARY[] = {
+        {"raw_f32", {FeatureEncoding::RAW, FeatureDtype::FLOAT32}},
+        {"raw_f16", {FeatureEncoding::RAW, FeatureDtype::FLOAT16}},
+        {"raw_bf16", {FeatureEncoding::RAW, FeatureDtype::BFLOAT16}},
+        {"npy_f32", {FeatureEncoding::NPY, FeatureDtype::FLOAT32}},
+    };
+    for (const auto& binary : BINARY) {
+        const FeatureFormat& format = binary.format;
+        double ns = nsPerRun(ENCODE_RUNS, [&] {
+            out.clear();
+            encodeFeatures(features.data(), features.size(), format, out);
+        });
+        add(binary.name, ns, out.size());
+    }
+}
+
+}}
@@ -0,0 +1,18 @@
+#ifndef CodecBench_hpp
+#define CodecBench_hpp
+
+#include "BenchReport.hpp"
+
+namespace app { namespace bench {
+
+/**
+ * Host-side encoding on both ends of a request: PCM16 -> float conversion of the body,
+ * and the response for 30 s of features (3000 frames) as JSON (the AudioFeatureDto
+ * through the ObjectMapper, and the bare FloatJson array NDJSON lines use) vs. the
+ * binary formats of FeatureFormat.
+ */
+void runCodecBench(BenchReport& report);
+
+}}
+
+#endif // CodecBench_hpp
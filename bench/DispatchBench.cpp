@@ -0,0 +1,95 @@
+#include "DispatchBench.hpp"
+#include "worker/CompletionTable.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace app { namespace bench {
+
+using namespace app::worker;
+
+namespace {
+
+constexpr int OPS_PER_THREAD = 200000;
+const int THREAD_COUNTS[] = {1, 4, 16};
+
+// What WorkerManager did before the completion table
+class MapDispatch {
+private:
+    std::mutex m_mutex;
+    std::map<uint64_t, std::shared_ptr<TaskCompletion>> m_pending;
+    std::atomic<uint64_t> m_counter{1};
+public:
+    std::pair<uint64_t, std::shared_ptr<TaskCompletion>> claim() {
+        uint64_t id = m_counter++;
+        auto completion = std::make_shared<TaskCompletion>();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending[id] = completion;
+        return {id, completion};
+    }
+
+    void complete(uint64_t id, TaskResult&& result) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_pending.find(id);
+        if (it != m_pending.end()) {
+            it->second->complete(std::move(result));
+            m_pending.erase(it);
+        }
+    }
+};
+
+TaskResult emptyResult(uint64_t taskId) {
+    RespSlot resp = {};
+    resp.task_id = taskId;
+    return TaskResult{resp, PayloadLease()};
+}
+
+template<typename Body>
+double nsPerOp(int threads, Body body) {
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&body] {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                body();
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    // Wall time per op across all threads: lower is better, flat means it scales
+    return (double)elapsed / ((double)OPS_PER_THREAD * threads);
+}
+
+}
+
+void runDispatchBench(BenchReport& report) {
+    std::printf("dispatch: claim + complete + take + recycle, %d ops/thread\n", OPS_PER_THREAD);
+    std::printf("%8s %18s %18s\n", "threads", "map+mutex ns/op", "table ns/op");
+
+    for (int threads : THREAD_COUNTS) {
+        MapDispatch map;
+        double mapNs = nsPerOp(threads, [&map] {
+            auto claimed = map.claim();
+            map.complete(claimed.first, emptyResult(claimed.first));
+            claimed.second->take();
+        });
+
+        CompletionTable table(DEFAULT_MAX_IN_FLIGHT);
+        double tableNs = nsPerOp(threads, [&table] {
+            TaskHandle handle = table.claim();
+            table.complete(handle.taskId(), emptyResult(handle.taskId()));
+            handle->take();
+        });
+
+        std::printf("%8d %18.1f %18.1f\n", threads, mapNs, tableNs);
+        report.add("dispatch", "map_mutex", {{"threads", threads}}, {{"ns_per_op", mapNs}});
+        report.add("dispatch", "completion_table", {{"threads", threads}}, {{"ns_per_op", tableNs}});
+    }
+}
+
+}}
@@ -0,0 +1,17 @@
+#ifndef DispatchBench_hpp
+#define DispatchBench_hpp
+
+#include "BenchReport.hpp"
+
+namespace app { namespace bench {
+
+/**
+ * Cost of the host-side dispatch bookkeeping per task (claim an id, complete it,
+ * take the result, recycle) at 1, 4 and 16 submitting threads.
+ * CompletionTable vs. the old mutex + std::map + make_shared scheme.
+ */
+void runDispatchBench(BenchReport& report);
+
+}}
+
+#endif // DispatchBench_hpp
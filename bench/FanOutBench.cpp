@@ -0,0 +1,80 @@
+#include "FanOutBench.hpp"
+#include "service/AudioService.hpp"
+#include "worker/WorkerManager.hpp"
+#include "worker/WorkerMain.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace app { namespace bench {
+
+using namespace app::worker;
+
+namespace {
+
+constexpr int WORKERS = 4;
+constexpr int RUNS = 20;
+const size_t FAN_OUTS[] = {1, 2, 4};
+
+double medianMs(size_t fanOut, const oatpp::String& clip) {
+    IpcConfig config;
+    config.featureCacheBytes = 0; // the same clip every time: measure the workers, not the cache
+    auto manager = std::make_shared<WorkerManager>(config);
+    manager->start(0, nullptr);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < WORKERS; ++i) {
+        workers.emplace_back([] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            runWorker();
+        });
+    }
+    service::AudioService service(manager, fanOut);
+    service.extractFeatures(clip); // warm up (and wait for the workers to attach)
+
+    std::vector<double> times;
+    for (int i = 0; i < RUNS; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        service.extractFeatures(clip);
+        auto t1 = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+
+    for (int i = 0; i < WORKERS; ++i) {
+        manager->sendShutdownSignal();
+    }
+    for (auto& th : workers) th.join();
+    manager->stop();
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+}
+
+void runFanOutBench(BenchReport& report) {
+    // 30 s of 16 kHz PCM16 noise
+    std::vector<int16_t> pcm(30 * 16000);
+    uint32_t seed = 7;
+    for (auto& s : pcm) {
+        seed = seed * 1664525u + 1013904223u;
+        s = (int16_t)(seed >> 16);
+    }
+    oatpp::String clip(reinterpret_cast<const char*>(pcm.data()), pcm.size() * sizeof(int16_t));
+
+    std::printf("fan-out: one 30 s clip, %d workers, median of %d\n", WORKERS, RUNS);
+    std::printf("%8s %10s %10s\n", "fan-out", "ms", "speedup");
+
+    double baseline = 0;
+    for (size_t fanOut : FAN_OUTS) {
+        double ms = medianMs(fanOut, clip);
+        if (fanOut == 1) baseline = ms;
+        std::printf("%8zu %10.2f %9.2fx\n", fanOut, ms, baseline / ms);
+        report.add("fan_out", "extract_30s", {{"fan_out", (double)fanOut}, {"workers", WORKERS}}, {{"median_ms", ms}});
+    }
+}
+
+}}
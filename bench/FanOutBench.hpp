@@ -0,0 +1,16 @@
+#ifndef FanOutBench_hpp
+#define FanOutBench_hpp
+
+#include "BenchReport.hpp"
+
+namespace app { namespace bench {
+
+/**
+ * Long-clip fan-out: wall time of one 30 s feature request uploaded with 1, 2
+ * and 4 chunks computing at once. One client, so the time is pure latency.
+ */
+void runFanOutBench(BenchReport& report);
+
+}}
+
+#endif // FanOutBench_hpp
@@ -0,0 +1,72 @@
+#include "FftBench.hpp"
+#include "worker/cpu/Fft.hpp"
+#include "worker/cpu/MelEngine.hpp"
+#include "worker/cpu/MelKernels.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace app { namespace bench {
+
+using namespace app::worker;
+using namespace app::worker::cpu;
+
+namespace {
+
+constexpr size_t BLOCK = MelEngine::FRAME_BLOCK;
+constexpr int ITERATIONS = 2000;
+
+template<typename Body>
+double nsPerFrame(Body body) {
+    body(); // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        body();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)elapsed / ((double)ITERATIONS * BLOCK);
+}
+
+}
+
+void runFftBench(BenchReport& report) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> frames(BLOCK * N_FFT);
+    for (auto& s : frames) s = dist(rng);
+    std::vector<float> power(BLOCK * N_FFT_HALF);
+
+    std::printf("fft: %d-point real frames -> power spectrum, blocks of %lu frames\n", N_FFT, (unsigned long)BLOCK);
+    std::printf("%-24s %12s\n", "path", "ns/frame");
+
+    FftPlan plan(N_FFT);
+    std::vector<Complex> spectrum(N_FFT_HALF), scratchIn(N_FFT), scratchOut(N_FFT);
+    const MelKernels& best = selectKernels();
+    double generic = nsPerFrame([&] {
+        for (size_t f = 0; f < BLOCK; ++f) {
+            plan.forwardReal(frames.data() + f * N_FFT, spectrum.data(), scratchIn.data(), scratchOut.data());
+            best.powerSpectrum(reinterpret_cast<const float*>(spectrum.data()), power.data() + f * N_FFT_HALF, N_FFT_HALF);
+        }
+    });
+    std::printf("%-24s %12.1f\n", "generic FftPlan", generic);
+    report.add("fft", "generic", {{"n_fft", N_FFT}}, {{"ns_per_frame", generic}});
+
+    std::vector<const MelKernels*> tables = {&scalarKernels()};
+    if (&best != &scalarKernels()) {
+        tables.push_back(&best);
+    }
+    for (const MelKernels* kernels : tables) {
+        if (!kernels->framePower) continue;
+        double ns = nsPerFrame([&] {
+            kernels->framePower(frames.data(), power.data(), BLOCK);
+        });
+        char label[64];
+        std::snprintf(label, sizeof(label), "specialised (%s)", kernels->name);
+        std::printf("%-24s %12.1f  (%.2fx)\n", label, ns, generic / ns);
+        report.add("fft", std::string("specialised_") + kernels->name, {{"n_fft", N_FFT}}, {{"ns_per_frame", ns}});
+    }
+}
+
+}}
@@ -0,0 +1,16 @@
+#ifndef FftBench_hpp
+#define FftBench_hpp
+
+#include "BenchReport.hpp"
+
+namespace app { namespace bench {
+
+/**
+ * 400-point frames -> power spectrum, in MelEngine-sized blocks:
+ * generic mixed-radix FftPlan vs. the N_FFT-specialised real FFT (scalar and SIMD-across-frames).
+ */
+void runFftBench(BenchReport& report);
+
+}}
+
+#endif // FftBench_hpp
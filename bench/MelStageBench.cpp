@@ -0,0 +1,115 @@
+#include "MelStageBench.hpp"
+#include "worker/cpu/Fft.hpp"
+#include "worker/cpu/MelEngine.hpp"
+#include "worker/cpu/MelKernels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace app { namespace bench {
+
+using namespace app::worker;
+using namespace app::worker::cpu;
+
+namespace {
+
+constexpr size_t BLOCK = MelEngine::FRAME_BLOCK;
+constexpr int ITERATIONS = 2000;
+constexpr int ENGINE_RUNS = 20;
+constexpr size_t ENGINE_SAMPLES = 10 * 16000;
+
+template<typename Body>
+double nsPerFrame(Body body) {
+    body(); // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        body();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)elapsed / ((double)ITERATIONS * BLOCK);
+}
+
+}
+
+void runMelStageBench(BenchReport& report) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> audio(ENGINE_SAMPLES);
+    for (auto& s : audio) s = dist(rng);
+
+    std::vector<float> window(N_FFT);
+    for (size_t i = 0; i < N_FFT; ++i) {
+        window[i] = 0.5f - 0.5f * std::cos(2.0f * (float)M_PI * i / N_FFT);
+    }
+    std::vector<float> frames(BLOCK * N_FFT);
+    std::vector<float> power(BLOCK * N_FFT_HALF);
+    std::vector<float> mel(BLOCK * N_MELS);
+    std::vector<float> melInput(BLOCK * N_MELS);
+
+    std::printf("mel: stages on blocks of %zu frames, engine on %zu s of audio\n", BLOCK, ENGINE_SAMPLES / 16000);
+    std::printf("%-8s %-10s %12s %14s\n", "kernels", "stage", "ns/frame", "frames/s");
+
+    std::vector<const MelKernels*> tables = {&scalarKernels()};
+    if (&selectKernels() != &scalarKernels()) {
+        tables.push_back(&selectKernels());
+    }
+    for (const MelKernels* kernels : tables) {
+        auto add = [&](const char* stage, double ns) {
+            std::printf("%-8s %-10s %12.1f %14.0f\n", kernels->name, stage, ns, 1e9 / ns);
+            report.add("mel", std::string(kernels->name) + "/" + stage, {{"frames_per_block", BLOCK}},
+                       {{"ns_per_frame", ns}, {"frames_per_s", 1e9 / ns}});
+        };
+
+        add("window", nsPerFrame([&] {
+            for (size_t f = 0; f < BLOCK; ++f) {
+                kernels->applyWindow(audio.data() + f * HOP_LENGTH, window.data(), frames.data() + f * N_FFT, N_FFT);
+            }
+        }));
+
+        // What MelEngine runs: the specialised transform if there is one, else the generic plan
+        if (kernels->framePower) {
+            add("fft", nsPerFrame([&] {
+                kernels->framePower(frames.data(), power.data(), BLOCK);
+            }));
+        } else {
+            FftPlan plan(N_FFT);
+            std::vector<Complex> spectrum(N_FFT_HALF), scratchIn(N_FFT), scratchOut(N_FFT);
+            add("fft", nsPerFrame([&] {
+                for (size_t f = 0; f < BLOCK; ++f) {
+                    plan.forwardReal(frames.data() + f * N_FFT, spectrum.data(), scratchIn.data(), scratchOut.data());
+                    kernels->powerSpectrum(reinterpret_cast<const float*>(spectrum.data()), power.data() + f * N_FFT_HALF, N_FFT_HALF);
+                }
+            }));
+        }
+
+        add("mel", nsPerFrame([&] {
+            for (size_t f = 0; f < BLOCK; ++f) {
+                kernels->melFilterbank(power.data() + f * N_FFT_HALF, MEL_FILTERBANK.bands, MEL_FILTERBANK.weights,
+                                       mel.data() + f * N_MELS, N_MELS);
+            }
+        }));
+
+        // In place, so each pass starts from a fresh copy of the mel energies (included in the time)
+        std::copy(mel.begin(), mel.end(), melInput.begin());
+        add("log", nsPerFrame([&] {
+            std::copy(melInput.begin(), melInput.end(), mel.begin());
+            kernels->log10Clamp(mel.data(), mel.size(), LOG_MEL_FLOOR);
+        }));
+
+        MelEngine engine(*kernels);
+        std::vector<float> out(numFrames(ENGINE_SAMPLES) * N_MELS);
+        engine.compute(audio.data(), audio.size(), out.data()); // warm up
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ENGINE_RUNS; ++i) {
+            engine.compute(audio.data(), audio.size(), out.data());
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        add("engine", ns / ((double)ENGINE_RUNS * numFrames(ENGINE_SAMPLES)));
+    }
+}
+
+}}
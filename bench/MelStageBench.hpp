@@ -0,0 +1,17 @@
+#ifndef MelStageBench_hpp
+#define MelStageBench_hpp
+
+#include "BenchReport.hpp"
+
+namespace app { namespace bench {
+
+/**
+ * CPU mel engine, stage by stage (window, FFT + power, mel filterbank, log) on
+ * MelEngine-sized blocks, then MelEngine::compute end to end on 10 s of audio.
+ * Frames/s for every kernel table the CPU can run.
+ */
+void runMelStageBench(BenchReport& report);
+
+}}
+
+#endif // MelStageBench_hpp
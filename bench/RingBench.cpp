@@ -0,0 +1,151 @@
+#include "RingBench.hpp"
+#include "worker/SharedMemoryStructs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sched.h>
+#include <thread>
+#include <vector>
+
+namespace app { namespace bench {
+
+using namespace app::worker;
+
+namespace {
+
+const int PRODUCER_COUNTS[] = {1, 2, 4, 8};
+constexpr uint64_t THROUGHPUT_ITEMS = 1 << 21;
+constexpr int ROUND_TRIPS_PER_CALLER = 50000;
+
+// A ring in plain process memory, laid out as in SHM
+template<typename T>
+class HeapRing {
+private:
+    RingHeader m_header;
+    std::unique_ptr<RingCell<T>[]> m_cells;
+    MpmcRing<T> m_ring;
+public:
+    explicit HeapRing(size_t capacity)
+        : m_cells(new RingCell<T>[capacity])
+    {
+        m_ring.attach(&m_header, m_cells.get(), capacity);
+        m_ring.format();
+    }
+
+    void push(const T& item) {
+        while (!m_ring.tryPush(item)) {
+            sched_yield();
+        }
+    }
+
+    void pop(T& item) {
+        while (!m_ring.tryPop(item)) {
+            sched_yield();
+        }
+    }
+
+    bool tryPop(T& item) { return m_ring.tryPop(item); }
+};
+
+double throughputOpsPerSec(int producers) {
+    HeapRing<ReqSlot> ring(DEFAULT_RING_CAPACITY);
+    const uint64_t perProducer = THROUGHPUT_ITEMS / producers;
+
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < producers; ++p) {
+        pool.emplace_back([&ring, perProducer] {
+            ReqSlot req = {};
+            for (uint64_t i = 0; i < perProducer; ++i) {
+                req.task_id = i;
+                ring.push(req);
+            }
+        });
+    }
+    ReqSlot req;
+    for (uint64_t i = 0; i < perProducer * producers; ++i) {
+        ring.pop(req);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (auto& th : pool) th.join();
+    return perProducer * producers / seconds;
+}
+
+struct RoundTrips {
+    double p50Ns;
+    double p99Ns;
+    double perSec;
+};
+
+// Callers share the request ring; each has its own response ring so the echo can address it
+RoundTrips roundTrips(int callers) {
+    HeapRing<ReqSlot> requests(DEFAULT_RING_CAPACITY);
+    std::vector<std::unique_ptr<HeapRing<RespSlot>>> responses;
+    for (int c = 0; c < callers; ++c) {
+        responses.push_back(std::make_unique<HeapRing<RespSlot>>(DEFAULT_RING_CAPACITY));
+    }
+
+    std::atomic<bool> running{true};
+    std::thread echo([&] {
+        ReqSlot req;
+        RespSlot resp = {};
+        while (running.load(std::memory_order_relaxed)) {
+            if (!requests.tryPop(req)) {
+                sched_yield();
+                continue;
+            }
+            resp.task_id = req.task_id;
+            responses[req.task_id]->push(resp);
+        }
+    });
+
+    std::vector<std::vector<uint64_t>> samples(callers);
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < callers; ++c) {
+        pool.emplace_back([&, c] {
+            samples[c].reserve(ROUND_TRIPS_PER_CALLER);
+            ReqSlot req = {};
+            req.task_id = (uint64_t)c;
+            RespSlot resp;
+            for (int i = 0; i < ROUND_TRIPS_PER_CALLER; ++i) {
+                auto t0 = std::chrono::steady_clock::now();
+                requests.push(req);
+                responses[c]->pop(resp);
+                auto t1 = std::chrono::steady_clock::now();
+                samples[c].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    running = false;
+    echo.join();
+
+    std::vector<uint64_t> all;
+    for (auto& s : samples) all.insert(all.end(), s.begin(), s.end());
+    std::sort(all.begin(), all.end());
+    return RoundTrips{(double)all[all.size() / 2], (double)all[all.size() * 99 / 100], all.size() / seconds};
+}
+
+}
+
+void runRingBench(BenchReport& report) {
+    std::printf("ring: MpmcRing<ReqSlot>, capacity %u, in process memory\n", DEFAULT_RING_CAPACITY);
+    std::printf("%10s %14s %12s %12s %14s\n", "producers", "push+pop M/s", "rtt p50 ns", "rtt p99 ns", "round trips/s");
+
+    for (int producers : PRODUCER_COUNTS) {
+        double opsPerSec = throughputOpsPerSec(producers);
+        RoundTrips rtt = roundTrips(producers);
+        std::printf("%10d %14.2f %12.0f %12.0f %14.0f\n", producers, opsPerSec / 1e6, rtt.p50Ns, rtt.p99Ns, rtt.perSec);
+
+        report.add("ring", "throughput", {{"producers", producers}, {"consumers", 1}}, {{"ops_per_s", opsPerSec}});
+        report.add("ring", "round_trip", {{"callers", producers}},
+                   {{"p50_ns", rtt.p50Ns}, {"p99_ns", rtt.p99Ns}, {"round_trips_per_s", rtt.perSec}});
+    }
+}
+
+}}
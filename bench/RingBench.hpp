@@ -0,0 +1,18 @@
+#ifndef RingBench_hpp
+#define RingBench_hpp
+
+#include "BenchReport.hpp"
+
+namespace app { namespace bench {
+
+/**
+ * The MpmcRing on its own, in process memory with ReqSlot-sized entries: throughput
+ * from 1, 2, 4 and 8 producers into one consumer, and spin-polled round trips
+ * (request ring -> echo thread -> response ring) with that many callers at once.
+ * No semaphores or completion table: the floor under SubmitBench.
+ */
+void runRingBench(BenchReport& report);
+
+}}
+
+#endif // RingBench_hpp
@@ -0,0 +1,128 @@
+#include "SubmitBench.hpp"
+#include "worker/WorkerManager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace app { namespace bench {
+
+using namespace app::worker;
+
+namespace {
+
+constexpr int ECHO_WORKERS = 2;
+constexpr int TASKS_PER_THREAD = 20000;
+constexpr size_t PAYLOAD_BYTES = 256;
+const int THREAD_COUNTS[] = {1, 4, 16};
+
+// A worker that answers every task right away with an empty, successful reply
+void echoWorker() {
+    IPC ipc;
+    ipc.initWorker();
+    ReqSlot req;
+    while (true) {
+        if (!ipc.waitForRequest(req)) continue;
+        if (req.type == TASK_SHUTDOWN) break;
+        if (req.payload.valid()) {
+            ipc.arena().release(req.payload);
+        }
+        RespSlot resp = {};
+        resp.task_id = req.task_id;
+        resp.type = req.type;
+        resp.priority = req.priority;
+        resp.batch_size = 1;
+        ipc.submitResponse(resp);
+    }
+    ipc.cleanup();
+}
+
+struct Point {
+    double submitP50Ns;
+    double submitP99Ns;
+    double rttP50Ns;
+    double rttP99Ns;
+    double tasksPerSec;
+};
+
+double percentile(std::vector<uint64_t>& sorted, size_t permille) {
+    return (double)sorted[sorted.size() * permille / 1000];
+}
+
+Point measure(int threads) {
+    auto manager = std::make_shared<WorkerManager>();
+    manager->start(0, nullptr);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < ECHO_WORKERS; ++i) {
+        workers.emplace_back([] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            echoWorker();
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::vector<std::vector<uint64_t>> submitNs(threads), rttNs(threads);
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            submitNs[t].reserve(TASKS_PER_THREAD);
+            rttNs[t].reserve(TASKS_PER_THREAD);
+            ReqSlot req = {};
+            req.type = TASK_TEXT_PROCESS;
+            req.priority = PRIORITY_INTERACTIVE;
+            req.len = (uint32_t)PAYLOAD_BYTES;
+            for (int i = 0; i < TASKS_PER_THREAD; ++i) {
+                auto t0 = std::chrono::steady_clock::now();
+                TaskHandle handle = manager->commit(req, manager->reserve(PAYLOAD_BYTES));
+                auto t1 = std::chrono::steady_clock::now();
+                handle->wait();
+                handle->take();
+                auto t2 = std::chrono::steady_clock::now();
+                submitNs[t].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+                rttNs[t].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t0).count());
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int i = 0; i < ECHO_WORKERS; ++i) {
+        manager->sendShutdownSignal();
+    }
+    for (auto& th : workers) th.join();
+    manager->stop();
+
+    std::vector<uint64_t> submit, rtt;
+    for (int t = 0; t < threads; ++t) {
+        submit.insert(submit.end(), submitNs[t].begin(), submitNs[t].end());
+        rtt.insert(rtt.end(), rttNs[t].begin(), rttNs[t].end());
+    }
+    std::sort(submit.begin(), submit.end());
+    std::sort(rtt.begin(), rtt.end());
+    return Point{percentile(submit, 500), percentile(submit, 990), percentile(rtt, 500), percentile(rtt, 990),
+                 rtt.size() / seconds};
+}
+
+}
+
+void runSubmitBench(BenchReport& report) {
+    std::printf("submit: reserve(%zu) + commit, then wait for an echo, %d echo workers, %d tasks/thread\n",
+                PAYLOAD_BYTES, ECHO_WORKERS, TASKS_PER_THREAD);
+    std::printf("%8s %14s %14s %12s %12s %10s\n", "threads", "submit p50 ns", "submit p99 ns", "rtt p50 ns", "rtt p99 ns", "tasks/s");
+
+    for (int threads : THREAD_COUNTS) {
+        Point p = measure(threads);
+        std::printf("%8d %14.0f %14.0f %12.0f %12.0f %10.0f\n", threads, p.submitP50Ns, p.submitP99Ns,
+                    p.rttP50Ns, p.rttP99Ns, p.tasksPerSec);
+        report.add("submit", "reserve_commit", {{"threads", threads}, {"workers", ECHO_WORKERS}},
+                   {{"p50_ns", p.submitP50Ns}, {"p99_ns", p.submitP99Ns}});
+        report.add("submit", "round_trip", {{"threads", threads}, {"workers", ECHO_WORKERS}},
+                   {{"p50_ns", p.rttP50Ns}, {"p99_ns", p.rttP99Ns}, {"tasks_per_s", p.tasksPerSec}});
+    }
+}
+
+}}
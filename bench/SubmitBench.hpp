@@ -0,0 +1,17 @@
+#ifndef SubmitBench_hpp
+#define SubmitBench_hpp
+
+#include "BenchReport.hpp"
+
+namespace app { namespace bench {
+
+/**
+ * WorkerManager dispatch from 1, 4 and 16 submitting threads: what reserve() + commit()
+ * cost the caller, and the full round trip through the SHM rings, semaphores, response
+ * thread and completion table. The workers are echo threads that answer without computing.
+ */
+void runSubmitBench(BenchReport& report);
+
+}}
+
+#endif // SubmitBench_hpp
@@ -0,0 +1,81 @@
+#include "BenchReport.hpp"
+#include "RingBench.hpp"
+#include "SubmitBench.hpp"
+#include "DispatchBench.hpp"
+#include "MelStageBench.hpp"
+#include "CodecBench.hpp"
+#include "BatchBench.hpp"
+#include "FftBench.hpp"
+#include "FanOutBench.hpp"
+#include "oatpp/core/base/Environment.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <string>
+
+namespace {
+
+struct Suite {
+    const char* name;
+    void (*run)(app::bench::BenchReport&);
+};
+
+const Suite SUITES[] = {
+    {"ring", app::bench::runRingBench},
+    {"submit", app::bench::runSubmitBench},
+    {"dispatch", app::bench::runDispatchBench},
+    {"fft", app::bench::runFftBench},
+    {"mel", app::bench::runMelStageBench},
+    {"codec", app::bench::runCodecBench},
+    {"batching", app::bench::runBatchBench},
+    {"fan_out", app::bench::runFanOutBench},
+};
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s [--json FILE] [--label NAME] [suite...]\nsuites:", argv0);
+    for (const Suite& suite : SUITES) std::fprintf(stderr, " %s", suite.name);
+    std::fprintf(stderr, "\n");
+    return 2;
+}
+
+}
+
+// Tables go to stdout; --json also writes every result (and the build) to FILE for comparing runs
+int main(int argc, char* argv[]) {
+    const char* jsonPath = nullptr;
+    std::string label;
+    std::set<std::string> selected;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--label") == 0 && i + 1 < argc) {
+            label = argv[++i];
+        } else if (argv[i][0] == '-') {
+            return usage(argv[0]);
+        } else {
+            selected.insert(argv[i]);
+        }
+    }
+    for (const std::string& name : selected) {
+        bool known = false;
+        for (const Suite& suite : SUITES) known = known || name == suite.name;
+        if (!known) return usage(argv[0]);
+    }
+
+    oatpp::base::Environment::init();
+    app::bench::BenchReport report(label);
+    for (const Suite& suite : SUITES) {
+        if (selected.empty() || selected.count(suite.name)) {
+            suite.run(report);
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+    }
+    oatpp::base::Environment::destroy();
+
+    if (jsonPath && !report.writeJson(jsonPath)) {
+        return 1;
+    }
+    return 0;
+}
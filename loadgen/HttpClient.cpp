@@ -0,0 +1,321 @@
+#include "HttpClient.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace app { namespace loadgen {
+
+namespace {
+
+// Anything bigger is not a response this service sends
+constexpr size_t MAX_HEADER_BYTES = 64 * 1024;
+constexpr size_t RECV_BUFFER = 64 * 1024;
+
+std::string lower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return value;
+}
+
+std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t");
+    size_t end = value.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? std::string() : value.substr(begin, end - begin + 1);
+}
+
+}
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// --- HttpResponseParser ---
+
+void HttpResponseParser::reset(bool keepBody) {
+    m_state = HEADERS;
+    m_keepBody = keepBody;
+    m_line.clear();
+    m_remaining = 0;
+    m_response = HttpResponse();
+}
+
+bool HttpResponseParser::parseHeaders() {
+    // m_line holds everything up to and including the blank line
+    size_t lineEnd = m_line.find("\r\n");
+    const std::string statusLine = m_line.substr(0, lineEnd);
+    if (statusLine.compare(0, 5, "HTTP/") != 0 || statusLine.size() < 12) {
+        return false;
+    }
+    bool http10 = statusLine.compare(0, 8, "HTTP/1.0") == 0;
+    m_response.status = std::atoi(statusLine.c_str() + 9);
+    m_response.keepAlive = !http10;
+
+    bool chunked = false;
+    bool hasLength = false;
+    uint64_t length = 0;
+    size_t pos = lineEnd + 2;
+    while (pos < m_line.size()) {
+        size_t end = m_line.find("\r\n", pos);
+        if (end == std::string::npos || end == pos) break;
+        std::string header = m_line.substr(pos, end - pos);
+        pos = end + 2;
+
+        size_t colon = header.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = lower(trim(header.substr(0, colon)));
+        std::string value = lower(trim(header.substr(colon + 1)));
+        if (name == "content-length") {
+            hasLength = true;
+            length = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (name == "transfer-encoding") {
+            chunked = value.find("chunked") != std::string::npos;
+        } else if (name == "connection") {
+            if (value.find("close") != std::string::npos) m_response.keepAlive = false;
+            if (value.find("keep-alive") != std::string::npos) m_response.keepAlive = true;
+        }
+    }
+    m_line.clear();
+
+    int status = m_response.status;
+    if (status == 204 || status == 304 || (status >= 100 && status < 200)) {
+        m_state = DONE;
+    } else if (chunked) {
+        m_state = CHUNK_SIZE;
+    } else if (hasLength) {
+        m_remaining = length;
+        m_state = length == 0 ? DONE : BODY_LENGTH;
+    } else {
+        m_state = BODY_UNTIL_CLOSE;
+        m_response.keepAlive = false;
+    }
+    return true;
+}
+
+void HttpResponseParser::consumeBody(const char* data, size_t size) {
+    if (size == 0) return;
+    if (m_response.firstBodyByteNs == 0) {
+        m_response.firstBodyByteNs = nowNs();
+    }
+    m_response.bodyBytes += size;
+    if (m_keepBody) {
+        m_response.body.append(data, size);
+    }
+}
+
+size_t HttpResponseParser::feed(const char* data, size_t size) {
+    size_t pos = 0;
+    while (pos < size && m_state != DONE && m_state != FAILED) {
+        switch (m_state) {
+            case HEADERS: {
+                // Byte by byte until the blank line: headers are small, bodies are not
+                m_line += data[pos++];
+                size_t n = m_line.size();
+                if (n >= 4 && m_line.compare(n - 4, 4, "\r\n\r\n") == 0) {
+                    if (!parseHeaders()) m_state = FAILED;
+                } else if (n > MAX_HEADER_BYTES) {
+                    m_state = FAILED;
+                }
+                break;
+            }
+            case BODY_LENGTH: {
+                size_t take = (size_t)std::min<uint64_t>(m_remaining, size - pos);
+                consumeBody(data + pos, take);
+                pos += take;
+                m_remaining -= take;
+                if (m_remaining == 0) m_state = DONE;
+                break;
+            }
+            case BODY_UNTIL_CLOSE:
+                consumeBody(data + pos, size - pos);
+                pos = size;
+                break;
+            case CHUNK_SIZE:
+            case CHUNK_DATA_END:
+            case TRAILERS: {
+                m_line += data[pos++];
+                size_t n = m_line.size();
+                if (n > MAX_HEADER_BYTES) {
+                    m_state = FAILED;
+                } else if (n >= 2 && m_line.compare(n - 2, 2, "\r\n") == 0) {
+                    std::string line = m_line.substr(0, n - 2);
+                    m_line.clear();
+                    if (m_state == CHUNK_DATA_END) {
+                        m_state = line.empty() ? CHUNK_SIZE : FAILED;
+                    } else if (m_state == TRAILERS) {
+                        if (line.empty()) m_state = DONE;
+                    } else {
+                        // Chunk extensions after ';' are allowed and ignored
+                        char* end = nullptr;
+                        m_remaining = std::strtoull(line.c_str(), &end, 16);
+                        if (end == line.c_str()) {
+                            m_state = FAILED;
+                        } else {
+                            m_state = m_remaining == 0 ? TRAILERS : CHUNK_DATA;
+                        }
+                    }
+                }
+                break;
+            }
+            case CHUNK_DATA: {
+                size_t take = (size_t)std::min<uint64_t>(m_remaining, size - pos);
+                consumeBody(data + pos, take);
+                pos += take;
+                m_remaining -= take;
+                if (m_remaining == 0) m_state = CHUNK_DATA_END;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return pos;
+}
+
+void HttpResponseParser::finishOnClose() {
+    m_state = m_state == BODY_UNTIL_CLOSE ? DONE : FAILED;
+}
+
+// --- HttpConnection ---
+
+HttpConnection::HttpConnection(const std::string& host, uint16_t port, int timeoutMs)
+    : m_host(host)
+    , m_port(port)
+    , m_timeoutMs(timeoutMs)
+{}
+
+HttpConnection::~HttpConnection() {
+    close();
+}
+
+void HttpConnection::close() {
+    if (m_fd != -1) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_leftover.clear();
+}
+
+bool HttpConnection::connect() {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    std::string port = std::to_string(m_port);
+    if (getaddrinfo(m_host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        return false;
+    }
+
+    for (addrinfo* a = addresses; a && m_fd == -1; a = a->ai_next) {
+        int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd == -1) continue;
+
+        timeval timeout;
+        timeout.tv_sec = m_timeoutMs / 1000;
+        timeout.tv_usec = (m_timeoutMs % 1000) * 1000;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+            m_fd = fd;
+        } else {
+            ::close(fd);
+        }
+    }
+    freeaddrinfo(addresses);
+    return m_fd != -1;
+}
+
+bool HttpConnection::exchange(const std::string& request, HttpResponse& response, bool keepBody) {
+    bool reused = m_fd != -1;
+    bool received = false;
+    if (attempt(request, response, keepBody, received)) {
+        return true;
+    }
+    // A kept-alive connection the server has closed since fails before any answer: once more on a new one
+    return reused && !received && attempt(request, response, keepBody, received);
+}
+
+bool HttpConnection::attempt(const std::string& request, HttpResponse& response, bool keepBody, bool& received) {
+    if (m_fd == -1 && !connect()) {
+        return false;
+    }
+
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = ::send(m_fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close();
+            return false;
+        }
+        sent += (size_t)n;
+    }
+
+    m_parser.reset(keepBody);
+    if (!m_leftover.empty()) {
+        // Only happens if the server sent more than it was asked for; treat it as the start of this answer
+        size_t used = m_parser.feed(m_leftover.data(), m_leftover.size());
+        m_leftover.erase(0, used);
+    }
+
+    char buffer[RECV_BUFFER];
+    while (!m_parser.done() && !m_parser.failed()) {
+        ssize_t n = ::recv(m_fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            close();   // timeout or reset
+            return false;
+        }
+        if (n == 0) {
+            m_parser.finishOnClose();
+            break;
+        }
+        received = true;
+        size_t used = m_parser.feed(buffer, (size_t)n);
+        if (used < (size_t)n) {
+            m_leftover.append(buffer + used, (size_t)n - used);
+        }
+    }
+
+    if (m_parser.failed()) {
+        close();
+        return false;
+    }
+    response = std::move(m_parser.response());
+    if (!response.keepAlive) {
+        close();
+    }
+    return true;
+}
+
+std::string formatRequest(const char* method, const std::string& path, const std::string& host,
+                          const std::string& extraHeaders, const std::string& body, bool keepAlive) {
+    std::string request;
+    request.reserve(256 + extraHeaders.size() + body.size());
+    request += method;
+    request += ' ';
+    request += path;
+    request += " HTTP/1.1\r\nHost: ";
+    request += host;
+    request += keepAlive ? "\r\nConnection: keep-alive\r\n" : "\r\nConnection: close\r\n";
+    request += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    request += extraHeaders;
+    request += "\r\n";
+    request += body;
+    return request;
+}
+
+}}
@@ -0,0 +1,98 @@
+#ifndef LOADGEN_HTTP_CLIENT_HPP
+#define LOADGEN_HTTP_CLIENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace app { namespace loadgen {
+
+// Steady clock in ns, what every timestamp in the load generator is taken with
+uint64_t nowNs();
+
+struct HttpResponse {
+    int status = 0;
+    bool keepAlive = true;
+    size_t bodyBytes = 0;
+    uint64_t firstBodyByteNs = 0;   // nowNs() when the first body byte arrived, 0 if there was none
+    std::string body;               // only with keepBody
+};
+
+/**
+ * Incremental HTTP/1.1 response parser: feed() it whatever the socket returns.
+ * Handles Content-Length, chunked and read-until-close bodies; bytes past the end
+ * of the response are left for the next one (feed() returns how many it used).
+ */
+class HttpResponseParser {
+private:
+    enum State {
+        HEADERS,
+        BODY_LENGTH,
+        BODY_UNTIL_CLOSE,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        TRAILERS,
+        DONE,
+        FAILED
+    };
+
+    State m_state = HEADERS;
+    bool m_keepBody = false;
+    std::string m_line;         // header block, chunk-size or trailer line being assembled
+    uint64_t m_remaining = 0;   // body or chunk bytes still to come
+    HttpResponse m_response;
+
+    bool parseHeaders();
+    void consumeBody(const char* data, size_t size);
+
+public:
+    void reset(bool keepBody);
+
+    size_t feed(const char* data, size_t size);
+
+    // The peer closed the connection: ends a read-until-close body, fails anything else
+    void finishOnClose();
+
+    bool done() const { return m_state == DONE; }
+    bool failed() const { return m_state == FAILED; }
+    HttpResponse& response() { return m_response; }
+};
+
+/**
+ * One blocking keep-alive connection. exchange() (re)connects when needed, sends a
+ * request and reads its response; send and receive each give up after timeoutMs.
+ * Close it after a "Connection: close" request: not every server says so back.
+ */
+class HttpConnection {
+private:
+    std::string m_host;
+    uint16_t m_port;
+    int m_timeoutMs;
+    int m_fd = -1;
+    std::string m_leftover;   // received past the previous response
+    HttpResponseParser m_parser;
+
+    bool connect();
+    bool attempt(const std::string& request, HttpResponse& response, bool keepBody, bool& received);
+
+public:
+    HttpConnection(const std::string& host, uint16_t port, int timeoutMs);
+    ~HttpConnection();
+
+    HttpConnection(const HttpConnection&) = delete;
+    HttpConnection& operator=(const HttpConnection&) = delete;
+
+    void close();
+
+    // False on a connect / socket error, timeout or malformed response (the connection is closed then)
+    bool exchange(const std::string& request, HttpResponse& response, bool keepBody = false);
+};
+
+// "METHOD path HTTP/1.1" with Host, Connection, Content-Length (and extraHeaders, "Name: value\r\n" each)
+std::string formatRequest(const char* method, const std::string& path, const std::string& host,
+                          const std::string& extraHeaders, const std::string& body, bool keepAlive);
+
+}}
+
+#endif
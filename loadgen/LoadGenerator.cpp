@@ -0,0 +1,219 @@
+#include "LoadGenerator.hpp"
+#include "HttpClient.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace app { namespace loadgen {
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 16000;
+constexpr uint64_t LATE_NS = 1000000;
+constexpr uint64_t IO_ERROR_BACKOFF_NS = 10000000;
+
+void sleepUntil(uint64_t ns) {
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(ns)));
+}
+
+// Noise at speech-like level; what the samples are doesn't change the work the server does
+std::string makePcm16(uint32_t ms) {
+    size_t samples = (size_t)ms * (SAMPLE_RATE / 1000);
+    std::string pcm(samples * 2, '\0');
+    uint32_t state = 0x12345678;
+    for (size_t i = 0; i < samples; ++i) {
+        state = state * 1664525u + 1013904223u;
+        int16_t sample = (int16_t)((int32_t)(state >> 16) - 32768) / 8;
+        pcm[2 * i] = (char)(sample & 0xff);
+        pcm[2 * i + 1] = (char)((sample >> 8) & 0xff);
+    }
+    return pcm;
+}
+
+std::string jsonMessage(const std::string& message) {
+    std::string out = "{\"message\":\"";
+    for (char c : message) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c >= 0x20) out += c;
+    }
+    out += "\"}";
+    return out;
+}
+
+// {"session_id":N,...} from POST /audio/stream/session
+bool parseSessionId(const std::string& body, uint64_t& id) {
+    size_t key = body.find("\"session_id\"");
+    if (key == std::string::npos) return false;
+    size_t colon = body.find(':', key);
+    if (colon == std::string::npos) return false;
+    char* end = nullptr;
+    id = std::strtoull(body.c_str() + colon + 1, &end, 10);
+    return end != body.c_str() + colon + 1;
+}
+
+void storeMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+}
+
+LoadGenerator::LoadGenerator(const LoadConfig& config)
+    : m_config(config)
+{
+    if (m_config.scenario == Scenario::PROCESS) {
+        m_body = jsonMessage(m_config.message);
+    } else {
+        m_body = makePcm16(m_config.audioMs);
+    }
+}
+
+void LoadGenerator::runConnection(uint32_t index, uint64_t startNs, LoadStats& stats) {
+    const LoadConfig& config = m_config;
+    HttpConnection connection(config.host, config.port, config.timeoutMs);
+    const std::string host = config.host + ":" + std::to_string(config.port);
+    const std::string octets = "Content-Type: application/octet-stream\r\n" + config.extraHeaders;
+
+    bool ioFailed = false;
+
+    // One HTTP round trip; measured exchanges are counted by outcome. True for a 2xx.
+    auto exchange = [&](const char* method, const std::string& path, const std::string& headers,
+                        const std::string& body, HttpResponse& response, bool measured, bool keepBody) {
+        bool answered = connection.exchange(formatRequest(method, path, host, headers, body, config.keepAlive),
+                                            response, keepBody);
+        if (!config.keepAlive) {
+            connection.close();
+        }
+        ioFailed = ioFailed || !answered;
+        if (measured) {
+            if (!answered) {
+                stats.ioErrors.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                stats.bytesReceived.fetch_add(response.bodyBytes, std::memory_order_relaxed);
+                int status = response.status;
+                auto& counter = status / 100 == 2 ? stats.status2xx
+                              : status == 429 ? stats.status429
+                              : status / 100 == 4 ? stats.status4xx
+                              : stats.status5xx;
+                counter.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        return answered && response.status / 100 == 2;
+    };
+
+    // One request of the scenario, due at dueNs
+    auto runOnce = [&](uint64_t dueNs, bool measured) {
+        HttpResponse response;
+        if (config.scenario == Scenario::PROCESS || config.scenario == Scenario::AUDIO) {
+            bool ok = config.scenario == Scenario::PROCESS
+                ? exchange("POST", "/process", "Content-Type: application/json\r\n" + config.extraHeaders,
+                           m_body, response, measured, false)
+                : exchange("POST", "/audio/stream",
+                           config.accept.empty() ? octets : octets + "Accept: " + config.accept + "\r\n",
+                           m_body, response, measured, false);
+            if (ok && measured && response.firstBodyByteNs != 0) {
+                stats.firstByte.record(response.firstBodyByteNs - dueNs);
+            }
+            return ok;
+        }
+
+        uint64_t sessionId = 0;
+        if (!exchange("POST", "/audio/stream/session", config.extraHeaders, std::string(), response, measured, true)) {
+            return false;
+        }
+        if (!parseSessionId(response.body, sessionId)) {
+            if (measured) stats.ioErrors.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const std::string path = "/audio/stream/session/" + std::to_string(sessionId);
+        const size_t chunkBytes = (size_t)config.chunkMs * (SAMPLE_RATE / 1000) * 2;
+
+        bool ok = true;
+        for (size_t offset = 0, chunk = 0; ok && offset < m_body.size(); offset += chunkBytes, ++chunk) {
+            uint64_t appendDueNs = nowNs();
+            if (config.pace) {
+                appendDueNs = dueNs + chunk * config.chunkMs * 1000000ull;
+                sleepUntil(appendDueNs);
+            }
+            ok = exchange("POST", path, octets, m_body.substr(offset, chunkBytes), response, measured, false);
+            if (ok && measured) {
+                stats.append.record(nowNs() - appendDueNs);
+            }
+        }
+        // Closed even after a failed append, so the server doesn't keep the session around
+        bool closed = exchange("DELETE", path, config.extraHeaders, std::string(), response, measured, false);
+        return ok && closed;
+    };
+
+    const uint64_t warmNs = startNs + (uint64_t)(config.warmupS * 1e9);
+    const uint64_t endNs = warmNs + (uint64_t)(config.durationS * 1e9);
+    const double intervalNs = config.connections * 1e9 / config.rate;
+    const double offsetNs = index * 1e9 / config.rate;
+
+    sleepUntil(startNs);
+    for (uint64_t k = 0;; ++k) {
+        uint64_t dueNs;
+        if (config.mode == LoadMode::OPEN) {
+            dueNs = startNs + (uint64_t)(offsetNs + k * intervalNs);
+            if (dueNs >= endNs) break;
+            uint64_t now = nowNs();
+            if (now < dueNs) {
+                sleepUntil(dueNs);
+            } else if (now - dueNs > LATE_NS && dueNs >= warmNs) {
+                stats.lateSends.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            dueNs = nowNs();
+            if (dueNs >= endNs) break;
+        }
+
+        bool measured = dueNs >= warmNs;
+        ioFailed = false;
+        uint64_t sentNs = nowNs();
+        bool ok = runOnce(dueNs, measured);
+        uint64_t doneNs = nowNs();
+
+        if (measured) {
+            stats.requests.fetch_add(1, std::memory_order_relaxed);
+            if (ok) {
+                stats.succeeded.fetch_add(1, std::memory_order_relaxed);
+                stats.latency.record(doneNs - dueNs);
+                stats.service.record(doneNs - sentNs);
+            }
+            storeMax(stats.lastDoneNs, doneNs);
+        }
+        if (config.mode == LoadMode::CLOSED) {
+            // Don't spin on a server that refuses connections
+            uint64_t pauseNs = ioFailed ? IO_ERROR_BACKOFF_NS : 0;
+            sleepUntil(doneNs + std::max(pauseNs, (uint64_t)(config.thinkMs * 1e6)));
+        }
+    }
+}
+
+LoadResult LoadGenerator::run() {
+    LoadResult result;
+    result.stats = std::unique_ptr<LoadStats>(new LoadStats());   // value-initialized: all zero
+
+    // Connections start together; the warmup absorbs connecting
+    uint64_t startNs = nowNs() + 10000000;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < m_config.connections; ++i) {
+        threads.emplace_back(&LoadGenerator::runConnection, this, i, startNs, std::ref(*result.stats));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t warmNs = startNs + (uint64_t)(m_config.warmupS * 1e9);
+    uint64_t endNs = warmNs + (uint64_t)(m_config.durationS * 1e9);
+    uint64_t lastNs = std::max(endNs, result.stats->lastDoneNs.load());
+    result.measuredS = (lastNs - warmNs) / 1e9;
+    return result;
+}
+
+}}
@@ -0,0 +1,102 @@
+#ifndef LOADGEN_LOAD_GENERATOR_HPP
+#define LOADGEN_LOAD_GENERATOR_HPP
+
+#include "worker/LatencyHistogram.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace app { namespace loadgen {
+
+// 128 buckets per power of two (within 0.8%), ~58 KB: only the client keeps these
+typedef worker::BasicLatencyHistogram<7> LoadHistogram;
+
+enum class LoadMode {
+    OPEN,    // fixed arrival rate, latency from the time each request was due
+    CLOSED   // each connection sends its next request when the last one is answered
+};
+
+enum class Scenario {
+    PROCESS,   // POST /process
+    AUDIO,     // POST /audio/stream, one upload per request
+    SESSION    // open a session, append the audio in chunks, close it
+};
+
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    uint16_t port = 8000;
+    Scenario scenario = Scenario::PROCESS;
+    LoadMode mode = LoadMode::CLOSED;
+    double rate = 100;            // open loop: requests (sessions) per second over all connections
+    uint32_t connections = 8;
+    double durationS = 10;
+    double warmupS = 2;           // sent and answered, but not counted
+    bool keepAlive = true;
+    int timeoutMs = 30000;
+
+    std::string message = "hello world";   // /process
+    uint32_t audioMs = 1000;               // audio per request (per session)
+    uint32_t chunkMs = 100;                // session appends
+    bool pace = false;                     // session appends due every chunkMs, like a live source
+    std::string accept;                    // /audio/stream Accept header, e.g. application/x-ndjson
+    std::string extraHeaders;              // "Name: value\r\n" each, on every request
+
+    double thinkMs = 0;                    // closed loop: pause between requests
+    double expectedIntervalMs = 0;         // closed loop correction, 0 = median latency + think time
+};
+
+/**
+ * Everything the connection threads record. Latency histograms only take 2xx
+ * answers; every HTTP exchange is also counted by status class.
+ */
+struct LoadStats {
+    LoadHistogram latency;     // per request (session): from when it was due (open) or sent (closed)
+    LoadHistogram service;     // per request (session): from when it was actually sent
+    LoadHistogram firstByte;   // first response body byte, from when the request was due
+    LoadHistogram append;      // session appends, from when each was due (pace) or sent
+
+    std::atomic<uint64_t> requests;     // measured requests (sessions) attempted
+    std::atomic<uint64_t> succeeded;    // ... of which every exchange was 2xx
+    std::atomic<uint64_t> status2xx;
+    std::atomic<uint64_t> status429;
+    std::atomic<uint64_t> status4xx;    // other than 429
+    std::atomic<uint64_t> status5xx;
+    std::atomic<uint64_t> ioErrors;     // connect / socket errors, timeouts, malformed responses
+    std::atomic<uint64_t> lateSends;    // open loop: sent more than 1 ms after they were due
+    std::atomic<uint64_t> bytesReceived;
+    std::atomic<uint64_t> lastDoneNs;   // last measured answer
+};
+
+struct LoadResult {
+    std::unique_ptr<LoadStats> stats;
+    double measuredS = 0;   // from the end of warmup to the end of the run, or the last answer if later
+};
+
+/**
+ * Drives one scenario from `connections` threads, one blocking connection each.
+ *
+ * Open loop (wrk2-style): request k of connection i is due at
+ *   start + i / rate + k * connections / rate
+ * and its latency is taken from then, not from when the connection got round to
+ * sending it, so a server that stalls is charged for every request it delayed.
+ * Closed loop records the plain send-to-answer time; the report corrects it
+ * afterwards (see correctCoordinatedOmission).
+ */
+class LoadGenerator {
+private:
+    LoadConfig m_config;
+    std::string m_body;   // the request body the scenario sends (the whole audio for sessions)
+
+    void runConnection(uint32_t index, uint64_t startNs, LoadStats& stats);
+
+public:
+    explicit LoadGenerator(const LoadConfig& config);
+
+    LoadResult run();
+};
+
+}}
+
+#endif
@@ -0,0 +1,191 @@
+#include "LoadReport.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace app { namespace loadgen {
+
+namespace {
+
+struct Percentile {
+    double q;
+    const char* name;
+};
+
+const Percentile PERCENTILES[] = {
+    {0.5, "p50"}, {0.9, "p90"}, {0.99, "p99"}, {0.999, "p99.9"}, {0.9999, "p99.99"}, {1.0, "max"}
+};
+
+struct Series {
+    const char* name;
+    std::unique_ptr<LoadHistogram::Snapshot> snapshot;
+};
+
+std::unique_ptr<LoadHistogram::Snapshot> take(const LoadHistogram& histogram) {
+    auto snapshot = std::make_unique<LoadHistogram::Snapshot>();
+    histogram.snapshot(*snapshot);
+    return snapshot;
+}
+
+// The interval a closed-loop connection was meant to send at: median answer plus think time
+uint64_t correctionInterval(const LoadConfig& config, const LoadHistogram::Snapshot& raw) {
+    if (config.expectedIntervalMs > 0) {
+        return (uint64_t)(config.expectedIntervalMs * 1e6);
+    }
+    return raw.quantile(0.5) + (uint64_t)(config.thinkMs * 1e6);
+}
+
+/**
+ * What the report shows: open loop already measured from the due time, so
+ * "corrected" is as recorded and "uncorrected" is the send-to-answer time a
+ * curl loop would have seen; closed loop records the latter and corrects it here.
+ */
+std::vector<Series> collectSeries(const LoadConfig& config, const LoadResult& result, uint64_t& intervalNs) {
+    const LoadStats& stats = *result.stats;
+    std::vector<Series> series;
+    intervalNs = 0;
+    if (config.mode == LoadMode::OPEN) {
+        series.push_back(Series{"corrected", take(stats.latency)});
+        series.push_back(Series{"uncorrected", take(stats.service)});
+    } else {
+        auto raw = take(stats.latency);
+        auto corrected = std::make_unique<LoadHistogram::Snapshot>();
+        intervalNs = correctionInterval(config, *raw);
+        correctCoordinatedOmission(*raw, intervalNs, *corrected);
+        series.push_back(Series{"corrected", std::move(corrected)});
+        series.push_back(Series{"uncorrected", std::move(raw)});
+    }
+    auto firstByte = take(stats.firstByte);
+    if (firstByte->count > 0) series.push_back(Series{"first_byte", std::move(firstByte)});
+    auto append = take(stats.append);
+    if (append->count > 0) series.push_back(Series{"append", std::move(append)});
+    return series;
+}
+
+double ms(uint64_t ns) {
+    return ns / 1e6;
+}
+
+double mean(const LoadHistogram::Snapshot& snapshot) {
+    return snapshot.count ? (double)snapshot.sumNs / snapshot.count : 0;
+}
+
+void appendf(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+void appendf(std::string& out, const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len > 0) out.append(buffer, std::min((size_t)len, sizeof(buffer) - 1));
+}
+
+}
+
+void correctCoordinatedOmission(const LoadHistogram::Snapshot& raw, uint64_t expectedIntervalNs,
+                                LoadHistogram::Snapshot& out) {
+    out = raw;
+    if (expectedIntervalNs == 0) return;
+    for (uint32_t b = 0; b < LoadHistogram::BUCKETS; ++b) {
+        uint64_t count = raw.counts[b];
+        if (count == 0) continue;
+        // The bucket's lowest value, as HdrHistogram does: never adds more than it should
+        uint64_t value = LoadHistogram::lowerBound(b);
+        for (uint64_t missing = value > expectedIntervalNs ? value - expectedIntervalNs : 0;
+             missing >= expectedIntervalNs; missing -= expectedIntervalNs) {
+            out.counts[LoadHistogram::bucketOf(missing)] += count;
+            out.count += count;
+            out.sumNs += missing * count;
+        }
+    }
+}
+
+const char* scenarioName(Scenario scenario) {
+    switch (scenario) {
+        case Scenario::PROCESS: return "process";
+        case Scenario::AUDIO: return "audio";
+        case Scenario::SESSION: return "session";
+    }
+    return "unknown";
+}
+
+const char* modeName(LoadMode mode) {
+    return mode == LoadMode::OPEN ? "open" : "closed";
+}
+
+void printReport(const LoadConfig& config, const LoadResult& result) {
+    const LoadStats& stats = *result.stats;
+    uint64_t intervalNs = 0;
+    auto series = collectSeries(config, result, intervalNs);
+
+    std::printf("%s, %s loop", scenarioName(config.scenario), modeName(config.mode));
+    if (config.mode == LoadMode::OPEN) std::printf(" at %.1f/s", config.rate);
+    std::printf(", %u connections%s, %.1f s after %.1f s warmup\n", config.connections,
+                config.keepAlive ? " (keep-alive)" : "", config.durationS, config.warmupS);
+
+    uint64_t succeeded = stats.succeeded.load();
+    std::printf("requests:  %" PRIu64 " ok, %" PRIu64 " failed in %.2f s = %.1f/s\n", succeeded,
+                stats.requests.load() - succeeded, result.measuredS, succeeded / result.measuredS);
+    std::printf("responses: 2xx %" PRIu64 ", 429 %" PRIu64 ", 4xx %" PRIu64 ", 5xx %" PRIu64 ", errors %" PRIu64
+                ", %.1f MB received\n",
+                stats.status2xx.load(), stats.status429.load(), stats.status4xx.load(), stats.status5xx.load(),
+                stats.ioErrors.load(), stats.bytesReceived.load() / 1e6);
+    if (config.mode == LoadMode::OPEN) {
+        // Each connection has one request outstanding: late sends mean it needs more of them
+        std::printf("late sends: %" PRIu64 "%s\n", stats.lateSends.load(),
+                    stats.lateSends.load() ? " (server behind or too few connections; latency still counts from due time)" : "");
+    } else {
+        std::printf("correction interval: %.3f ms\n", ms(intervalNs));
+    }
+
+    std::printf("\n%-12s %10s", "latency ms", "count");
+    for (const Percentile& p : PERCENTILES) std::printf(" %9s", p.name);
+    std::printf(" %9s\n", "mean");
+    for (const Series& s : series) {
+        std::printf("%-12s %10" PRIu64, s.name, s.snapshot->count);
+        for (const Percentile& p : PERCENTILES) std::printf(" %9.3f", ms(s.snapshot->quantile(p.q)));
+        std::printf(" %9.3f\n", mean(*s.snapshot) / 1e6);
+    }
+}
+
+std::string reportJson(const LoadConfig& config, const LoadResult& result) {
+    const LoadStats& stats = *result.stats;
+    uint64_t intervalNs = 0;
+    auto series = collectSeries(config, result, intervalNs);
+
+    std::string out = "{\n";
+    appendf(out, "  \"scenario\": \"%s\",\n  \"mode\": \"%s\",\n", scenarioName(config.scenario), modeName(config.mode));
+    appendf(out, "  \"config\": {\"rate\": %.10g, \"connections\": %u, \"duration_s\": %.10g, \"warmup_s\": %.10g, "
+                 "\"keep_alive\": %s, \"audio_ms\": %u, \"chunk_ms\": %u, \"pace\": %s, \"think_ms\": %.10g},\n",
+            config.rate, config.connections, config.durationS, config.warmupS, config.keepAlive ? "true" : "false",
+            config.audioMs, config.chunkMs, config.pace ? "true" : "false", config.thinkMs);
+    appendf(out, "  \"measured_s\": %.10g,\n  \"requests\": %" PRIu64 ",\n  \"succeeded\": %" PRIu64 ",\n"
+                 "  \"throughput_per_s\": %.10g,\n",
+            result.measuredS, stats.requests.load(), stats.succeeded.load(), stats.succeeded.load() / result.measuredS);
+    appendf(out, "  \"responses\": {\"2xx\": %" PRIu64 ", \"429\": %" PRIu64 ", \"4xx\": %" PRIu64 ", \"5xx\": %" PRIu64
+                 ", \"errors\": %" PRIu64 "},\n",
+            stats.status2xx.load(), stats.status429.load(), stats.status4xx.load(), stats.status5xx.load(),
+            stats.ioErrors.load());
+    appendf(out, "  \"bytes_received\": %" PRIu64 ",\n  \"late_sends\": %" PRIu64 ",\n  \"correction_interval_ns\": %" PRIu64 ",\n",
+            stats.bytesReceived.load(), stats.lateSends.load(), intervalNs);
+
+    out += "  \"latency\": {";
+    for (size_t i = 0; i < series.size(); ++i) {
+        const LoadHistogram::Snapshot& snapshot = *series[i].snapshot;
+        appendf(out, "%s\n    \"%s\": {\"count\": %" PRIu64 ", \"mean_ns\": %.10g", i ? "," : "", series[i].name,
+                snapshot.count, mean(snapshot));
+        for (const Percentile& p : PERCENTILES) {
+            appendf(out, ", \"%s_ns\": %" PRIu64, p.name, snapshot.quantile(p.q));
+        }
+        out += "}";
+    }
+    out += "\n  }\n}\n";
+    return out;
+}
+
+}}
@@ -0,0 +1,28 @@
+#ifndef LOADGEN_LOAD_REPORT_HPP
+#define LOADGEN_LOAD_REPORT_HPP
+
+#include "LoadGenerator.hpp"
+
+#include <string>
+
+namespace app { namespace loadgen {
+
+/**
+ * HdrHistogram's correction for closed-loop samples: while one request took v,
+ * the requests that would have been sent every expectedIntervalNs in the meantime
+ * were not, so v also stands for v - interval, v - 2 * interval, ... down to the
+ * interval. out gets raw plus those samples (0 interval: a plain copy).
+ */
+void correctCoordinatedOmission(const LoadHistogram::Snapshot& raw, uint64_t expectedIntervalNs,
+                                LoadHistogram::Snapshot& out);
+
+// Text summary for a terminal, and the same numbers as JSON (latencies in ns)
+void printReport(const LoadConfig& config, const LoadResult& result);
+std::string reportJson(const LoadConfig& config, const LoadResult& result);
+
+const char* scenarioName(Scenario scenario);
+const char* modeName(LoadMode mode);
+
+}}
+
+#endif
@@ -0,0 +1,112 @@
+#include "LoadGenerator.hpp"
+#include "LoadReport.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+using app::loadgen::LoadConfig;
+using app::loadgen::LoadMode;
+using app::loadgen::Scenario;
+
+int usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [options] process|audio|session\n"
+        "  --host H --port P          server (127.0.0.1:8000)\n"
+        "  --mode open|closed         fixed arrival rate, or back-to-back per connection (closed)\n"
+        "  --rate R                   open loop: requests (sessions) per second (100)\n"
+        "  --connections C            (8)\n"
+        "  --duration S --warmup S    measured seconds (10) after warmup seconds (2)\n"
+        "  --no-keep-alive            a new connection per request\n"
+        "  --timeout-ms MS            per send / receive (30000)\n"
+        "  --message TEXT             /process message\n"
+        "  --audio-ms MS              audio per request or session (1000)\n"
+        "  --chunk-ms MS              session append size, up to 1000 (100)\n"
+        "  --pace                     session appends due every chunk-ms, like a live source\n"
+        "  --accept TYPE              /audio/stream Accept, e.g. application/x-ndjson\n"
+        "  --header 'Name: value'     added to every request, repeatable\n"
+        "  --think-ms MS              closed loop: pause between requests\n"
+        "  --expected-interval-ms MS  closed loop correction interval (median + think time)\n"
+        "  --json FILE                also write the results as JSON\n",
+        argv0);
+    return 2;
+}
+
+bool parseNumber(const char* text, double& out) {
+    char* end = nullptr;
+    out = std::strtod(text, &end);
+    return end != text && *end == '\0' && out >= 0;
+}
+
+}
+
+// Prints the summary to stdout; exits 1 if nothing succeeded or the JSON could not be written
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    const char* jsonPath = nullptr;
+    bool haveScenario = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        double number = 0;
+        bool numeric = value && parseNumber(value, number);
+
+        if (arg == "--no-keep-alive") {
+            config.keepAlive = false;
+        } else if (arg == "--pace") {
+            config.pace = true;
+        } else if (arg[0] != '-') {
+            if (arg == "process") config.scenario = Scenario::PROCESS;
+            else if (arg == "audio") config.scenario = Scenario::AUDIO;
+            else if (arg == "session") config.scenario = Scenario::SESSION;
+            else return usage(argv[0]);
+            haveScenario = true;
+        } else if (!value) {
+            return usage(argv[0]);
+        } else {
+            ++i;
+            if (arg == "--host") config.host = value;
+            else if (arg == "--mode" && std::strcmp(value, "open") == 0) config.mode = LoadMode::OPEN;
+            else if (arg == "--mode" && std::strcmp(value, "closed") == 0) config.mode = LoadMode::CLOSED;
+            else if (arg == "--message") config.message = value;
+            else if (arg == "--accept") config.accept = value;
+            else if (arg == "--header") config.extraHeaders += std::string(value) + "\r\n";
+            else if (arg == "--json") jsonPath = value;
+            else if (!numeric) return usage(argv[0]);
+            else if (arg == "--port" && number >= 1 && number <= 65535) config.port = (uint16_t)number;
+            else if (arg == "--rate" && number > 0) config.rate = number;
+            else if (arg == "--connections" && number >= 1) config.connections = (uint32_t)number;
+            else if (arg == "--duration" && number > 0) config.durationS = number;
+            else if (arg == "--warmup") config.warmupS = number;
+            else if (arg == "--timeout-ms" && number >= 1) config.timeoutMs = (int)number;
+            else if (arg == "--audio-ms" && number >= 1) config.audioMs = (uint32_t)number;
+            else if (arg == "--chunk-ms" && number >= 1 && number <= 1000) config.chunkMs = (uint32_t)number;
+            else if (arg == "--think-ms") config.thinkMs = number;
+            else if (arg == "--expected-interval-ms") config.expectedIntervalMs = number;
+            else return usage(argv[0]);
+        }
+    }
+    if (!haveScenario) {
+        return usage(argv[0]);
+    }
+
+    app::loadgen::LoadGenerator generator(config);
+    auto result = generator.run();
+    app::loadgen::printReport(config, result);
+
+    if (jsonPath) {
+        FILE* file = std::fopen(jsonPath, "w");
+        std::string json = app::loadgen::reportJson(config, result);
+        if (!file || std::fwrite(json.data(), 1, json.size(), file) != json.size()) {
+            std::fprintf(stderr, "could not write %s\n", jsonPath);
+            if (file) std::fclose(file);
+            return 1;
+        }
+        std::fclose(file);
+    }
+    return result.stats->succeeded.load() > 0 ? 0 : 1;
+}
@@ -5,6 +5,7 @@
 #include "controller/MyController.hpp"
 #include <iostream>
 #include <cstring>
+#include <cstdlib>
 
 using namespace app;
 using namespace app::controller;
@@ -15,16 +16,18 @@ void run(const char* execPath) {
     // Start Worker Manager
     OATPP_COMPONENT(std::shared_ptr<app::worker::WorkerManager>, workerManager);
     
-    // Start 4 workers by default (as per requirements target)
+    // 4 workers to begin with (WHISPER_WORKERS), then between WHISPER_MIN/MAX_WORKERS as load goes
     // We pass the executable path so manager can fork/exec
-    workerManager->start(4, execPath);
+    OATPP_COMPONENT(std::shared_ptr<AppConfig>, config);
+    workerManager->start((int)config->workers, execPath, config->scaling);
 
     OATPP_COMPONENT(std::shared_ptr<oatpp::web::server::HttpRouter>, router);
 
     OATPP_COMPONENT(std::shared_ptr<oatpp::data::mapping::ObjectMapper>, objectMapper);
     OATPP_COMPONENT(std::shared_ptr<app::service::AudioService>, audioService);
+    OATPP_COMPONENT(std::shared_ptr<app::service::AdmissionControl>, admissionControl);
 
-    auto myController = std::make_shared<MyController>(objectMapper, audioService);
+    auto myController = std::make_shared<MyController>(objectMapper, audioService, admissionControl);
     router->addController(myController);
 
     OATPP_COMPONENT(std::shared_ptr<oatpp::network::ConnectionHandler>, connectionHandler);
@@ -44,9 +47,8 @@ void run(const char* execPath) {
 int main(int argc, const char * argv[]) {
     // Check for worker flag
     if (argc > 1 && strcmp(argv[1], "--worker") == 0) {
-        // Run as Worker Process
-        app::worker::runWorker();
-        return 0;
+        // Run as Worker Process, in the SHM slot the host gave us
+        return app::worker::runWorker(argc > 2 ? std::atoi(argv[2]) : -1);
     }
 
     oatpp::base::Environment::init();
@@ -12,9 +12,17 @@
 #include "worker/Bridge.hpp"
 #include "worker/WorkerManager.hpp"
 #include "service/AudioService.hpp"
+#include "service/AdmissionControl.hpp"
+#include "service/Metrics.hpp"
 #include "errorhandler/GlobalErrorHandler.hpp"
+#include "dto/FloatVector.hpp"
 #include "AppConfig.hpp"
 
+#ifdef WHISPER_WEBSOCKET
+#include "oatpp-websocket/AsyncConnectionHandler.hpp"
+#include "controller/LiveSocket.hpp"
+#endif
+
 namespace app {
 
 using namespace app::service;
@@ -36,7 +44,10 @@ public:
     }());
 
     OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::data::mapping::ObjectMapper>, apiObjectMapper)([] {
-        return oatpp::parser::json::mapping::ObjectMapper::createShared();
+        auto objectMapper = oatpp::parser::json::mapping::ObjectMapper::createShared();
+        // Feature arrays skip the generic per-element path
+        objectMapper->getSerializer()->setSerializerMethod(app::dto::FloatVector::Class::CLASS_ID, &app::dto::serializeFloatVector);
+        return objectMapper;
     }());
 
     OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::network::ServerConnectionProvider>, serverConnectionProvider)([] {
@@ -63,13 +74,39 @@ public:
     }());
 
     OATPP_CREATE_COMPONENT(std::shared_ptr<WorkerManager>, workerManager)([] {
-        return std::make_shared<WorkerManager>();
+        OATPP_COMPONENT(std::shared_ptr<AppConfig>, config);
+        return std::make_shared<WorkerManager>(config->ipc, config->maxInFlight, config->taskTimeoutMs);
     }());
 
     OATPP_CREATE_COMPONENT(std::shared_ptr<AudioService>, audioService)([] {
+        OATPP_COMPONENT(std::shared_ptr<AppConfig>, config);
+        OATPP_COMPONENT(std::shared_ptr<WorkerManager>, manager);
+        // One upload may keep every worker busy
+        return std::make_shared<AudioService>(manager, std::max(config->scaling.maxWorkers, UPLOAD_MAX_IN_FLIGHT));
+    }());
+
+    OATPP_CREATE_COMPONENT(std::shared_ptr<AdmissionControl>, admissionControl)([] {
+        OATPP_COMPONENT(std::shared_ptr<AppConfig>, config);
         OATPP_COMPONENT(std::shared_ptr<WorkerManager>, manager);
-        return std::make_shared<AudioService>(manager);
+        return std::make_shared<AdmissionControl>(manager, config->admission);
+    }());
+
+    // Host-side histograms for /metrics (the workers keep theirs in SHM)
+    OATPP_CREATE_COMPONENT(std::shared_ptr<Metrics>, metrics)([] {
+        return std::make_shared<Metrics>();
+    }());
+
+#ifdef WHISPER_WEBSOCKET
+    // Takes over connections upgraded on GET /audio/live
+    OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::network::ConnectionHandler>, websocketConnectionHandler)("websocket", [] {
+        OATPP_COMPONENT(std::shared_ptr<oatpp::async::Executor>, executor);
+        OATPP_COMPONENT(std::shared_ptr<AudioService>, audioService);
+        auto connectionHandler = oatpp::websocket::AsyncConnectionHandler::createShared(executor);
+        connectionHandler->setSocketInstanceListener(
+            std::make_shared<app::controller::LiveSocketInstanceListener>(audioService, executor));
+        return connectionHandler;
     }());
+#endif
     
 };
 
@@ -1,16 +1,70 @@
 #ifndef AppConfig_hpp
 #define AppConfig_hpp
 
+#include "worker/SharedMemoryStructs.hpp"
+#include "worker/Autoscaler.hpp"
+#include "service/AdmissionControl.hpp"
 #include <string>
+#include <cstdlib>
 
 namespace app {
 
 class AppConfig {
+private:
+    template<typename T>
+    static T envOr(const char* name, T fallback) {
+        const char* value = std::getenv(name);
+        if (!value || !*value) return fallback;
+        return (T)std::strtoull(value, nullptr, 10);
+    }
 public:
     std::string host = "0.0.0.0";
     uint16_t port = 8000;
+
+    // IPC sizing, fixed for the lifetime of the SHM segment
+    worker::IpcConfig ipc;
+    // Tasks the host can track at once (completion table entries)
+    size_t maxInFlight = worker::DEFAULT_MAX_IN_FLIGHT;
+    // Worker processes at startup; one upload may be spread over up to scaling.maxWorkers
+    size_t workers = 4;
+    // The pool grows and shrinks between these with load (min == max pins it)
+    worker::ScalingConfig scaling;
+    // Tasks the workers haven't answered after this long fail with 504 (0 = wait forever)
+    uint64_t taskTimeoutMs = worker::DEFAULT_TASK_TIMEOUT_MS;
+    // Queue-wait budgets per route and per-client rate limits
+    service::AdmissionControl::Config admission;
+
+    AppConfig() {
+        ipc.ringCapacity = envOr<uint32_t>("WHISPER_RING_CAPACITY", ipc.ringCapacity);
+        ipc.arenaBytes = envOr<uint64_t>("WHISPER_ARENA_BYTES", ipc.arenaBytes);
+        ipc.maxPayloadBytes = envOr<uint64_t>("WHISPER_MAX_PAYLOAD_BYTES", ipc.maxPayloadBytes);
+        ipc.batchMax = envOr<uint32_t>("WHISPER_BATCH_MAX", ipc.batchMax);
+        ipc.batchLingerUs = envOr<uint32_t>("WHISPER_BATCH_LINGER_US", ipc.batchLingerUs);
+        ipc.priorityWeights[worker::PRIORITY_INTERACTIVE] = envOr<uint32_t>("WHISPER_WEIGHT_INTERACTIVE", ipc.priorityWeights[worker::PRIORITY_INTERACTIVE]);
+        ipc.priorityWeights[worker::PRIORITY_NORMAL] = envOr<uint32_t>("WHISPER_WEIGHT_NORMAL", ipc.priorityWeights[worker::PRIORITY_NORMAL]);
+        ipc.priorityWeights[worker::PRIORITY_BATCH] = envOr<uint32_t>("WHISPER_WEIGHT_BATCH", ipc.priorityWeights[worker::PRIORITY_BATCH]);
+        ipc.traceSampleEvery = envOr<uint32_t>("WHISPER_TRACE_SAMPLE", ipc.traceSampleEvery);
+        ipc.featureCacheBytes = envOr<uint64_t>("WHISPER_FEATURE_CACHE_BYTES", ipc.featureCacheBytes);
+        maxInFlight = envOr<size_t>("WHISPER_MAX_IN_FLIGHT", maxInFlight);
+        workers = envOr<size_t>("WHISPER_WORKERS", workers);
+        scaling.minWorkers = envOr<size_t>("WHISPER_MIN_WORKERS", 1);
+        scaling.maxWorkers = envOr<size_t>("WHISPER_MAX_WORKERS", worker::MAX_WORKERS);
+        scaling.scaleUpAfterMs = envOr<uint64_t>("WHISPER_SCALE_UP_AFTER_MS", scaling.scaleUpAfterMs);
+        scaling.scaleDownAfterMs = envOr<uint64_t>("WHISPER_SCALE_DOWN_AFTER_MS", scaling.scaleDownAfterMs);
+        taskTimeoutMs = envOr<uint64_t>("WHISPER_TASK_TIMEOUT_MS", taskTimeoutMs);
+
+        using Route = service::AdmissionControl::Route;
+        admission.budgetMs[Route::ROUTE_PROCESS] = envOr<uint64_t>("WHISPER_BUDGET_PROCESS_MS", admission.budgetMs[Route::ROUTE_PROCESS]);
+        admission.budgetMs[Route::ROUTE_AUDIO] = envOr<uint64_t>("WHISPER_BUDGET_AUDIO_MS", admission.budgetMs[Route::ROUTE_AUDIO]);
+        admission.budgetMs[Route::ROUTE_STREAM] = envOr<uint64_t>("WHISPER_BUDGET_STREAM_MS", admission.budgetMs[Route::ROUTE_STREAM]);
+        admission.clientRate = (double)envOr<uint64_t>("WHISPER_CLIENT_RATE", (uint64_t)admission.clientRate);
+        admission.clientBurst = (double)envOr<uint64_t>("WHISPER_CLIENT_BURST", (uint64_t)admission.clientBurst);
+        if (workers < 1 || workers > worker::MAX_WORKERS) workers = 4;
+        if (scaling.maxWorkers < 1 || scaling.maxWorkers > worker::MAX_WORKERS) scaling.maxWorkers = worker::MAX_WORKERS;
+        if (scaling.minWorkers > scaling.maxWorkers) scaling.minWorkers = scaling.maxWorkers;
+    }
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
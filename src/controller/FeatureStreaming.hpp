@@ -0,0 +1,195 @@
+#ifndef FeatureStreaming_hpp
+#define FeatureStreaming_hpp
+
+#include "service/AudioService.hpp"
+#include "service/FeatureStream.hpp"
+#include "dto/FloatVector.hpp"
+#include "utils/FloatJson.hpp"
+
+#include "oatpp/web/protocol/http/incoming/Request.hpp"
+#include "oatpp/core/data/stream/Stream.hpp"
+#include "oatpp/core/async/Coroutine.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace app { namespace controller {
+
+using namespace app::service;
+
+// Moves a result (and its SHM block) into a DTO field; the block is released with the DTO.
+inline app::dto::FloatVector featureVector(MelFeatures&& features) {
+    auto held = std::make_shared<MelFeatures>(std::move(features));
+    return app::dto::FloatArray::view(held->data(), held->count, held);
+}
+
+/**
+ * Feeds a request body into a FeatureUpload as it comes off the socket and
+ * collects finished chunks on the way. When the upload's window is full the
+ * body transfer suspends on the oldest chunk instead of reading further.
+ */
+class FeatureUploadCallback : public oatpp::data::stream::WriteCallback {
+private:
+    std::shared_ptr<FeatureUpload> m_upload;
+    std::vector<float> m_features;
+public:
+    explicit FeatureUploadCallback(const std::shared_ptr<FeatureUpload>& upload)
+        : m_upload(upload)
+    {}
+
+    // Moves finished chunks out of SHM, freeing room in the window
+    void collect() {
+        MelFeatures chunk;
+        while (m_upload->takeReady(chunk)) {
+            m_features.insert(m_features.end(), chunk.data(), chunk.data() + chunk.count);
+        }
+    }
+
+    const std::vector<float>& features() const { return m_features; }
+
+    // Hands the collected features to a DTO without copying them
+    static app::dto::FloatVector featureVector(const std::shared_ptr<FeatureUploadCallback>& callback) {
+        return app::dto::FloatArray::view(callback->m_features.data(), callback->m_features.size(), callback);
+    }
+
+    oatpp::v_io_size write(const void* data, v_buff_size count, oatpp::async::Action& action) override {
+        collect();
+        size_t written = m_upload->write(data, (size_t)count);
+        if (written == 0 && count > 0) {
+            action = oatpp::async::Action::createWaitListAction(m_upload->oldest()->waitList());
+            return oatpp::IOError::RETRY_WRITE;
+        }
+        return (oatpp::v_io_size)written;
+    }
+};
+
+/**
+ * Reads the request body into a FeatureStream. Runs as its own coroutine so the
+ * response can start streaming before the body has finished arriving.
+ */
+class FeatureStreamReader : public oatpp::async::Coroutine<FeatureStreamReader> {
+private:
+    class BodyCallback : public oatpp::data::stream::WriteCallback {
+    private:
+        std::shared_ptr<FeatureStream> m_stream;
+    public:
+        explicit BodyCallback(const std::shared_ptr<FeatureStream>& stream) : m_stream(stream) {}
+
+        oatpp::v_io_size write(const void* data, v_buff_size count, oatpp::async::Action& action) override {
+            size_t written = m_stream->write(data, (size_t)count, action);
+            if (!action.isNone()) {
+                return oatpp::IOError::RETRY_WRITE;
+            }
+            return (oatpp::v_io_size)written;
+        }
+    };
+
+    std::shared_ptr<oatpp::web::protocol::http::incoming::Request> m_request;
+    std::shared_ptr<FeatureStream> m_stream;
+
+public:
+    FeatureStreamReader(const std::shared_ptr<oatpp::web::protocol::http::incoming::Request>& request,
+                        const std::shared_ptr<FeatureStream>& stream)
+        : m_request(request)
+        , m_stream(stream)
+    {}
+
+    Action act() override {
+        return m_request->transferBodyToStreamAsync(std::make_shared<BodyCallback>(m_stream))
+            .next(yieldTo(&FeatureStreamReader::onBodyRead));
+    }
+
+    Action onBodyRead() {
+        m_stream->finish();
+        return finish();
+    }
+
+    Action handleError(Error* error) override {
+        m_stream->fail(error ? error->what() : "Request body read failed");
+        return error;
+    }
+};
+
+/**
+ * Response body for the NDJSON mode of /audio/stream: one line per chunk as soon
+ * as the worker finishes it, then a summary line (or an error line).
+ *
+ *   {"frame_offset":0,"frame_count":98,"features":[...]}
+ *   {"done":true,"sample_count":16000,"frame_count":98}
+ */
+class NdjsonFeatureBody : public oatpp::data::stream::ReadCallback {
+private:
+    std::shared_ptr<FeatureStream> m_stream;
+    std::string m_pending;
+    size_t m_pos = 0;
+    uint64_t m_frames = 0;
+    bool m_ended = false;
+
+    void appendChunk(const StreamChunk& chunk) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%llu", (unsigned long long)chunk.frameOffset);
+        m_pending += "{\"frame_offset\":";
+        m_pending += number;
+        std::snprintf(number, sizeof(number), "%llu", (unsigned long long)chunk.features.frames());
+        m_pending += ",\"frame_count\":";
+        m_pending += number;
+        m_pending += ",\"features\":";
+        app::utils::FloatJson::appendArray(m_pending, chunk.features.data(), chunk.features.count);
+        m_pending += "}\n";
+        m_frames += chunk.features.frames();
+    }
+
+    void appendEnd() {
+        char line[128];
+        std::snprintf(line, sizeof(line), "{\"done\":true,\"sample_count\":%llu,\"frame_count\":%llu}\n",
+                      (unsigned long long)m_stream->sampleCount(), (unsigned long long)m_frames);
+        m_pending += line;
+    }
+
+    void appendError(const std::string& error) {
+        m_pending += "{\"error\":\"";
+        for (char c : error) {
+            if (c == '"' || c == '\\') m_pending += '\\';
+            if ((unsigned char)c >= 0x20) m_pending += c;
+        }
+        m_pending += "\"}\n";
+    }
+
+public:
+    explicit NdjsonFeatureBody(const std::shared_ptr<FeatureStream>& stream) : m_stream(stream) {}
+
+    // Client gone mid-stream: let the body reader stop instead of waiting for room forever
+    ~NdjsonFeatureBody() override {
+        m_stream->fail("Response closed");
+    }
+
+    oatpp::v_io_size read(void* buffer, v_buff_size count, oatpp::async::Action& action) override {
+        while (m_pos == m_pending.size()) {
+            if (m_ended) {
+                return 0;
+            }
+            m_pending.clear();
+            m_pos = 0;
+
+            StreamChunk chunk;
+            switch (m_stream->next(chunk, action)) {
+                case FeatureStream::Next::FEATURES: appendChunk(chunk); break;
+                case FeatureStream::Next::WAIT: return oatpp::IOError::RETRY_READ;
+                case FeatureStream::Next::END: appendEnd(); m_ended = true; break;
+                case FeatureStream::Next::FAILED: appendError(m_stream->error()); m_ended = true; break;
+            }
+        }
+
+        size_t n = std::min((size_t)count, m_pending.size() - m_pos);
+        std::memcpy(buffer, m_pending.data() + m_pos, n);
+        m_pos += n;
+        return (oatpp::v_io_size)n;
+    }
+};
+
+}}
+
+#endif // FeatureStreaming_hpp
@@ -0,0 +1,197 @@
+#ifndef LiveSocket_hpp
+#define LiveSocket_hpp
+
+#include "service/LiveStream.hpp"
+
+#include "oatpp-websocket/AsyncConnectionHandler.hpp"
+#include "oatpp-websocket/AsyncWebSocket.hpp"
+#include "oatpp/core/async/Executor.hpp"
+#include "oatpp/core/async/Lock.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace app { namespace controller {
+
+using namespace app::service;
+
+/**
+ * GET /audio/live (WebSocket).
+ *
+ *   client -> server  binary messages of PCM16 mono 16 kHz, any size (20 ms frames are typical);
+ *                     the text message "end" means no more audio
+ *   server -> client  one binary message per finished append:
+ *                     u64 frame_offset, u32 frame_count (little-endian), then
+ *                     frame_count x 80 float32, frame-major
+ *                     then a close frame (1000 after "end", 1011 with the error otherwise)
+ *
+ * Reading and sending are two coroutines sharing a LiveStream; neither holds an
+ * executor thread while waiting for a worker or for room in the buffer.
+ */
+struct LiveConnection {
+    std::shared_ptr<LiveStream> stream;
+    oatpp::async::Lock writeLock;   // mel frames and pongs must not interleave on the wire
+
+    explicit LiveConnection(const std::shared_ptr<LiveStream>& liveStream) : stream(liveStream) {}
+};
+
+// Pushes one received message into the stream, waiting for buffer room as needed
+class LiveAudioFeeder : public oatpp::async::Coroutine<LiveAudioFeeder> {
+private:
+    std::shared_ptr<LiveStream> m_stream;
+    std::string m_data;
+    size_t m_pos = 0;
+public:
+    LiveAudioFeeder(const std::shared_ptr<LiveStream>& stream, const char* data, size_t size)
+        : m_stream(stream)
+        , m_data(data, size)
+    {}
+
+    Action act() override {
+        if (m_pos == m_data.size()) {
+            return finish();
+        }
+        Action action;
+        m_pos += m_stream->write(m_data.data() + m_pos, m_data.size() - m_pos, action);
+        if (!action.isNone()) {
+            return action;
+        }
+        return repeat();
+    }
+};
+
+// Sends mel frames as soon as each append finishes, then closes the socket
+class LiveMelSender : public oatpp::async::Coroutine<LiveMelSender> {
+private:
+    std::shared_ptr<oatpp::websocket::AsyncWebSocket> m_socket;
+    std::shared_ptr<LiveConnection> m_connection;
+
+    static oatpp::String encode(const StreamChunk& chunk) {
+        uint64_t offset = chunk.frameOffset;
+        uint32_t frames = (uint32_t)chunk.features.frames();
+        size_t bytes = chunk.features.count * sizeof(float);
+
+        std::string message(sizeof(offset) + sizeof(frames) + bytes, '\0');
+        std::memcpy(&message[0], &offset, sizeof(offset));
+        std::memcpy(&message[sizeof(offset)], &frames, sizeof(frames));
+        std::memcpy(&message[sizeof(offset) + sizeof(frames)], chunk.features.data(), bytes);
+        return oatpp::String(std::move(message));
+    }
+
+    Action close(v_uint16 code, const oatpp::String& message) {
+        return oatpp::async::synchronize(&m_connection->writeLock, m_socket->sendCloseAsync(code, message))
+            .next(finish());
+    }
+
+public:
+    LiveMelSender(const std::shared_ptr<oatpp::websocket::AsyncWebSocket>& socket,
+                  const std::shared_ptr<LiveConnection>& connection)
+        : m_socket(socket)
+        , m_connection(connection)
+    {}
+
+    Action act() override {
+        Action action;
+        StreamChunk chunk;
+        switch (m_connection->stream->next(chunk, action)) {
+            case LiveStream::Next::FEATURES:
+                if (chunk.features.count == 0) {
+                    return repeat(); // Append too short to complete a frame
+                }
+                return oatpp::async::synchronize(&m_connection->writeLock, m_socket->sendOneFrameBinaryAsync(encode(chunk)))
+                    .next(repeat());
+            case LiveStream::Next::WAIT:
+                return action;
+            case LiveStream::Next::END:
+                return close(1000, "end");
+            default:
+                return close(1011, m_connection->stream->error().c_str());
+        }
+    }
+
+    Action handleError(Error* error) override {
+        m_connection->stream->fail(error ? error->what() : "Send failed");
+        return error;
+    }
+};
+
+class LiveSocketListener : public oatpp::websocket::AsyncWebSocket::Listener {
+private:
+    std::shared_ptr<LiveConnection> m_connection;
+    std::string m_text;
+public:
+    explicit LiveSocketListener(const std::shared_ptr<LiveConnection>& connection) : m_connection(connection) {}
+
+    const std::shared_ptr<LiveConnection>& connection() const { return m_connection; }
+
+    CoroutineStarter onPing(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& message) override {
+        return oatpp::async::synchronize(&m_connection->writeLock, socket->sendPongAsync(message));
+    }
+
+    CoroutineStarter onPong(const std::shared_ptr<AsyncWebSocket>& socket, const oatpp::String& message) override {
+        return nullptr;
+    }
+
+    CoroutineStarter onClose(const std::shared_ptr<AsyncWebSocket>& socket, v_uint16 code, const oatpp::String& message) override {
+        m_connection->stream->finish();
+        return nullptr;
+    }
+
+    // Called with consecutive pieces of a message, then size == 0 at its end
+    CoroutineStarter readMessage(const std::shared_ptr<AsyncWebSocket>& socket, v_uint8 opcode, p_char8 data, oatpp::v_io_size size) override {
+        if (opcode == oatpp::websocket::Frame::OPCODE_BINARY) {
+            if (size > 0) {
+                return LiveAudioFeeder::start(m_connection->stream, reinterpret_cast<const char*>(data), (size_t)size);
+            }
+            return nullptr;
+        }
+
+        if (size > 0) {
+            if (m_text.size() + (size_t)size <= 64) {
+                m_text.append(reinterpret_cast<const char*>(data), (size_t)size);
+            }
+        } else {
+            if (m_text == "end") {
+                m_connection->stream->finish();
+            }
+            m_text.clear();
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * Wires every upgraded connection to its own LiveStream and sender coroutine.
+ */
+class LiveSocketInstanceListener : public oatpp::websocket::AsyncConnectionHandler::SocketInstanceListener {
+private:
+    std::shared_ptr<AudioService> m_audioService;
+    std::shared_ptr<oatpp::async::Executor> m_executor;
+public:
+    LiveSocketInstanceListener(const std::shared_ptr<AudioService>& audioService,
+                               const std::shared_ptr<oatpp::async::Executor>& executor)
+        : m_audioService(audioService)
+        , m_executor(executor)
+    {}
+
+    void onAfterCreate_NonBlocking(const std::shared_ptr<oatpp::websocket::AsyncWebSocket>& socket,
+                                   const std::shared_ptr<const ParameterMap>& params) override {
+        // Without a free session the stream starts failed: the sender closes with the reason
+        auto connection = std::make_shared<LiveConnection>(std::make_shared<LiveStream>(m_audioService));
+        socket->setListener(std::make_shared<LiveSocketListener>(connection));
+        m_executor->execute<LiveMelSender>(socket, connection);
+    }
+
+    void onBeforeDestroy_NonBlocking(const std::shared_ptr<oatpp::websocket::AsyncWebSocket>& socket) override {
+        // Connection gone: stop the sender, whatever it was waiting for
+        auto listener = std::dynamic_pointer_cast<LiveSocketListener>(socket->getListener());
+        if (listener) {
+            listener->connection()->stream->fail("Connection closed");
+        }
+        socket->setListener(nullptr);
+    }
+};
+
+}}
+
+#endif // LiveSocket_hpp
@@ -6,14 +6,28 @@
 #include "dto/ErrorDto.hpp"
 #include "dto/BaseResponseDto.hpp"
 #include "dto/AudioFeatureDto.hpp"
+#include "dto/StreamSessionDto.hpp"
+#include "dto/QueueStatsDto.hpp"
 
 #include "oatpp/web/server/api/ApiController.hpp"
+#include "oatpp/web/protocol/http/outgoing/StreamingBody.hpp"
+#include "oatpp/core/async/Executor.hpp"
 #include "oatpp/core/macro/component.hpp"
 #include "oatpp/core/macro/codegen.hpp"
 #include "oatpp/parser/json/mapping/ObjectMapper.hpp"
 #include "service/AudioService.hpp"
+#include "service/AdmissionControl.hpp"
+#include "service/Metrics.hpp"
+#include "worker/Tracer.hpp"
+#include "service/FeatureFormat.hpp"
+#include "controller/FeatureStreaming.hpp"
 #include "validator/RequestValidator.hpp"
 #include "utils/ExecutionTimer.hpp"
+#include "AppConfig.hpp"
+
+#ifdef WHISPER_WEBSOCKET
+#include "oatpp-websocket/Handshaker.hpp"
+#endif
 
 namespace app { namespace controller {
 
@@ -27,14 +41,56 @@ using namespace app::utils;
 class MyController : public oatpp::web::server::api::ApiController {
 private:
     std::shared_ptr<AudioService> m_audioService;
+    std::shared_ptr<AdmissionControl> m_admission;
+    // Runs the body reader of streamed /audio/stream responses alongside the response itself
+    OATPP_COMPONENT(std::shared_ptr<oatpp::async::Executor>, m_executor);
+    OATPP_COMPONENT(std::shared_ptr<WorkerManager>, m_workerManager);
+    OATPP_COMPONENT(std::shared_ptr<AppConfig>, m_config);
+    OATPP_COMPONENT(std::shared_ptr<Metrics>, m_metrics);
+#ifdef WHISPER_WEBSOCKET
+    OATPP_COMPONENT(std::shared_ptr<oatpp::network::ConnectionHandler>, m_websocketConnectionHandler, "websocket");
+#endif
 
 public:
     MyController(const std::shared_ptr<oatpp::data::mapping::ObjectMapper>& objectMapper,
-                 const std::shared_ptr<AudioService>& audioService)
+                 const std::shared_ptr<AudioService>& audioService,
+                 const std::shared_ptr<AdmissionControl>& admission)
         : oatpp::web::server::api::ApiController(objectMapper)
         , m_audioService(audioService) 
+        , m_admission(admission)
     {}
 
+    // Rejects with 429 before anything is read or queued (see AdmissionControl)
+    void admit(AdmissionControl::Route route, const std::shared_ptr<IncomingRequest>& request) {
+        m_admission->admit(route, clientOf(request));
+    }
+
+    // Who the per-client rate limit applies to: X-Client-Id if given, else the peer address
+    static std::string clientOf(const std::shared_ptr<IncomingRequest>& request) {
+        auto clientId = request->getHeader("X-Client-Id");
+        if (clientId && !clientId->empty()) {
+            return *clientId;
+        }
+        auto peer = request->getConnection()->getInputStreamContext().getProperties().get("peer_address");
+        return peer ? *peer : std::string();
+    }
+
+    // createDtoResponse (it serializes right away), timed; closes the request's latency sample too.
+    // With the request's taskId the encoding is also a SERIALIZE span if the task is traced.
+    template<class Dto>
+    std::shared_ptr<OutgoingResponse> timedDtoResponse(Metrics::Endpoint endpoint, const ExecutionTimer& timer,
+                                                       const Status& status, const Dto& dto, uint64_t taskId = 0) {
+        uint64_t serializeNs = monotonicNowNs();
+        auto response = createDtoResponse(status, dto);
+        uint64_t serializeEndNs = monotonicNowNs();
+        m_metrics->recordSerialization(endpoint, serializeEndNs - serializeNs);
+        m_metrics->recordLatency(endpoint, timer.getElapsedNanos());
+        if (taskId != 0) {
+            Tracer::record(TRACE_SERIALIZE, taskId, serializeNs, serializeEndNs);
+        }
+        return response;
+    }
+
 public:
     ENDPOINT_ASYNC("GET", "/hello", Hello) {
         ENDPOINT_ASYNC_INIT(Hello)
@@ -50,13 +106,74 @@ public:
         }
     };
 
+    // Per priority class: queue depth and moving averages of queue wait and latency
+    ENDPOINT_ASYNC("GET", "/queues", QueueStats) {
+        ENDPOINT_ASYNC_INIT(QueueStats)
+
+        Action act() override {
+            static const char* const NAMES[NUM_PRIORITIES] = {"interactive", "normal", "batch"};
+            auto myController = static_cast<MyController*>(controller);
+            auto& manager = myController->m_workerManager;
+
+            auto resultDto = QueueStatsDto::createShared();
+            resultDto->tasks_in_flight = (v_uint64)manager->tasksInFlight();
+            resultDto->classes = {};
+            for (uint32_t p = 0; p < NUM_PRIORITIES; ++p) {
+                PriorityStats stats = manager->priorityStats((TaskPriority)p);
+                auto classDto = PriorityClassDto::createShared();
+                classDto->name = NAMES[p];
+                classDto->weight = myController->m_config->ipc.priorityWeights[p];
+                classDto->depth = (v_uint64)stats.depth;
+                classDto->completed = stats.completed;
+                classDto->avg_queue_ms = stats.avgQueueNs / 1e6;
+                classDto->avg_latency_ms = stats.avgLatencyNs / 1e6;
+                resultDto->classes->push_back(classDto);
+            }
+            return _return(controller->createDtoResponse(Status::CODE_200, resultDto));
+        }
+    };
+
+    // Prometheus scrape (see service/Metrics.hpp)
+    ENDPOINT_ASYNC("GET", "/metrics", PrometheusMetrics) {
+        ENDPOINT_ASYNC_INIT(PrometheusMetrics)
+
+        Action act() override {
+            auto myController = static_cast<MyController*>(controller);
+            auto text = myController->m_metrics->render(myController->m_workerManager.get());
+            auto response = controller->createResponse(Status::CODE_200, oatpp::String(std::move(text)));
+            response->putHeader(oatpp::web::protocol::http::Header::CONTENT_TYPE, "text/plain; version=0.0.4");
+            return _return(response);
+        }
+    };
+
+    // Sampled stage spans from the last ?seconds=N (default 5), as a Chrome / Perfetto trace
+    ENDPOINT_ASYNC("GET", "/debug/trace", DebugTrace) {
+        ENDPOINT_ASYNC_INIT(DebugTrace)
+
+        Action act() override {
+            auto myController = static_cast<MyController*>(controller);
+            uint32_t seconds = RequestValidator::parseTraceSeconds(request->getQueryParameter("seconds"));
+            uint64_t now = monotonicNowNs();
+            uint64_t windowNs = (uint64_t)seconds * 1000 * 1000 * 1000;
+
+            std::vector<TraceSpan> spans;
+            myController->m_workerManager->collectTrace(now > windowNs ? now - windowNs : 0, spans);
+            auto response = controller->createResponse(Status::CODE_200, oatpp::String(Tracer::toChromeJson(spans)));
+            response->putHeader(oatpp::web::protocol::http::Header::CONTENT_TYPE, "application/json");
+            return _return(response);
+        }
+    };
+
     ENDPOINT_ASYNC("POST", "/process", ProcessMessage) {
         ENDPOINT_ASYNC_INIT(ProcessMessage)
         
         ExecutionTimer timer;
+        uint64_t startNs = monotonicNowNs();
+        TaskHandle pending;
 
         Action act() override {
             RequestValidator::assertContentType(request, "application/json");
+            static_cast<MyController*>(controller)->admit(AdmissionControl::ROUTE_PROCESS, request);
             return request->readBodyToDtoAsync<oatpp::Object<ProcessRequestDto>>(
                 controller->getDefaultObjectMapper()
             ).callbackTo(&ProcessMessage::onBodyRead);
@@ -64,14 +181,27 @@ public:
 
         Action onBodyRead(const oatpp::Object<ProcessRequestDto>& requestDto) {
             auto myController = static_cast<MyController*>(controller);
+            uint64_t bodyReadNs = monotonicNowNs();
             RequestValidator::validateProcessRequest(requestDto);
             
-            auto resultMessage = myController->m_audioService->processAudio(requestDto->message);
+            auto priority = RequestValidator::parsePriority(request->getHeader("X-Priority"), PRIORITY_INTERACTIVE);
+            pending = myController->m_audioService->submitText(requestDto->message, priority);
+            Tracer::record(TRACE_BODY_READ, pending.taskId(), startNs, bodyReadNs);
+            return yieldTo(&ProcessMessage::awaitResult);
+        }
+
+        // Suspends (no executor thread held) until the worker answers
+        Action awaitResult() {
+            if (!pending->isReady()) {
+                return Action::createWaitListAction(pending->waitList());
+            }
+            auto myController = static_cast<MyController*>(controller);
 
             auto responseDto = ProcessResponseDto::createShared();
-            responseDto->result = resultMessage;
+            responseDto->result = myController->m_audioService->finishText(*pending);
 
-            return _return(controller->createDtoResponse(Status::CODE_200, responseDto));
+            return _return(myController->timedDtoResponse(Metrics::ENDPOINT_PROCESS, timer, Status::CODE_200, responseDto,
+                                                          pending.taskId()));
         }
     };
 
@@ -79,25 +209,178 @@ public:
         ENDPOINT_ASYNC_INIT(StreamAudio)
         
         ExecutionTimer timer;
+        FeatureFormat format;
+        TaskPriority priority = PRIORITY_NORMAL;
+        std::shared_ptr<FeatureUpload> upload;
+        std::shared_ptr<FeatureUploadCallback> body;
 
         Action act() override {
-            // Read the binary body into a string (Oat++ handles binary safely)
-            return request->readBodyToStringAsync().callbackTo(&StreamAudio::onBodyRead);
+            auto myController = static_cast<MyController*>(controller);
+            myController->admit(AdmissionControl::ROUTE_AUDIO, request);
+
+            priority = RequestValidator::parsePriority(request->getHeader("X-Priority"), PRIORITY_NORMAL);
+            auto accept = request->getHeader("Accept");
+            format = FeatureFormat::negotiate(accept ? accept->c_str() : nullptr);
+            if (format.encoding == FeatureEncoding::NDJSON) {
+                return streamResponse();
+            }
+
+            // Chunks go to the workers while the rest of the body is still arriving
+            upload = myController->m_audioService->openUpload(priority);
+            body = std::make_shared<FeatureUploadCallback>(upload);
+            return request->transferBodyToStreamAsync(body).next(yieldTo(&StreamAudio::onBodyRead));
         }
 
-        Action onBodyRead(const oatpp::String& body) {
+        Action onBodyRead() {
+            upload->finish();
+            return yieldTo(&StreamAudio::awaitResult);
+        }
+
+        // NDJSON mode: the response goes out right away and carries each chunk as soon as
+        // it is computed, while a second coroutine keeps reading the body
+        Action streamResponse() {
             auto myController = static_cast<MyController*>(controller);
-            
-            // Process the binary audio data
-            auto features = myController->m_audioService->extractFeatures(body);
-            
+
+            auto stream = myController->m_audioService->openFeatureStream(priority);
+            myController->m_executor->execute<FeatureStreamReader>(request, stream);
+
+            auto body = std::make_shared<oatpp::web::protocol::http::outgoing::StreamingBody>(
+                std::make_shared<NdjsonFeatureBody>(stream));
+            auto response = oatpp::web::protocol::http::outgoing::Response::createShared(Status::CODE_200, body);
+            response->putHeader(oatpp::web::protocol::http::Header::CONTENT_TYPE, "application/x-ndjson");
+            // The reader may stop short of the end of the body if the stream fails; don't try to reuse the connection
+            response->putHeader(oatpp::web::protocol::http::Header::CONNECTION, oatpp::web::protocol::http::Header::Value::CONNECTION_CLOSE);
+            return _return(response);
+        }
+
+        // Collects the chunks still computing once the body is in
+        Action awaitResult() {
+            body->collect();
+            if (!upload->done()) {
+                return Action::createWaitListAction(upload->oldest()->waitList());
+            }
+            if (format.binary()) {
+                return _return(binaryResponse());
+            }
+
             auto resultDto = AudioFeatureDto::createShared();
-            resultDto->features = features;
-            resultDto->sample_count = body->size() / 2; // 16-bit = 2 bytes
+            resultDto->features = FeatureUploadCallback::featureVector(body);
+            resultDto->sample_count = (v_int64)upload->sampleCount();
+
+            auto myController = static_cast<MyController*>(controller);
+            return _return(myController->timedDtoResponse(Metrics::ENDPOINT_AUDIO, timer, Status::CODE_200, resultDto));
+        }
+
+        // The bare tensor (or .npy); everything a reader needs besides the bytes goes in headers
+        std::shared_ptr<OutgoingResponse> binaryResponse() {
+            auto myController = static_cast<MyController*>(controller);
+            const auto& features = body->features();
+            std::string bytes;
+            ExecutionTimer serialize;
+            encodeFeatures(features.data(), features.size(), format, bytes);
+            myController->m_metrics->recordSerialization(Metrics::ENDPOINT_AUDIO, serialize.getElapsedNanos());
+
+            auto shape = std::to_string(features.size() / N_MELS) + "," + std::to_string(N_MELS);
+            auto response = controller->createResponse(Status::CODE_200, oatpp::String(std::move(bytes)));
+            response->putHeader(oatpp::web::protocol::http::Header::CONTENT_TYPE, format.contentType());
+            response->putHeader("Vary", "Accept");
+            response->putHeader("X-Mel-Dtype", format.dtypeName());
+            response->putHeader("X-Mel-Shape", shape.c_str());
+            response->putHeader("X-Mel-Layout", "frame-major");
+            response->putHeader("X-Sample-Count", std::to_string(upload->sampleCount()).c_str());
+            myController->m_metrics->recordLatency(Metrics::ENDPOINT_AUDIO, timer.getElapsedNanos());
+            return response;
+        }
+    };
+
+    ENDPOINT_ASYNC("POST", "/audio/stream/session", OpenStreamSession) {
+        ENDPOINT_ASYNC_INIT(OpenStreamSession)
+
+        Action act() override {
+            auto myController = static_cast<MyController*>(controller);
+
+            auto resultDto = StreamSessionDto::createShared();
+            resultDto->session_id = myController->m_audioService->openStream();
+            resultDto->frames_emitted = 0;
+
+            return _return(controller->createDtoResponse(Status::CODE_201, resultDto));
+        }
+    };
+
+    ENDPOINT_ASYNC("POST", "/audio/stream/session/{sessionId}", AppendStreamSession) {
+        ENDPOINT_ASYNC_INIT(AppendStreamSession)
+
+        ExecutionTimer timer;
+        uint64_t startNs = monotonicNowNs();
+        uint64_t sessionId = 0;
+        v_int64 sampleCount = 0;
+        PendingStreamAppend pending;
+
+        Action act() override {
+            sessionId = RequestValidator::parseSessionId(request->getPathVariable("sessionId"));
+            static_cast<MyController*>(controller)->admit(AdmissionControl::ROUTE_STREAM, request);
+            return request->readBodyToStringAsync().callbackTo(&AppendStreamSession::onBodyRead);
+        }
+
+        Action onBodyRead(const oatpp::String& body) {
+            auto myController = static_cast<MyController*>(controller);
+
+            uint64_t bodyReadNs = monotonicNowNs();
+            sampleCount = body ? body->size() / 2 : 0;
+            pending = myController->m_audioService->submitStreamAppend(sessionId, body);
+            Tracer::record(TRACE_BODY_READ, pending.completion.taskId(), startNs, bodyReadNs);
+            return yieldTo(&AppendStreamSession::awaitResult);
+        }
+
+        Action awaitResult() {
+            if (!pending.completion->isReady()) {
+                return Action::createWaitListAction(pending.completion->waitList());
+            }
+            auto myController = static_cast<MyController*>(controller);
+
+            auto chunk = myController->m_audioService->finishStreamAppend(pending);
+
+            auto resultDto = StreamChunkDto::createShared();
+            resultDto->session_id = sessionId;
+            resultDto->frame_offset = (v_int64)chunk.frameOffset;
+            resultDto->frame_count = (v_int32)chunk.features.frames();
+            resultDto->features = featureVector(std::move(chunk.features));
+            resultDto->sample_count = sampleCount;
+
+            return _return(myController->timedDtoResponse(Metrics::ENDPOINT_SESSION_APPEND, timer, Status::CODE_200, resultDto,
+                                                          pending.completion.taskId()));
+        }
+    };
+
+    ENDPOINT_ASYNC("DELETE", "/audio/stream/session/{sessionId}", CloseStreamSession) {
+        ENDPOINT_ASYNC_INIT(CloseStreamSession)
+
+        Action act() override {
+            auto myController = static_cast<MyController*>(controller);
+            uint64_t sessionId = RequestValidator::parseSessionId(request->getPathVariable("sessionId"));
+
+            auto resultDto = StreamSessionDto::createShared();
+            resultDto->session_id = sessionId;
+            resultDto->frames_emitted = (v_int64)myController->m_audioService->closeStream(sessionId);
 
             return _return(controller->createDtoResponse(Status::CODE_200, resultDto));
         }
     };
+
+#ifdef WHISPER_WEBSOCKET
+    // Live audio: PCM16 messages in, mel frames out as each append finishes (protocol in LiveSocket.hpp)
+    ENDPOINT_ASYNC("GET", "/audio/live", LiveAudio) {
+        ENDPOINT_ASYNC_INIT(LiveAudio)
+
+        Action act() override {
+            auto myController = static_cast<MyController*>(controller);
+            myController->admit(AdmissionControl::ROUTE_STREAM, request);
+            auto response = oatpp::websocket::Handshaker::serversideHandshake(request->getHeaders(),
+                                                                              myController->m_websocketConnectionHandler);
+            return _return(response);
+        }
+    };
+#endif
     
 };
 
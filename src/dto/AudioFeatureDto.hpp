@@ -3,6 +3,7 @@
 
 #include "oatpp/core/macro/codegen.hpp"
 #include "oatpp/core/Types.hpp"
+#include "dto/FloatVector.hpp"
 
 namespace app { namespace dto {
 
@@ -14,7 +15,7 @@ class AudioFeatureDto : public oatpp::DTO {
   DTO_FIELD_INFO(features) {
     info->description = "Array of Mel Spectrogram features";
   }
-  DTO_FIELD(List<Float32>, features);
+  DTO_FIELD(FloatVector, features);
 
   DTO_FIELD_INFO(sample_count) {
     info->description = "Number of audio samples processed";
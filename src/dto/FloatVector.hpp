@@ -0,0 +1,79 @@
+#ifndef DTO_FloatVector_hpp
+#define DTO_FloatVector_hpp
+
+#include "utils/FloatJson.hpp"
+
+#include "oatpp/parser/json/mapping/Serializer.hpp"
+#include "oatpp/core/Types.hpp"
+
+#include <memory>
+
+namespace app { namespace dto {
+
+/**
+ * Contiguous float array for DTO fields. Unlike List<Float32> (a linked list of
+ * boxed floats) it is a pointer + size into memory someone else owns - a feature
+ * vector, an SHM block - kept alive through `owner` until the DTO is serialized.
+ */
+struct FloatArray {
+    const float* data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const void> owner;
+
+    static std::shared_ptr<FloatArray> view(const float* data, size_t size, std::shared_ptr<const void> owner) {
+        auto array = std::make_shared<FloatArray>();
+        array->data = data;
+        array->size = size;
+        array->owner = std::move(owner);
+        return array;
+    }
+};
+
+namespace __class {
+
+class FloatVectorClass {
+public:
+    static inline const oatpp::data::mapping::type::ClassId CLASS_ID{"app::dto::FloatVector"};
+
+    static oatpp::data::mapping::type::Type* getType() {
+        static oatpp::data::mapping::type::Type type(CLASS_ID);
+        return &type;
+    }
+};
+
+}
+
+typedef oatpp::data::mapping::type::ObjectWrapper<FloatArray, __class::FloatVectorClass> FloatVector;
+
+/**
+ * ObjectMapper hook (Serializer::setSerializerMethod): writes the whole array in
+ * one pass through a fixed block, no per-element dispatch.
+ */
+inline void serializeFloatVector(oatpp::parser::json::mapping::Serializer* serializer,
+                                 oatpp::data::stream::ConsistentOutputStream* stream,
+                                 const oatpp::Void& polymorph) {
+    (void)serializer;
+    if (!polymorph) {
+        stream->writeSimple("null", 4);
+        return;
+    }
+    auto array = static_cast<const FloatArray*>(polymorph.get());
+
+    char block[4096];
+    size_t used = 0;
+    block[used++] = '[';
+    for (size_t i = 0; i < array->size; ++i) {
+        // Room for one element and the closing bracket
+        if (used + utils::FloatJson::MAX_CHARS + 1 > sizeof(block)) {
+            stream->writeSimple(block, (v_buff_size)used);
+            used = 0;
+        }
+        used += utils::FloatJson::writeElement(block + used, array->data[i], i == 0);
+    }
+    block[used++] = ']';
+    stream->writeSimple(block, (v_buff_size)used);
+}
+
+}}
+
+#endif
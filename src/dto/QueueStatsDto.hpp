@@ -0,0 +1,50 @@
+#ifndef DTO_QueueStatsDto_hpp
+#define DTO_QueueStatsDto_hpp
+
+#include "oatpp/core/macro/codegen.hpp"
+#include "oatpp/core/Types.hpp"
+
+namespace app { namespace dto {
+
+#include OATPP_CODEGEN_BEGIN(DTO)
+
+class PriorityClassDto : public oatpp::DTO {
+    DTO_INIT(PriorityClassDto, DTO)
+
+    DTO_FIELD(String, name);
+
+    DTO_FIELD_INFO(weight) {
+        info->description = "Share of worker picks while every class has work";
+    }
+    DTO_FIELD(UInt32, weight);
+
+    DTO_FIELD_INFO(depth) {
+        info->description = "Requests waiting in this class's ring";
+    }
+    DTO_FIELD(UInt64, depth);
+
+    DTO_FIELD(UInt64, completed);
+
+    DTO_FIELD_INFO(avg_queue_ms) {
+        info->description = "Moving average of time from enqueue to a worker picking it up";
+    }
+    DTO_FIELD(Float64, avg_queue_ms);
+
+    DTO_FIELD_INFO(avg_latency_ms) {
+        info->description = "Moving average of queue + worker time";
+    }
+    DTO_FIELD(Float64, avg_latency_ms);
+};
+
+class QueueStatsDto : public oatpp::DTO {
+    DTO_INIT(QueueStatsDto, DTO)
+
+    DTO_FIELD(UInt64, tasks_in_flight);
+    DTO_FIELD(List<Object<PriorityClassDto>>, classes);
+};
+
+#include OATPP_CODEGEN_END(DTO)
+
+}}
+
+#endif
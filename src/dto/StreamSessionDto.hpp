@@ -0,0 +1,56 @@
+#ifndef DTO_StreamSessionDto_hpp
+#define DTO_StreamSessionDto_hpp
+
+#include "oatpp/core/macro/codegen.hpp"
+#include "oatpp/core/Types.hpp"
+#include "dto/FloatVector.hpp"
+
+namespace app { namespace dto {
+
+#include OATPP_CODEGEN_BEGIN(DTO)
+
+class StreamSessionDto : public oatpp::DTO {
+    DTO_INIT(StreamSessionDto, DTO)
+
+    DTO_FIELD_INFO(session_id) {
+        info->description = "Id to use in /audio/stream/session/{sessionId}";
+    }
+    DTO_FIELD(UInt64, session_id);
+
+    DTO_FIELD_INFO(frames_emitted) {
+        info->description = "Mel frames returned by this session so far";
+    }
+    DTO_FIELD(Int64, frames_emitted);
+};
+
+class StreamChunkDto : public oatpp::DTO {
+    DTO_INIT(StreamChunkDto, DTO)
+
+    DTO_FIELD(UInt64, session_id);
+
+    DTO_FIELD_INFO(frame_offset) {
+        info->description = "Session-wide index of the first frame in this chunk";
+    }
+    DTO_FIELD(Int64, frame_offset);
+
+    DTO_FIELD_INFO(frame_count) {
+        info->description = "Newly completed frames in this chunk (may be 0)";
+    }
+    DTO_FIELD(Int32, frame_count);
+
+    DTO_FIELD_INFO(features) {
+        info->description = "frame_count x 80 log-mel values, frame-major";
+    }
+    DTO_FIELD(FloatVector, features);
+
+    DTO_FIELD_INFO(sample_count) {
+        info->description = "Number of audio samples in this chunk";
+    }
+    DTO_FIELD(Int64, sample_count);
+};
+
+#include OATPP_CODEGEN_END(DTO)
+
+}}
+
+#endif
@@ -74,6 +74,40 @@ public:
              if(e.what()) msg += e.what();
              errorDto->error = msg.c_str();
              return createJsonResponse(Status::CODE_400, errorDto);
+        } catch (const NotFoundException& e) {
+             auto errorDto = ErrorResponseDto::createShared();
+             errorDto->status_code = 404;
+             errorDto->error = e.what();
+             return createJsonResponse(Status::CODE_404, errorDto);
+        } catch (const ConflictException& e) {
+             auto errorDto = ErrorResponseDto::createShared();
+             errorDto->status_code = 409;
+             errorDto->error = e.what();
+             return createJsonResponse(Status::CODE_409, errorDto);
+        } catch (const PayloadTooLargeException& e) {
+             auto errorDto = ErrorResponseDto::createShared();
+             errorDto->status_code = 413;
+             errorDto->error = e.what();
+             return createJsonResponse(Status::CODE_413, errorDto);
+        } catch (const TooManyRequestsException& e) {
+             auto errorDto = ErrorResponseDto::createShared();
+             errorDto->status_code = 429;
+             errorDto->error = e.what();
+             auto response = createJsonResponse(Status::CODE_429, errorDto);
+             response->putHeader("Retry-After", std::to_string(e.retryAfterSeconds()).c_str());
+             // The body may not have been read; don't try to reuse the connection
+             response->putHeader(oatpp::web::protocol::http::Header::CONNECTION, oatpp::web::protocol::http::Header::Value::CONNECTION_CLOSE);
+             return response;
+        } catch (const ServiceUnavailableException& e) {
+             auto errorDto = ErrorResponseDto::createShared();
+             errorDto->status_code = 503;
+             errorDto->error = e.what();
+             return createJsonResponse(Status::CODE_503, errorDto);
+        } catch (const GatewayTimeoutException& e) {
+             auto errorDto = ErrorResponseDto::createShared();
+             errorDto->status_code = 504;
+             errorDto->error = e.what();
+             return createJsonResponse(Status::CODE_504, errorDto);
         } catch (const std::exception& e) {
              auto errorDto = ErrorResponseDto::createShared();
              errorDto->status_code = 500;
@@ -3,6 +3,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <cstdint>
 
 namespace app { namespace exception {
 
@@ -16,6 +17,41 @@ public:
     ValidationException(const std::string& message) : std::runtime_error(message) {}
 };
 
+class NotFoundException : public std::runtime_error {
+public:
+    NotFoundException(const std::string& message) : std::runtime_error(message) {}
+};
+
+class ConflictException : public std::runtime_error {
+public:
+    ConflictException(const std::string& message) : std::runtime_error(message) {}
+};
+
+class PayloadTooLargeException : public std::runtime_error {
+public:
+    PayloadTooLargeException(const std::string& message) : std::runtime_error(message) {}
+};
+
+class GatewayTimeoutException : public std::runtime_error {
+public:
+    GatewayTimeoutException(const std::string& message) : std::runtime_error(message) {}
+};
+
+class TooManyRequestsException : public std::runtime_error {
+private:
+    uint32_t m_retryAfterSeconds;
+public:
+    TooManyRequestsException(const std::string& message, uint32_t retryAfterSeconds)
+        : std::runtime_error(message), m_retryAfterSeconds(retryAfterSeconds) {}
+
+    uint32_t retryAfterSeconds() const { return m_retryAfterSeconds; }
+};
+
+class ServiceUnavailableException : public std::runtime_error {
+public:
+    ServiceUnavailableException(const std::string& message) : std::runtime_error(message) {}
+};
+
 }}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "AdmissionControl.hpp"
+#include "exception/AppExceptions.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace app { namespace service {
+
+using namespace app::exception;
+
+namespace {
+
+constexpr uint32_t MAX_RETRY_AFTER_S = 60;
+// Buckets kept at once; full (idle) ones are dropped first since a new one starts full anyway
+constexpr size_t MAX_TRACKED_CLIENTS = 4096;
+
+double elapsedSeconds(uint64_t fromNs, uint64_t toNs) {
+    return toNs > fromNs ? (toNs - fromNs) / 1e9 : 0.0;
+}
+
+uint32_t retrySeconds(double seconds) {
+    return (uint32_t)std::min(std::max(std::ceil(seconds), 1.0), (double)MAX_RETRY_AFTER_S);
+}
+
+}
+
+AdmissionControl::AdmissionControl(const std::shared_ptr<WorkerManager>& workerManager, const Config& config)
+    : m_workerManager(workerManager)
+    , m_config(config)
+{}
+
+uint64_t AdmissionControl::estimatedWaitNs(size_t tasksInFlight, uint64_t averageTaskNs, size_t workers) const {
+    return (uint64_t)tasksInFlight * averageTaskNs / std::max(workers, (size_t)1);
+}
+
+void AdmissionControl::admit(Route route, const std::string& client) {
+    Decision decision = check(route, client, m_workerManager->tasksInFlight(),
+                              m_workerManager->averageTaskNs(), m_workerManager->workerCount(), monotonicNowNs());
+    if (!decision.admitted) {
+        throw TooManyRequestsException(decision.reason, decision.retryAfterSeconds);
+    }
+}
+
+AdmissionControl::Decision AdmissionControl::check(Route route, const std::string& client,
+                                                   size_t tasksInFlight, uint64_t averageTaskNs,
+                                                   size_t workers, uint64_t nowNs) {
+    Decision decision;
+
+    // Load first: a request shed for load doesn't cost the client a token
+    uint64_t budgetNs = m_config.budgetMs[route] * 1000 * 1000;
+    uint64_t waitNs = estimatedWaitNs(tasksInFlight, averageTaskNs, workers);
+    if (budgetNs != 0 && waitNs > budgetNs) {
+        decision.admitted = false;
+        decision.retryAfterSeconds = retrySeconds((waitNs - budgetNs) / 1e9);
+        decision.reason = "Server overloaded, estimated queue wait exceeds budget";
+        return decision;
+    }
+
+    if (m_config.clientRate > 0 && !takeToken(client, nowNs, decision.retryAfterSeconds)) {
+        decision.admitted = false;
+        decision.reason = "Client request rate exceeded";
+    }
+    return decision;
+}
+
+bool AdmissionControl::takeToken(const std::string& client, uint64_t nowNs, uint32_t& retryAfterSeconds) {
+    const double burst = std::max(m_config.clientBurst, 1.0);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_buckets.find(client);
+    if (it == m_buckets.end()) {
+        if (m_buckets.size() >= MAX_TRACKED_CLIENTS) {
+            for (auto b = m_buckets.begin(); b != m_buckets.end();) {
+                double refilled = b->second.tokens + elapsedSeconds(b->second.lastNs, nowNs) * m_config.clientRate;
+                b = refilled >= burst ? m_buckets.erase(b) : std::next(b);
+            }
+            // Every client is active: start over rather than grow without bound
+            if (m_buckets.size() >= MAX_TRACKED_CLIENTS) {
+                m_buckets.clear();
+            }
+        }
+        it = m_buckets.emplace(client, Bucket{burst, nowNs}).first;
+    }
+
+    Bucket& bucket = it->second;
+    bucket.tokens = std::min(burst, bucket.tokens + elapsedSeconds(bucket.lastNs, nowNs) * m_config.clientRate);
+    bucket.lastNs = nowNs;
+    if (bucket.tokens < 1.0) {
+        retryAfterSeconds = retrySeconds((1.0 - bucket.tokens) / m_config.clientRate);
+        return false;
+    }
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+size_t AdmissionControl::trackedClients() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buckets.size();
+}
+
+}}
@@ -0,0 +1,79 @@
+#ifndef Service_AdmissionControl_hpp
+#define Service_AdmissionControl_hpp
+
+#include "worker/WorkerManager.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace app { namespace service {
+
+using namespace app::worker;
+
+/**
+ * Decides whether a request is queued at all, before it reaches the workers.
+ *
+ * Queue wait is estimated as tasks in flight x average worker time per task / workers,
+ * with the worker count the pool has right now (it autoscales).
+ * Each route has a budget for that wait; over it the request is turned away with 429
+ * and a Retry-After of roughly how long the pool needs to drain back under budget.
+ * Shedding early keeps the latency of what is admitted bounded instead of letting
+ * every request queue behind all the others.
+ *
+ * Optionally each client (X-Client-Id, else the peer address) also gets a token
+ * bucket of clientRate requests/s with clientBurst of slack, so one tenant can't
+ * take the whole pool.
+ */
+class AdmissionControl {
+public:
+    enum Route {
+        ROUTE_PROCESS = 0,   // POST /process
+        ROUTE_AUDIO,         // POST /audio/stream
+        ROUTE_STREAM,        // session appends, /audio/live
+        ROUTE_COUNT
+    };
+
+    struct Config {
+        uint64_t budgetMs[ROUTE_COUNT] = {1000, 5000, 1000};   // 0 = no limit
+        double clientRate = 0;                                 // requests/s per client, 0 = off
+        double clientBurst = 10;
+    };
+
+    struct Decision {
+        bool admitted = true;
+        uint32_t retryAfterSeconds = 0;
+        const char* reason = nullptr;
+    };
+
+private:
+    struct Bucket {
+        double tokens;
+        uint64_t lastNs;
+    };
+
+    std::shared_ptr<WorkerManager> m_workerManager;
+    Config m_config;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Bucket> m_buckets;
+
+    bool takeToken(const std::string& client, uint64_t nowNs, uint32_t& retryAfterSeconds);
+
+public:
+    AdmissionControl(const std::shared_ptr<WorkerManager>& workerManager, const Config& config);
+
+    // Throws TooManyRequestsException when the request should not be queued.
+    void admit(Route route, const std::string& client);
+
+    // The decision itself, on an explicit load snapshot (admit() takes it from the WorkerManager).
+    Decision check(Route route, const std::string& client, size_t tasksInFlight, uint64_t averageTaskNs,
+                   size_t workers, uint64_t nowNs);
+
+    uint64_t estimatedWaitNs(size_t tasksInFlight, uint64_t averageTaskNs, size_t workers) const;
+    size_t trackedClients();
+};
+
+}}
+
+#endif
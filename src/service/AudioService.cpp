@@ -1,5 +1,8 @@
 #include "AudioService.hpp"
+#include "FeatureStream.hpp"
+#include "PcmConvert.hpp"
 #include "exception/AppExceptions.hpp"
+#include "worker/Tracer.hpp"
 #include <vector>
 #include <cstring>
 #include <iostream>
@@ -10,79 +13,433 @@ namespace app { namespace service {
 using namespace app::worker;
 using namespace app::exception;
 
-AudioService::AudioService(const std::shared_ptr<WorkerManager>& workerManager)
+namespace {
+
+// Samples [first, first + count) of a PCM16 body
+void convertPcm16(const oatpp::String& rawData, size_t first, size_t count, float* out) {
+    service::convertPcm16(reinterpret_cast<const int16_t*>(rawData->data()) + first, count, out);
+}
+
+PayloadLease reserveOrThrow(WorkerManager& manager, size_t bytes) {
+    try {
+        return manager.reserve(bytes);
+    } catch (const std::runtime_error& e) {
+        throw ServiceUnavailableException(e.what());
+    }
+}
+
+// Ring or completion table full: the client should come back later
+TaskHandle commitOrThrow(WorkerManager& manager, const ReqSlot& req, PayloadLease payload) {
+    try {
+        return manager.commit(req, std::move(payload));
+    } catch (const std::runtime_error& e) {
+        throw TooManyRequestsException(e.what(), 1);
+    }
+}
+
+// Worker statuses the client can act on keep their meaning; anything else is our fault (500)
+void checkWorkerStatus(const RespSlot& resp, const char* what) {
+    switch (resp.status_code) {
+        case 0:
+            return;
+        case 413:
+            throw PayloadTooLargeException(std::string("The ") + what + " task is larger than a worker accepts");
+        case 499: // Cancelled, or failed when the workers were stopped
+        case 503: // No room in the payload arena for the answer
+            throw ServiceUnavailableException(std::string("The ") + what + " task could not be completed, retry later");
+        case 504:
+            throw GatewayTimeoutException(std::string("No answer for the ") + what + " task before its deadline");
+        default:
+            OATPP_LOGE("AudioService", "Error processing %s: worker returned %u", what, resp.status_code);
+            throw std::runtime_error("Worker returned error code " + std::to_string(resp.status_code));
+    }
+}
+
+MelFeatures featuresFrom(TaskResult& result) {
+    MelFeatures features;
+    features.lease = std::move(result.payload);
+    features.count = features.lease.valid() ? result.resp.len : 0;
+    return features;
+}
+
+// What a task answered from the cache waits on: complete from the start, never reset
+TaskCompletion* alreadyDone() {
+    static TaskCompletion* done = [] {
+        auto* completion = new TaskCompletion();
+        completion->complete(TaskResult());
+        return completion;
+    }();
+    return done;
+}
+
+}
+
+FeatureTask FeatureTask::submit(WorkerManager& manager, const ReqSlot& req, PayloadLease input) {
+    FeatureTask task;
+    task.m_manager = &manager;
+    task.m_req = req;
+    if (!manager.featureCache().enabled() || numFrames(req.len) == 0) {
+        task.m_task = commitOrThrow(manager, req, std::move(input));
+        return task;
+    }
+
+    task.m_req.cache_key = FeatureCache::keyOf(input.as<float>(), req.len);
+    if (task.fromCache(false)) {
+        return task;
+    }
+    task.m_flight = manager.featureFlights().join(task.m_req.cache_key, task.m_lead);
+    if (task.m_flight) {
+        task.m_input = std::move(input);
+        return task;
+    }
+    // Leading now; the last flight may have landed between the lookup and the join
+    if (task.fromCache(false)) {
+        task.m_lead.reset();
+        return task;
+    }
+    task.commit(std::move(input));
+    return task;
+}
+
+bool FeatureTask::fromCache(bool collapsed) {
+    FeatureCache& cache = m_manager->featureCache();
+    if (!cache.lookup(m_req.cache_key, m_cached.lease, m_cached.count)) {
+        return false;
+    }
+    if (collapsed) {
+        cache.countCollapsed();
+    } else {
+        cache.countHit();
+    }
+    m_hit = true;
+    return true;
+}
+
+void FeatureTask::commit(PayloadLease input) {
+    m_manager->featureCache().countMiss();
+    m_task = commitOrThrow(*m_manager, m_req, std::move(input));
+    m_lead.bind(m_task.taskId());
+}
+
+bool FeatureTask::isReady() {
+    if (m_flight) {
+        if (!m_flight->isReady()) {
+            return false;
+        }
+        m_flight.reset();
+        // Nothing cached if the lead failed, gave up, or the cache had no room: compute it ourselves
+        if (fromCache(true)) {
+            m_input.reset();
+        } else {
+            commit(std::move(m_input));
+        }
+    }
+    return m_hit || m_task->isReady();
+}
+
+TaskCompletion* FeatureTask::completion() {
+    if (m_flight) return m_flight.get();
+    if (m_task) return &*m_task;
+    return alreadyDone();
+}
+
+MelFeatures FeatureTask::take(const char* what) {
+    if (m_hit) {
+        return std::move(m_cached);
+    }
+    TaskResult result = m_task->take();
+    m_lead.reset();
+    checkWorkerStatus(result.resp, what);
+    return featuresFrom(result);
+}
+
+AudioService::AudioService(const std::shared_ptr<WorkerManager>& workerManager, size_t fanOut)
     : m_workerManager(workerManager)
+    , m_fanOut(std::max(fanOut, (size_t)1))
 {}
 
 oatpp::String AudioService::processAudio(const oatpp::String& message) {
-    if(!message) return nullptr;
+    auto completion = submitText(message);
+    if (!completion) return nullptr;
+    completion->wait();
+    return finishText(*completion);
+}
+
+TaskHandle AudioService::submitText(const oatpp::String& message, TaskPriority priority) {
+    if(!message) return TaskHandle();
 
     ReqSlot req;
     req.type = TASK_TEXT_PROCESS;
-    // Copy message
+    req.priority = priority;
     size_t len = message->size();
     if (len >= TEXT_CHUNK_SIZE) {
         len = TEXT_CHUNK_SIZE - 1;
     }
-    std::memcpy(req.text_data, message->c_str(), len);
-    req.text_data[len] = '\0';
     req.len = (uint32_t)len;
 
-    auto future = m_workerManager->submitTask(req);
-    
-    // Block until result
-    try {
-        RespSlot resp = future.get();
-        if (resp.status_code != 0) {
-             throw std::runtime_error("Worker returned error code " + std::to_string(resp.status_code));
+    // Write the message straight into the shared block
+    auto payload = reserveOrThrow(*m_workerManager, len + 1);
+    char* text = payload.as<char>();
+    std::memcpy(text, message->c_str(), len);
+    text[len] = '\0';
+
+    return commitOrThrow(*m_workerManager, req, std::move(payload));
+}
+
+oatpp::String AudioService::finishText(TaskCompletion& completion) {
+    TaskResult result = completion.take();
+    checkWorkerStatus(result.resp, "text");
+    if (!result.payload.valid()) {
+        return oatpp::String("");
+    }
+    return oatpp::String(result.payload.as<char>(), result.resp.len);
+}
+
+MelFeatures AudioService::extractFeatures(const oatpp::String& rawData) {
+    if (!rawData) return MelFeatures();
+
+    size_t sampleCount = rawData->size() / 2;
+    size_t maxSamples = m_workerManager->maxPayloadBytes() / sizeof(float);
+    if (sampleCount > maxSamples) {
+        throw PayloadTooLargeException("Audio exceeds " + std::to_string(maxSamples) + " samples");
+    }
+    MelFeatures features;
+    features.count = numFrames(sampleCount) * N_MELS;
+    if (features.count == 0) {
+        return features;
+    }
+    features.lease = reserveOrThrow(*m_workerManager, features.count * sizeof(float));
+    float* out = features.lease.as<float>();
+
+    // Chunks are consecutive frame ranges: each is copied into place as soon as it is taken
+    auto upload = openUpload();
+    const char* data = rawData->data();
+    size_t pos = 0;
+    size_t offset = 0;
+    for (;;) {
+        pos += upload->write(data + pos, rawData->size() - pos);
+        if (pos == rawData->size()) {
+            upload->finish();
+        }
+        MelFeatures part;
+        while (upload->takeReady(part)) {
+            if (offset + part.count > features.count) {
+                throw std::runtime_error("Audio chunk returned an unexpected frame count");
+            }
+            std::copy(part.data(), part.data() + part.count, out + offset);
+            offset += part.count;
+        }
+        if (upload->done()) {
+            break;
+        }
+        if (!upload->writable() || upload->finished()) {
+            upload->oldest()->wait();
         }
-        return oatpp::String(resp.text_result, resp.len);
-    } catch (const std::exception& e) {
-        OATPP_LOGE("AudioService", "Error processing text: %s", e.what());
-        throw;
     }
+    if (offset != features.count) {
+        throw std::runtime_error("Audio chunks returned an unexpected frame count");
+    }
+    return features;
 }
 
-oatpp::List<oatpp::Float32> AudioService::extractFeatures(const oatpp::String& rawData) {
-    auto result = oatpp::List<oatpp::Float32>::createShared();
-    
-    if (!rawData || rawData->size() % 2 != 0) {
-        return result; 
+uint64_t AudioService::openStream() {
+    uint64_t sessionId = 0;
+    if (m_workerManager->streamSessions().open(sessionId) != StreamSessionTable::Status::OK) {
+        throw ServiceUnavailableException("No free stream sessions");
     }
+    return sessionId;
+}
+
+StreamChunk AudioService::appendStream(uint64_t sessionId, const oatpp::String& rawData) {
+    auto pending = submitStreamAppend(sessionId, rawData);
+    pending.completion->wait();
+    return finishStreamAppend(pending);
+}
 
+PendingStreamAppend AudioService::submitStreamAppend(uint64_t sessionId, const oatpp::String& rawData) {
+    if (!rawData || rawData->size() % 2 != 0) {
+        throw ValidationException("Chunk must be 16-bit PCM");
+    }
     size_t sampleCount = rawData->size() / 2;
     if (sampleCount > AUDIO_CHUNK_SIZE) {
-         // Truncate for MVP
-         sampleCount = AUDIO_CHUNK_SIZE;
+        throw ValidationException("Chunk exceeds " + std::to_string(AUDIO_CHUNK_SIZE) + " samples");
+    }
+
+    auto& sessions = m_workerManager->streamSessions();
+    uint32_t slot = 0;
+    switch (sessions.acquire(sessionId, slot)) {
+        case StreamSessionTable::Status::OK: break;
+        case StreamSessionTable::Status::BUSY: throw ConflictException("An append is already in flight for this session");
+        default: throw NotFoundException("Unknown stream session");
+    }
+
+    SessionHold hold(&sessions, slot);
+    PendingStreamAppend pending;
+    pending.frameOffset = sessions.framesEmitted(slot);
+
+    ReqSlot req;
+    req.type = TASK_AUDIO_STREAM;
+    req.priority = PRIORITY_INTERACTIVE;
+    req.audio.sample_rate = 16000;
+    req.len = (uint32_t)sampleCount;
+    req.audio.session_slot = slot;
+    req.audio.session_id = sessionId;
+    // Samples go after the headroom the worker fills with the session carry
+    uint64_t convertNs = monotonicNowNs();
+    auto payload = reserveOrThrow(*m_workerManager, (STREAM_PAYLOAD_HEADROOM + sampleCount) * sizeof(float));
+    convertPcm16(rawData, 0, sampleCount, payload.as<float>() + STREAM_PAYLOAD_HEADROOM);
+    uint64_t convertEndNs = monotonicNowNs();
+
+    pending.completion = commitOrThrow(*m_workerManager, req, std::move(payload));
+    hold.detach();
+    Tracer::record(TRACE_CONVERT, pending.completion.taskId(), convertNs, convertEndNs);
+    return pending;
+}
+
+StreamChunk AudioService::finishStreamAppend(PendingStreamAppend& pending) {
+    TaskResult result = pending.completion->take();
+
+    const RespSlot& resp = result.resp;
+    if (resp.status_code == 404) {
+        throw NotFoundException("Unknown stream session");
+    }
+    checkWorkerStatus(resp, "stream append");
+
+    StreamChunk chunk;
+    chunk.frameOffset = pending.frameOffset;
+    chunk.features = featuresFrom(result);
+    return chunk;
+}
+
+uint64_t AudioService::closeStream(uint64_t sessionId) {
+    uint64_t framesEmitted = 0;
+    switch (m_workerManager->streamSessions().close(sessionId, framesEmitted)) {
+        case StreamSessionTable::Status::OK: return framesEmitted;
+        case StreamSessionTable::Status::BUSY: throw ConflictException("An append is still in flight for this session");
+        default: throw NotFoundException("Unknown stream session");
+    }
+}
+
+void AudioService::closeStreamWhenIdle(uint64_t sessionId) {
+    m_workerManager->streamSessions().closeWhenIdle(sessionId);
+}
+
+// Chunks are a full micro-batch each, so a window of fanOut keeps that many workers busy on one upload
+std::shared_ptr<FeatureUpload> AudioService::openUpload(TaskPriority priority) {
+    return std::make_shared<FeatureUpload>(m_workerManager, UPLOAD_CHUNK_SAMPLES, m_fanOut, priority);
+}
+
+std::shared_ptr<FeatureStream> AudioService::openFeatureStream(TaskPriority priority) {
+    return std::make_shared<FeatureStream>(m_workerManager, UPLOAD_CHUNK_SAMPLES, m_fanOut, priority);
+}
+
+FeatureUpload::FeatureUpload(const std::shared_ptr<WorkerManager>& workerManager, size_t chunkSamples, size_t maxInFlight,
+                             TaskPriority priority)
+    : m_workerManager(workerManager)
+    , m_chunkSamples(std::max(chunkSamples, (size_t)N_FFT))
+    , m_maxInFlight(std::max(maxInFlight, (size_t)1))
+    , m_priority(priority)
+{}
+
+void FeatureUpload::startChunk(const float* overlap, size_t overlapSamples) {
+    PayloadLease next = reserveOrThrow(*m_workerManager, m_chunkSamples * sizeof(float));
+    std::copy(overlap, overlap + overlapSamples, next.as<float>());
+    m_chunk = std::move(next);
+    m_filled = overlapSamples;
+    m_chunkStartNs = monotonicNowNs();
+}
+
+void FeatureUpload::submitChunk(bool last) {
+    size_t frames = numFrames(m_filled);
+    if (frames == 0) {
+        // Tail shorter than one frame: nothing left to compute
+        m_chunk.reset();
+        m_filled = 0;
+        return;
     }
 
     ReqSlot req;
     req.type = TASK_AUDIO_PROCESS;
+    req.priority = m_priority;
     req.audio.sample_rate = 16000;
-    req.audio.num_samples = (uint32_t)sampleCount;
-    
-    const int16_t* pcm = reinterpret_cast<const int16_t*>(rawData->data());
-    for(size_t i=0; i<sampleCount; ++i) {
-        req.audio.audio_data[i] = pcm[i] / 32768.0f;
+    req.len = (uint32_t)m_filled;
+
+    // The next chunk starts at the first frame this one doesn't complete
+    PayloadLease full = std::move(m_chunk);
+    size_t consumed = frames * HOP_LENGTH;
+    if (!last) {
+        startChunk(full.as<float>() + consumed, m_filled - consumed);
+    } else {
+        m_filled = 0;
     }
 
-    auto future = m_workerManager->submitTask(req);
-    
-    try {
-        RespSlot resp = future.get();
-        if (resp.status_code != 0) {
-            throw std::runtime_error("Worker returned error code " + std::to_string(resp.status_code));
+    // Reading and converting the body happen together here: one span from the chunk's start
+    uint64_t chunkStartNs = m_chunkStartNs;
+    m_inFlight.push_back(FeatureTask::submit(*m_workerManager, req, std::move(full)));
+    if (uint64_t taskId = m_inFlight.back().taskId()) {
+        Tracer::record(TRACE_BODY_READ, taskId, chunkStartNs, monotonicNowNs());
+    }
+}
+
+void FeatureUpload::push(int16_t sample) {
+    m_chunk.as<float>()[m_filled++] = sample / 32768.0f;
+    ++m_sampleCount;
+}
+
+size_t FeatureUpload::write(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t pos = 0;
+
+    while (pos < size) {
+        if (!m_chunk.valid()) {
+            startChunk(nullptr, 0);
+        }
+        if (m_filled == m_chunkSamples) {
+            if (m_inFlight.size() >= m_maxInFlight) {
+                break; // Back-pressure: stop reading until the oldest chunk is taken
+            }
+            submitChunk(false);
         }
 
-        for(size_t i=0; i<resp.len; ++i) {
-            result->push_back(resp.mel_features[i]);
+        // PCM 16-bit little-endian; a sample may straddle two writes
+        if (m_hasOddByte) {
+            push((int16_t)(m_oddByte | (bytes[pos++] << 8)));
+            m_hasOddByte = false;
+            continue;
+        }
+        size_t samples = std::min((size - pos) / 2, m_chunkSamples - m_filled);
+        for (size_t i = 0; i < samples; ++i, pos += 2) {
+            push((int16_t)(bytes[pos] | (bytes[pos + 1] << 8)));
         }
-    } catch (const std::exception& e) {
-         OATPP_LOGE("AudioService", "Error processing audio: %s", e.what());
-         throw;
+        if (samples == 0 && pos < size && m_filled < m_chunkSamples) {
+            m_oddByte = bytes[pos++];
+            m_hasOddByte = true;
+        }
+    }
+    return pos;
+}
+
+void FeatureUpload::finish() {
+    if (m_finished) return;
+    m_finished = true;
+    if (m_chunk.valid()) {
+        submitChunk(true);
     }
-    
-    return result;
+}
+
+TaskCompletion* FeatureUpload::oldest() {
+    return m_inFlight.empty() ? nullptr : m_inFlight.front().completion();
+}
+
+bool FeatureUpload::takeReady(MelFeatures& features) {
+    if (m_inFlight.empty() || !m_inFlight.front().isReady()) {
+        return false;
+    }
+    FeatureTask task = std::move(m_inFlight.front());
+    m_inFlight.pop_front();
+
+    features = task.take("upload chunk");
+    return true;
 }
 
 }}
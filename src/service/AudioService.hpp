@@ -4,23 +4,189 @@
 #include "worker/WorkerManager.hpp"
 #include "oatpp/core/Types.hpp"
 #include <memory>
+#include <deque>
 
 namespace app { namespace service {
 
 using namespace app::worker;
 
+/**
+ * Mel features still sitting in the worker's SHM response block (frame-major,
+ * N_MELS per frame). Holding this keeps the block alive, so drop it once the
+ * response has been serialized.
+ */
+struct MelFeatures {
+    PayloadLease lease;
+    size_t count = 0;
+
+    const float* data() const { return lease.as<float>(); }
+    size_t frames() const { return count / N_MELS; }
+};
+
+/**
+ * Result of one append to a streaming session.
+ */
+struct StreamChunk {
+    uint64_t frameOffset;
+    MelFeatures features;
+};
+
+/**
+ * An append that has been queued but not answered yet. The session stays BUSY
+ * until the worker's answer arrives, even if this is dropped before then.
+ */
+struct PendingStreamAppend {
+    TaskHandle completion;
+    uint64_t frameOffset = 0;
+};
+
+/**
+ * One TASK_AUDIO_PROCESS through the feature cache (see FeatureCache). It is
+ * answered from the cache, by waiting for an identical task already in flight
+ * and then reading the cache, or by a worker, which caches what it computed.
+ * Without a cache (or a frame to compute) it is a plain task.
+ */
+class FeatureTask {
+private:
+    WorkerManager* m_manager = nullptr;
+    ReqSlot m_req;
+    PayloadLease m_input;     // a follower's samples, for when the flight it joined comes back empty
+    TaskHandle m_task;
+    FlightLead m_lead;
+    std::shared_ptr<TaskCompletion> m_flight;
+    MelFeatures m_cached;
+    bool m_hit = false;
+
+    bool fromCache(bool collapsed);
+    void commit(PayloadLease input);
+
+public:
+    // Throws like any other submission (ring or completion table full)
+    static FeatureTask submit(WorkerManager& manager, const ReqSlot& req, PayloadLease input);
+
+    // May queue the task after all (its flight landed without features), so it can throw too.
+    bool isReady();
+
+    // What to suspend on until isReady(); never nullptr.
+    TaskCompletion* completion();
+
+    // Only after isReady(); throws if the worker failed the task.
+    MelFeatures take(const char* what);
+
+    // 0 when no task of our own was queued
+    uint64_t taskId() const { return m_task.taskId(); }
+    bool cached() const { return m_hit; }
+};
+
+// Uploads: samples per task (overlap included), a full micro-batch each so chunks of one
+// body spread over the workers; and the fewest chunks computing at once per upload
+constexpr size_t UPLOAD_CHUNK_SAMPLES = AUDIO_CHUNK_SIZE;
+constexpr size_t UPLOAD_MAX_IN_FLIGHT = 4;
+
+/**
+ * Feature extraction for a PCM16 body that arrives in pieces.
+ *
+ * Bytes are converted straight into an arena chunk; each full chunk is queued
+ * right away and the next one starts with the samples of the first frame the
+ * previous one could not complete, so chunks are hop-aligned and need no state
+ * on the worker. At most maxInFlight chunks are queued or waiting to be taken,
+ * which bounds memory per upload whatever the body size. Results come back in order.
+ */
+class FeatureUpload {
+private:
+    std::shared_ptr<WorkerManager> m_workerManager;
+    size_t m_chunkSamples;
+    size_t m_maxInFlight;
+    TaskPriority m_priority;
+
+    PayloadLease m_chunk;
+    size_t m_filled = 0;
+    uint8_t m_oddByte = 0;
+    bool m_hasOddByte = false;
+    bool m_finished = false;
+    uint64_t m_sampleCount = 0;
+    uint64_t m_chunkStartNs = 0;   // for the chunk's BODY_READ span
+    std::deque<FeatureTask> m_inFlight;
+
+    void startChunk(const float* overlap, size_t overlapSamples);
+    void submitChunk(bool last);
+    void push(int16_t sample);
+
+public:
+    FeatureUpload(const std::shared_ptr<WorkerManager>& workerManager,
+                  size_t chunkSamples = UPLOAD_CHUNK_SAMPLES,
+                  size_t maxInFlight = UPLOAD_MAX_IN_FLIGHT,
+                  TaskPriority priority = PRIORITY_NORMAL);
+
+    /**
+     * Takes PCM16 bytes, returns how many were consumed. Fewer than size (possibly 0)
+     * means the window is full: wait on oldest(), take its result, then retry.
+     */
+    size_t write(const void* data, size_t size);
+
+    // End of body: queues the tail (a trailing odd byte is dropped).
+    void finish();
+
+    // Oldest chunk in the window, or nullptr.
+    TaskCompletion* oldest();
+
+    // Pops the oldest chunk's features if it is done; throws if the worker failed it.
+    bool takeReady(MelFeatures& features);
+
+    bool done() const { return m_finished && m_inFlight.empty(); }
+    bool finished() const { return m_finished; }
+    // write() would consume at least one byte
+    bool writable() const { return !(m_filled == m_chunkSamples && m_inFlight.size() >= m_maxInFlight); }
+    size_t inFlight() const { return m_inFlight.size(); }
+    uint64_t sampleCount() const { return m_sampleCount; }
+};
+
+class FeatureStream;
+
+/**
+ * Each operation comes in two halves so ENDPOINT_ASYNC handlers never block:
+ * submitX() validates and queues the task, the coroutine suspends on the returned
+ * completion, and finishX() turns the worker's answer into a result (or throws).
+ * The plain methods do both halves and block, for tests and sync callers.
+ *
+ * Text and stream appends are interactive; whole-body audio defaults to the normal
+ * class and may be sent as batch (or interactive) by the caller.
+ */
 class AudioService {
 private:
     std::shared_ptr<WorkerManager> m_workerManager;
+    size_t m_fanOut;
 public:
-    AudioService(const std::shared_ptr<WorkerManager>& workerManager);
+    // fanOut: chunks of one body computing at once, so how many workers it may be spread over
+    AudioService(const std::shared_ptr<WorkerManager>& workerManager, size_t fanOut = UPLOAD_MAX_IN_FLIGHT);
     
     oatpp::String processAudio(const oatpp::String& message);
+    TaskHandle submitText(const oatpp::String& message, TaskPriority priority = PRIORITY_INTERACTIVE);
+    oatpp::String finishText(TaskCompletion& completion);
 
     /**
-     * Sends raw PCM 16-bit mono 16kHz audio to Worker Process for Mel Spectrogram computation.
+     * Mel Spectrogram of a whole raw PCM 16-bit mono 16kHz body, through an upload
+     * (openUpload()) and stitched into one block. Blocks; for tests and sync callers.
      */
-    oatpp::List<oatpp::Float32> extractFeatures(const oatpp::String& rawData);
+    MelFeatures extractFeatures(const oatpp::String& rawData);
+
+    /**
+     * Streaming STFT: the worker keeps the unfinished tail between appends,
+     * so each append only returns the frames it completed.
+     */
+    uint64_t openStream();
+    StreamChunk appendStream(uint64_t sessionId, const oatpp::String& rawData);
+    PendingStreamAppend submitStreamAppend(uint64_t sessionId, const oatpp::String& rawData);
+    StreamChunk finishStreamAppend(PendingStreamAppend& pending);
+    // Returns the number of frames the session emitted.
+    uint64_t closeStream(uint64_t sessionId);
+    // Closes the session once the append in flight (if any) has been answered; never throws.
+    void closeStreamWhenIdle(uint64_t sessionId);
+
+    // Feature extraction for a body read as it arrives, fanOut chunks at a time.
+    std::shared_ptr<FeatureUpload> openUpload(TaskPriority priority = PRIORITY_NORMAL);
+    // Same, shared between a body-reading and a response-writing coroutine (FeatureStream.hpp).
+    std::shared_ptr<FeatureStream> openFeatureStream(TaskPriority priority = PRIORITY_NORMAL);
 };
 
 }}
@@ -0,0 +1,219 @@
+#include "FeatureFormat.hpp"
+#include "worker/AudioParams.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace app { namespace service {
+
+namespace {
+
+std::string trim(const std::string& s) {
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && std::isspace((unsigned char)s[begin])) ++begin;
+    while (end > begin && std::isspace((unsigned char)s[end - 1])) --end;
+    return s.substr(begin, end - begin);
+}
+
+std::string lower(std::string s) {
+    for (char& c : s) c = (char)std::tolower((unsigned char)c);
+    return s;
+}
+
+bool parseDtype(const std::string& value, FeatureDtype& dtype) {
+    if (value == "float32" || value == "f32") { dtype = FeatureDtype::FLOAT32; return true; }
+    if (value == "float16" || value == "f16") { dtype = FeatureDtype::FLOAT16; return true; }
+    if (value == "bfloat16" || value == "bf16") { dtype = FeatureDtype::BFLOAT16; return true; }
+    return false;
+}
+
+// One media range of an Accept header. Returns false if we can't produce it.
+bool parseRange(const std::string& range, FeatureFormat& format, double& q) {
+    size_t semi = range.find(';');
+    std::string type = lower(trim(range.substr(0, semi)));
+
+    if (type == "application/json" || type == "application/*" || type == "*/*") {
+        format.encoding = FeatureEncoding::JSON;
+    } else if (type == "application/x-ndjson") {
+        format.encoding = FeatureEncoding::NDJSON;
+    } else if (type == "application/octet-stream") {
+        format.encoding = FeatureEncoding::RAW;
+    } else if (type == "application/x-npy") {
+        format.encoding = FeatureEncoding::NPY;
+    } else {
+        return false;
+    }
+
+    format.dtype = FeatureDtype::FLOAT32;
+    q = 1.0;
+    while (semi != std::string::npos) {
+        size_t next = range.find(';', semi + 1);
+        std::string param = range.substr(semi + 1, next == std::string::npos ? std::string::npos : next - semi - 1);
+        semi = next;
+
+        size_t eq = param.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = lower(trim(param.substr(0, eq)));
+        std::string value = lower(trim(param.substr(eq + 1)));
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.size() - 2);
+        }
+
+        if (key == "q") {
+            q = std::atof(value.c_str());
+        } else if (key == "dtype" && format.binary()) {
+            if (!parseDtype(value, format.dtype)) return false;
+        }
+    }
+
+    return !(format.encoding == FeatureEncoding::NPY && format.dtype == FeatureDtype::BFLOAT16);
+}
+
+template<typename Convert>
+void appendConverted(const float* data, size_t count, std::string& out, Convert convert) {
+    size_t offset = out.size();
+    out.resize(offset + count * sizeof(uint16_t));
+    char* dst = &out[offset];
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t half = convert(data[i]);
+        std::memcpy(dst + i * sizeof(uint16_t), &half, sizeof(uint16_t));
+    }
+}
+
+// .npy v1.0: magic, version, u16 header length, then a Python dict literal padded to 64 bytes
+void appendNpyHeader(const FeatureFormat& format, size_t frames, std::string& out) {
+    const char* descr = format.dtype == FeatureDtype::FLOAT16 ? "<f2" : "<f4";
+    char dict[128];
+    int len = std::snprintf(dict, sizeof(dict), "{'descr': '%s', 'fortran_order': False, 'shape': (%zu, %zu), }",
+                            descr, frames, (size_t)app::worker::N_MELS);
+
+    const size_t preamble = 10;
+    size_t headerLen = (size_t)len + 1;
+    headerLen += (64 - (preamble + headerLen) % 64) % 64;
+
+    out.append("\x93NUMPY\x01\x00", 8);
+    out.push_back((char)(headerLen & 0xFF));
+    out.push_back((char)(headerLen >> 8));
+    out.append(dict, (size_t)len);
+    out.append(headerLen - (size_t)len - 1, ' ');
+    out.push_back('\n');
+}
+
+}
+
+const char* FeatureFormat::contentType() const {
+    switch (encoding) {
+        case FeatureEncoding::NDJSON: return "application/x-ndjson";
+        case FeatureEncoding::RAW: return "application/octet-stream";
+        case FeatureEncoding::NPY: return "application/x-npy";
+        default: return "application/json";
+    }
+}
+
+const char* FeatureFormat::dtypeName() const {
+    switch (dtype) {
+        case FeatureDtype::FLOAT16: return "float16";
+        case FeatureDtype::BFLOAT16: return "bfloat16";
+        default: return "float32";
+    }
+}
+
+size_t FeatureFormat::elementSize() const {
+    return dtype == FeatureDtype::FLOAT32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+FeatureFormat FeatureFormat::negotiate(const char* accept) {
+    FeatureFormat best;
+    if (!accept) {
+        return best;
+    }
+
+    double bestQ = 0.0;
+    std::string header(accept);
+    size_t pos = 0;
+    while (pos <= header.size()) {
+        size_t comma = header.find(',', pos);
+        if (comma == std::string::npos) comma = header.size();
+
+        FeatureFormat candidate;
+        double q = 0.0;
+        if (parseRange(header.substr(pos, comma - pos), candidate, q) && q > bestQ) {
+            best = candidate;
+            bestQ = q;
+        }
+        pos = comma + 1;
+    }
+    return best;
+}
+
+uint16_t toFloat16(float value) {
+    uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+    uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+    uint32_t abs = x & 0x7FFFFFFF;
+
+    if (abs >= 0x7F800000) {
+        return sign | (abs > 0x7F800000 ? 0x7E00 : 0x7C00);
+    }
+    // 65520 and up round to infinity
+    if (abs >= 0x477FF000) {
+        return sign | 0x7C00;
+    }
+    // Normal half: rebias the exponent, round away the low 13 mantissa bits (carry may bump the exponent)
+    if (abs >= 0x38800000) {
+        uint32_t v = abs - 0x38000000;
+        v += 0x0FFF + ((v >> 13) & 1);
+        return sign | (uint16_t)(v >> 13);
+    }
+    // Below half of the smallest subnormal (2^-25, tie included): zero
+    uint32_t exponent = abs >> 23;
+    if (exponent < 102) {
+        return sign;
+    }
+    // Subnormal half: units of 2^-24
+    uint32_t mantissa = (abs & 0x7FFFFF) | 0x800000;
+    uint32_t shift = 126 - exponent;
+    uint32_t half = mantissa >> shift;
+    uint32_t rest = mantissa & ((1u << shift) - 1);
+    uint32_t mid = 1u << (shift - 1);
+    if (rest > mid || (rest == mid && (half & 1))) {
+        ++half;
+    }
+    return sign | (uint16_t)half;
+}
+
+uint16_t toBfloat16(float value) {
+    uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+    if ((x & 0x7FFFFFFF) > 0x7F800000) {
+        return (uint16_t)((x >> 16) | 0x40);
+    }
+    x += 0x7FFF + ((x >> 16) & 1);
+    return (uint16_t)(x >> 16);
+}
+
+void encodeFeatures(const float* data, size_t count, const FeatureFormat& format, std::string& out) {
+    out.reserve(out.size() + count * format.elementSize() + 128);
+
+    if (format.encoding == FeatureEncoding::NPY) {
+        appendNpyHeader(format, count / app::worker::N_MELS, out);
+    }
+
+    // Host order is little-endian on every target we build for (x86-64, aarch64)
+    switch (format.dtype) {
+        case FeatureDtype::FLOAT16:
+            appendConverted(data, count, out, toFloat16);
+            break;
+        case FeatureDtype::BFLOAT16:
+            appendConverted(data, count, out, toBfloat16);
+            break;
+        default:
+            out.append(reinterpret_cast<const char*>(data), count * sizeof(float));
+            break;
+    }
+}
+
+}}
@@ -0,0 +1,64 @@
+#ifndef Service_FeatureFormat_hpp
+#define Service_FeatureFormat_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace app { namespace service {
+
+/**
+ * Wire formats for mel features.
+ *
+ *   application/json          BaseResponse-style DTO (default)
+ *   application/x-ndjson      one line per chunk while the upload is in progress (FeatureStream)
+ *   application/octet-stream  the bare tensor, little-endian
+ *   application/x-npy         the same tensor behind a .npy header
+ *
+ * Binary formats take a dtype parameter, e.g. `application/octet-stream; dtype=float16`:
+ * float32 (default), float16 or bfloat16. .npy has no bfloat16, so that combination
+ * is treated as not acceptable. Shape is always [frames, N_MELS], frame-major.
+ */
+enum class FeatureEncoding {
+    JSON,
+    NDJSON,
+    RAW,
+    NPY
+};
+
+enum class FeatureDtype {
+    FLOAT32,
+    FLOAT16,
+    BFLOAT16
+};
+
+struct FeatureFormat {
+    FeatureEncoding encoding = FeatureEncoding::JSON;
+    FeatureDtype dtype = FeatureDtype::FLOAT32;
+
+    bool binary() const { return encoding == FeatureEncoding::RAW || encoding == FeatureEncoding::NPY; }
+    const char* contentType() const;
+    const char* dtypeName() const;
+    size_t elementSize() const;
+
+    /**
+     * Picks the format for an Accept header (nullptr = no header). Highest q wins,
+     * ties go to the first listed; q=0 and unknown types/dtypes are skipped.
+     * Falls back to JSON when nothing usable is listed, as before.
+     */
+    static FeatureFormat negotiate(const char* accept);
+};
+
+// IEEE binary16 / bfloat16 from float, round to nearest even; NaN stays NaN.
+uint16_t toFloat16(float value);
+uint16_t toBfloat16(float value);
+
+/**
+ * Appends count floats (count % N_MELS == 0) to out in a binary format:
+ * the bare tensor for RAW, header + tensor for NPY.
+ */
+void encodeFeatures(const float* data, size_t count, const FeatureFormat& format, std::string& out);
+
+}}
+
+#endif
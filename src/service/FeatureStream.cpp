@@ -0,0 +1,124 @@
+#include "FeatureStream.hpp"
+
+namespace app { namespace service {
+
+FeatureStream::FeatureStream(const std::shared_ptr<WorkerManager>& workerManager, size_t chunkSamples, size_t maxInFlight,
+                             TaskPriority priority)
+    : m_upload(workerManager, chunkSamples, maxInFlight, priority)
+    , m_room([this] {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_failed || m_upload.writable();
+    })
+    , m_data([this] {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_failed || m_upload.finished() || m_upload.inFlight() > 0;
+    })
+{}
+
+void FeatureStream::failLocked(const std::string& error) {
+    if (!m_failed) {
+        m_failed = true;
+        m_error = error;
+    }
+}
+
+size_t FeatureStream::write(const void* data, size_t size, oatpp::async::Action& action) {
+    size_t written = 0;
+    bool queued = false;
+    bool failed = false;
+    std::string error;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_failed) {
+            throw std::runtime_error("Feature stream closed: " + m_error);
+        }
+        size_t inFlight = m_upload.inFlight();
+        try {
+            written = m_upload.write(data, size);
+        } catch (const std::exception& e) {
+            failLocked(e.what());
+        }
+        queued = m_upload.inFlight() != inFlight;
+        failed = m_failed;
+        error = m_error;
+        if (written == 0 && size > 0 && !failed) {
+            action = oatpp::async::Action::createWaitListAction(m_room.waitList());
+        }
+    }
+
+    // Notify outside the lock: the wait lists call back into the predicates
+    if (queued || failed) {
+        m_data.notify();
+    }
+    if (failed) {
+        throw std::runtime_error("Feature stream closed: " + error);
+    }
+    return written;
+}
+
+void FeatureStream::finish() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        try {
+            m_upload.finish();
+        } catch (const std::exception& e) {
+            failLocked(e.what());
+        }
+    }
+    m_data.notify();
+}
+
+void FeatureStream::fail(const std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        failLocked(error);
+    }
+    m_room.notify();
+    m_data.notify();
+}
+
+FeatureStream::Next FeatureStream::next(StreamChunk& chunk, oatpp::async::Action& action) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_failed) {
+            return Next::FAILED;
+        }
+
+        bool ready = false;
+        try {
+            ready = m_upload.takeReady(chunk.features);
+        } catch (const std::exception& e) {
+            failLocked(e.what());
+        }
+
+        if (!m_failed && !ready) {
+            if (m_upload.done()) {
+                return Next::END;
+            }
+            TaskCompletion* oldest = m_upload.oldest();
+            action = oatpp::async::Action::createWaitListAction(oldest ? oldest->waitList() : m_data.waitList());
+            return Next::WAIT;
+        }
+
+        if (ready) {
+            chunk.frameOffset = m_framesOut;
+            m_framesOut += chunk.features.frames();
+        }
+    }
+
+    // Either a slot in the window was freed, or the body side has to learn about the failure
+    m_room.notify();
+    return m_failed ? Next::FAILED : Next::FEATURES;
+}
+
+std::string FeatureStream::error() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+uint64_t FeatureStream::sampleCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_upload.sampleCount();
+}
+
+}}
@@ -0,0 +1,88 @@
+#ifndef Service_FeatureStream_hpp
+#define Service_FeatureStream_hpp
+
+#include "AudioService.hpp"
+#include "oatpp/core/async/CoroutineWaitList.hpp"
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace app { namespace service {
+
+/**
+ * Wait list for a condition guarded elsewhere. A coroutine that checked the
+ * condition just before it became true is woken as soon as it is queued.
+ */
+class StreamSignal : private oatpp::async::CoroutineWaitList::Listener {
+private:
+    oatpp::async::CoroutineWaitList m_waitList;
+    std::function<bool()> m_ready;
+
+    void onNewItem(oatpp::async::CoroutineWaitList& list) override {
+        if (m_ready()) {
+            list.notifyAll();
+        }
+    }
+
+public:
+    explicit StreamSignal(std::function<bool()> ready) : m_ready(std::move(ready)) {
+        m_waitList.setListener(this);
+    }
+
+    oatpp::async::CoroutineWaitList* waitList() { return &m_waitList; }
+    void notify() { m_waitList.notifyAll(); }
+};
+
+/**
+ * A FeatureUpload shared by two coroutines that may run on different executor
+ * threads: one feeds it the request body, the other streams finished chunks
+ * into the response while the upload is still going.
+ *
+ * Neither side blocks: when there is nothing to do, the call sets `action` to
+ * a wait and the coroutine suspends until the other side (or a worker) makes
+ * progress.
+ */
+class FeatureStream {
+public:
+    enum class Next { FEATURES, WAIT, END, FAILED };
+
+private:
+    std::mutex m_mutex;
+    FeatureUpload m_upload;
+    uint64_t m_framesOut = 0;
+    bool m_failed = false;
+    std::string m_error;
+
+    StreamSignal m_room;   // body side: the window has room again
+    StreamSignal m_data;   // response side: a chunk was queued, or the body ended
+
+    void failLocked(const std::string& error);
+
+public:
+    FeatureStream(const std::shared_ptr<WorkerManager>& workerManager,
+                  size_t chunkSamples = UPLOAD_CHUNK_SAMPLES,
+                  size_t maxInFlight = UPLOAD_MAX_IN_FLIGHT,
+                  TaskPriority priority = PRIORITY_NORMAL);
+
+    // --- Body side ---
+
+    // Takes PCM16 bytes. Returns 0 with `action` set to a wait when the window is full.
+    // Throws once the stream has failed (e.g. the response side went away).
+    size_t write(const void* data, size_t size, oatpp::async::Action& action);
+    void finish();
+
+    // Either side: abandons the stream and wakes the other one.
+    void fail(const std::string& error);
+
+    // --- Response side ---
+
+    // FEATURES fills `chunk` with the next chunk in order; WAIT sets `action`.
+    Next next(StreamChunk& chunk, oatpp::async::Action& action);
+
+    std::string error();
+    uint64_t sampleCount();
+};
+
+}}
+
+#endif
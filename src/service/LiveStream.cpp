@@ -0,0 +1,168 @@
+#include "LiveStream.hpp"
+#include <algorithm>
+
+namespace app { namespace service {
+
+LiveStream::LiveStream(const std::shared_ptr<AudioService>& service, size_t maxBufferSamples)
+    : m_service(service)
+    , m_maxBufferBytes(std::min(std::max(maxBufferSamples, (size_t)1), AUDIO_CHUNK_SIZE) * sizeof(int16_t))
+    , m_room([this] {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_failed || m_buffer.size() < m_maxBufferBytes;
+    })
+    , m_data([this] {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_failed || m_finished || m_appending;
+    })
+{
+    try {
+        m_sessionId = m_service->openStream();
+        m_sessionOpen = true;
+    } catch (const std::exception& e) {
+        failLocked(e.what());
+    }
+}
+
+LiveStream::~LiveStream() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // An append still in flight keeps the session BUSY: it closes once that answer is in
+    if (m_sessionOpen) {
+        m_sessionOpen = false;
+        m_service->closeStreamWhenIdle(m_sessionId);
+    }
+}
+
+void LiveStream::submitLocked() {
+    if (m_appending || m_failed) return;
+
+    // Whole samples only; an odd trailing byte waits for its other half
+    size_t bytes = m_buffer.size() & ~(size_t)1;
+    if (bytes == 0) return;
+
+    try {
+        m_pending = m_service->submitStreamAppend(m_sessionId, oatpp::String(m_buffer.data(), bytes));
+        m_appending = true;
+        m_buffer.erase(0, bytes);
+    } catch (const std::exception& e) {
+        failLocked(e.what());
+    }
+}
+
+void LiveStream::closeSessionLocked() {
+    if (!m_sessionOpen) return;
+    m_sessionOpen = false;
+    try {
+        m_service->closeStream(m_sessionId);
+    } catch (const std::exception&) {
+        // Already reclaimed
+    }
+}
+
+void LiveStream::failLocked(const std::string& error) {
+    if (!m_failed) {
+        m_failed = true;
+        m_error = error;
+    }
+}
+
+size_t LiveStream::write(const void* data, size_t size, oatpp::async::Action& action) {
+    size_t written = 0;
+    bool queued = false;
+    bool failed = false;
+    std::string error;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_failed) {
+            throw std::runtime_error("Live stream closed: " + m_error);
+        }
+
+        written = std::min(size, m_maxBufferBytes - m_buffer.size());
+        m_buffer.append(static_cast<const char*>(data), written);
+        m_bytesIn += written;
+
+        bool appending = m_appending;
+        submitLocked();
+        queued = m_appending != appending;
+        failed = m_failed;
+        error = m_error;
+        if (written == 0 && size > 0 && !failed) {
+            action = oatpp::async::Action::createWaitListAction(m_room.waitList());
+        }
+    }
+
+    // Notify outside the lock: the wait lists call back into the predicates
+    if (queued || failed) {
+        m_data.notify();
+    }
+    if (failed) {
+        throw std::runtime_error("Live stream closed: " + error);
+    }
+    return written;
+}
+
+void LiveStream::finish() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = true;
+    }
+    m_data.notify();
+}
+
+void LiveStream::fail(const std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        failLocked(error);
+    }
+    m_room.notify();
+    m_data.notify();
+}
+
+LiveStream::Next LiveStream::next(StreamChunk& chunk, oatpp::async::Action& action) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_failed) {
+            return Next::FAILED;
+        }
+
+        submitLocked();
+        if (!m_appending) {
+            if (m_finished) {
+                closeSessionLocked();
+                return Next::END;
+            }
+            action = oatpp::async::Action::createWaitListAction(m_data.waitList());
+            return Next::WAIT;
+        }
+        if (!m_pending.completion->isReady()) {
+            action = oatpp::async::Action::createWaitListAction(m_pending.completion->waitList());
+            return Next::WAIT;
+        }
+
+        try {
+            chunk = m_service->finishStreamAppend(m_pending);
+        } catch (const std::exception& e) {
+            failLocked(e.what());
+        }
+        m_pending = PendingStreamAppend();
+        m_appending = false;
+
+        // Everything that piled up meanwhile goes out as one append
+        submitLocked();
+    }
+
+    // The buffer was drained, or the reader has to learn about the failure
+    m_room.notify();
+    return m_failed ? Next::FAILED : Next::FEATURES;
+}
+
+std::string LiveStream::error() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+uint64_t LiveStream::sampleCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytesIn / sizeof(int16_t);
+}
+
+}}
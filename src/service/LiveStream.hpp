@@ -0,0 +1,82 @@
+#ifndef Service_LiveStream_hpp
+#define Service_LiveStream_hpp
+
+#include "AudioService.hpp"
+#include "FeatureStream.hpp"
+#include <mutex>
+#include <string>
+
+namespace app { namespace service {
+
+/**
+ * Per-connection state of a live audio stream (WebSocket) on top of a streaming
+ * STFT session: the worker keeps the carry between appends, so every append
+ * returns exactly the frames it completed.
+ *
+ * A session takes one append at a time. Audio that arrives while one is in
+ * flight is buffered and goes out as the next append, so a busy worker sees
+ * fewer, larger appends instead of a queue of 20 ms ones. The buffer holds at
+ * most one append (maxBufferSamples); once it is full write() consumes nothing,
+ * the reader stops pulling from the socket and TCP pushes back on the client.
+ *
+ * Shared by a reading and a sending coroutine, same contract as FeatureStream:
+ * nothing blocks, waits come back through `action`.
+ */
+class LiveStream {
+public:
+    enum class Next { FEATURES, WAIT, END, FAILED };
+
+private:
+    std::shared_ptr<AudioService> m_service;
+    std::mutex m_mutex;
+    uint64_t m_sessionId = 0;
+    bool m_sessionOpen = false;
+
+    std::string m_buffer;          // PCM16 bytes waiting for the next append
+    size_t m_maxBufferBytes;
+    PendingStreamAppend m_pending;
+    bool m_appending = false;
+
+    uint64_t m_bytesIn = 0;
+    bool m_finished = false;
+    bool m_failed = false;
+    std::string m_error;
+
+    StreamSignal m_room;   // reader: the buffer has room again
+    StreamSignal m_data;   // sender: an append was queued, or the audio ended
+
+    void submitLocked();
+    void closeSessionLocked();
+    void failLocked(const std::string& error);
+
+public:
+    // Without a free session the stream starts out FAILED, error() says why.
+    explicit LiveStream(const std::shared_ptr<AudioService>& service, size_t maxBufferSamples = AUDIO_CHUNK_SIZE);
+    ~LiveStream();
+
+    LiveStream(const LiveStream&) = delete;
+    LiveStream& operator=(const LiveStream&) = delete;
+
+    // --- Reader side ---
+
+    // Takes PCM16 bytes. Returns 0 with `action` set to a wait when the buffer is full.
+    // Throws once the stream has failed.
+    size_t write(const void* data, size_t size, oatpp::async::Action& action);
+    // No more audio: what is buffered still goes out, then next() reports END.
+    void finish();
+
+    // Either side: abandons the stream and wakes the other one.
+    void fail(const std::string& error);
+
+    // --- Sender side ---
+
+    // FEATURES fills `chunk` with the frames of the next finished append (possibly none).
+    Next next(StreamChunk& chunk, oatpp::async::Action& action);
+
+    std::string error();
+    uint64_t sampleCount();
+};
+
+}}
+
+#endif
@@ -0,0 +1,153 @@
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+namespace app { namespace service {
+
+namespace {
+
+// Bucket bounds exported to Prometheus, in seconds (the histograms themselves are finer)
+constexpr double BOUNDS_S[] = {
+    0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+    0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30
+};
+
+const char* const TASK_TYPE_NAMES[NUM_TASK_TYPES] = {"text", "audio", "stream"};
+const char* const ENDPOINT_NAMES[Metrics::ENDPOINT_COUNT] = {"process", "audio_stream", "session_append"};
+const char* const RING_NAMES[NUM_PRIORITIES] = {"interactive", "normal", "batch"};
+
+void appendf(std::string& out, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int len = std::vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (len > 0) {
+        out.append(line, std::min((size_t)len, sizeof(line) - 1));
+    }
+}
+
+void header(std::string& out, const char* name, const char* type, const char* help) {
+    appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+std::string label(const char* key, const char* value) {
+    return std::string(key) + "=\"" + value + "\"";
+}
+
+}
+
+Metrics::Metrics() {
+    for (size_t e = 0; e < ENDPOINT_COUNT; ++e) {
+        for (auto* histogram : {&m_latency[e], &m_serialize[e]}) {
+            for (auto& count : histogram->counts) count.store(0, std::memory_order_relaxed);
+            histogram->sum_ns.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Metrics::renderHistogram(std::string& out, const char* name, const std::string& labels,
+                              const LatencyHistogram& histogram) {
+    LatencyHistogram::Snapshot snapshot;
+    histogram.snapshot(snapshot);
+
+    for (double bound : BOUNDS_S) {
+        appendf(out, "%s_bucket{%s,le=\"%g\"} %llu\n", name, labels.c_str(), bound,
+                (unsigned long long)snapshot.countAtOrBelow((uint64_t)(bound * 1e9)));
+    }
+    appendf(out, "%s_bucket{%s,le=\"+Inf\"} %llu\n", name, labels.c_str(), (unsigned long long)snapshot.count);
+    appendf(out, "%s_sum{%s} %.9f\n", name, labels.c_str(), snapshot.sumNs / 1e9);
+    appendf(out, "%s_count{%s} %llu\n", name, labels.c_str(), (unsigned long long)snapshot.count);
+}
+
+std::string Metrics::render(WorkerManager* workerManager) const {
+    std::string out;
+    out.reserve(32 * 1024);
+
+    header(out, "whisper_request_duration_seconds", "histogram", "Request start to response ready, by endpoint");
+    for (size_t e = 0; e < ENDPOINT_COUNT; ++e) {
+        renderHistogram(out, "whisper_request_duration_seconds", label("endpoint", ENDPOINT_NAMES[e]), m_latency[e]);
+    }
+    header(out, "whisper_serialization_seconds", "histogram", "Time spent encoding the response body, by endpoint");
+    for (size_t e = 0; e < ENDPOINT_COUNT; ++e) {
+        renderHistogram(out, "whisper_serialization_seconds", label("endpoint", ENDPOINT_NAMES[e]), m_serialize[e]);
+    }
+
+    if (!workerManager || !workerManager->taskMetrics(TASK_TEXT_PROCESS)) {
+        return out;
+    }
+    WorkerManager& manager = *workerManager;
+
+    header(out, "whisper_task_queue_wait_seconds", "histogram", "Enqueue to dequeue by a worker, by task type");
+    for (uint32_t t = 0; t < NUM_TASK_TYPES; ++t) {
+        renderHistogram(out, "whisper_task_queue_wait_seconds", label("type", TASK_TYPE_NAMES[t]),
+                        manager.taskMetrics((TaskType)t)->queue_wait);
+    }
+    header(out, "whisper_task_compute_seconds", "histogram", "Worker processing time, by task type");
+    for (uint32_t t = 0; t < NUM_TASK_TYPES; ++t) {
+        renderHistogram(out, "whisper_task_compute_seconds", label("type", TASK_TYPE_NAMES[t]),
+                        manager.taskMetrics((TaskType)t)->compute);
+    }
+    header(out, "whisper_task_failed_total", "counter", "Tasks a worker answered with an error");
+    for (uint32_t t = 0; t < NUM_TASK_TYPES; ++t) {
+        appendf(out, "whisper_task_failed_total{type=\"%s\"} %llu\n", TASK_TYPE_NAMES[t],
+                (unsigned long long)manager.taskMetrics((TaskType)t)->failed.load(std::memory_order_relaxed));
+    }
+    header(out, "whisper_task_skipped_total", "counter", "Tasks cancelled or expired before a worker computed them");
+    for (uint32_t t = 0; t < NUM_TASK_TYPES; ++t) {
+        appendf(out, "whisper_task_skipped_total{type=\"%s\"} %llu\n", TASK_TYPE_NAMES[t],
+                (unsigned long long)manager.taskMetrics((TaskType)t)->skipped.load(std::memory_order_relaxed));
+    }
+
+    header(out, "whisper_worker_busy_seconds_total", "counter", "Time each worker slot spent computing");
+    for (size_t w = 0; w < MAX_WORKERS; ++w) {
+        appendf(out, "whisper_worker_busy_seconds_total{slot=\"%zu\"} %.6f\n", w,
+                manager.workerSlot(w)->busy_ns.load(std::memory_order_relaxed) / 1e9);
+    }
+    header(out, "whisper_worker_tasks_total", "counter", "Tasks each worker slot computed");
+    for (size_t w = 0; w < MAX_WORKERS; ++w) {
+        appendf(out, "whisper_worker_tasks_total{slot=\"%zu\"} %llu\n", w,
+                (unsigned long long)manager.workerSlot(w)->tasks.load(std::memory_order_relaxed));
+    }
+    header(out, "whisper_workers", "gauge", "Worker processes running and not retiring");
+    appendf(out, "whisper_workers %zu\n", manager.workerCount());
+
+    header(out, "whisper_ring_depth", "gauge", "Entries waiting in each ring");
+    for (uint32_t p = 0; p < NUM_PRIORITIES; ++p) {
+        appendf(out, "whisper_ring_depth{ring=\"%s\"} %zu\n", RING_NAMES[p], manager.priorityStats((TaskPriority)p).depth);
+    }
+    appendf(out, "whisper_ring_depth{ring=\"response\"} %zu\n", manager.responseDepth());
+    header(out, "whisper_ring_capacity", "gauge", "Slots per ring");
+    appendf(out, "whisper_ring_capacity %u\n", manager.ringCapacity());
+
+    header(out, "whisper_arena_bytes_in_use", "gauge", "Payload arena bytes allocated");
+    appendf(out, "whisper_arena_bytes_in_use %llu\n", (unsigned long long)manager.payloadBytesInUse());
+    header(out, "whisper_arena_bytes", "gauge", "Payload arena size");
+    appendf(out, "whisper_arena_bytes %llu\n", (unsigned long long)manager.arenaBytes());
+    header(out, "whisper_tasks_in_flight", "gauge", "Tasks submitted and not yet answered");
+    appendf(out, "whisper_tasks_in_flight %zu\n", manager.tasksInFlight());
+
+    FeatureCache::Stats cache = manager.featureCacheStats();
+    header(out, "whisper_feature_cache_requests_total", "counter",
+           "Feature tasks by how they were answered: cache hit, after an identical task in flight, or computed");
+    appendf(out, "whisper_feature_cache_requests_total{result=\"hit\"} %llu\n", (unsigned long long)cache.hits);
+    appendf(out, "whisper_feature_cache_requests_total{result=\"collapsed\"} %llu\n", (unsigned long long)cache.collapsed);
+    appendf(out, "whisper_feature_cache_requests_total{result=\"miss\"} %llu\n", (unsigned long long)cache.misses);
+    header(out, "whisper_feature_cache_inserts_total", "counter", "Features workers stored in the cache");
+    appendf(out, "whisper_feature_cache_inserts_total %llu\n", (unsigned long long)cache.inserts);
+    header(out, "whisper_feature_cache_evictions_total", "counter", "Cache entries evicted for room or budget");
+    appendf(out, "whisper_feature_cache_evictions_total %llu\n", (unsigned long long)cache.evictions);
+    header(out, "whisper_feature_cache_rejected_total", "counter", "Features not stored: over budget, arena full or set busy");
+    appendf(out, "whisper_feature_cache_rejected_total %llu\n", (unsigned long long)cache.rejected);
+    header(out, "whisper_feature_cache_entries", "gauge", "Features held in the cache");
+    appendf(out, "whisper_feature_cache_entries %llu\n", (unsigned long long)cache.entries);
+    header(out, "whisper_feature_cache_bytes", "gauge", "Arena bytes held by the cache");
+    appendf(out, "whisper_feature_cache_bytes %llu\n", (unsigned long long)cache.bytes);
+    header(out, "whisper_feature_cache_max_bytes", "gauge", "Cache budget (0 = off)");
+    appendf(out, "whisper_feature_cache_max_bytes %llu\n", (unsigned long long)cache.maxBytes);
+
+    return out;
+}
+
+}}
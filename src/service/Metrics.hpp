@@ -0,0 +1,58 @@
+#ifndef Service_Metrics_hpp
+#define Service_Metrics_hpp
+
+#include "worker/WorkerManager.hpp"
+#include "worker/LatencyHistogram.hpp"
+#include <string>
+
+namespace app { namespace service {
+
+using namespace app::worker;
+
+/**
+ * GET /metrics in the Prometheus text format (0.0.4).
+ *
+ * Per task type the workers record queue wait and compute time in SHM as they
+ * answer (TaskMetrics); per endpoint the host records end-to-end latency and the
+ * time spent serializing the response here. Both are LatencyHistograms, exported
+ * as cumulative buckets at fixed bounds. Gauges (ring depth, arena, workers) and
+ * per-worker counters are read at scrape time.
+ *
+ * Only successful responses are timed; errors show up in the failed/skipped counters.
+ */
+class Metrics {
+public:
+    enum Endpoint {
+        ENDPOINT_PROCESS = 0,     // POST /process
+        ENDPOINT_AUDIO,           // POST /audio/stream (whole-body responses)
+        ENDPOINT_SESSION_APPEND,  // POST /audio/stream/session/{id}
+        ENDPOINT_COUNT
+    };
+
+private:
+    LatencyHistogram m_latency[ENDPOINT_COUNT];
+    LatencyHistogram m_serialize[ENDPOINT_COUNT];
+
+public:
+    Metrics();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // Request start -> response ready
+    void recordLatency(Endpoint endpoint, uint64_t ns) { m_latency[endpoint].record(ns); }
+    // DTO -> JSON, or features -> binary
+    void recordSerialization(Endpoint endpoint, uint64_t ns) { m_serialize[endpoint].record(ns); }
+
+    // The whole scrape; workerManager may be null (host metrics only)
+    std::string render(WorkerManager* workerManager) const;
+
+    // One histogram: _bucket lines at the fixed bounds, then _sum and _count.
+    // name is the family without suffix, labels like `type="audio"`.
+    static void renderHistogram(std::string& out, const char* name, const std::string& labels,
+                                const LatencyHistogram& histogram);
+};
+
+}}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef PcmConvert_hpp
+#define PcmConvert_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+namespace app { namespace service {
+
+// PCM 16-bit little-endian -> float in [-1, 1). Shared by the service and my-bench.
+inline void convertPcm16(const int16_t* pcm, size_t count, float* out) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = pcm[i] / 32768.0f;
+    }
+}
+
+}}
+
+#endif // PcmConvert_hpp
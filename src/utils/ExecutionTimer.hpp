@@ -2,6 +2,7 @@
 #define Utils_ExecutionTimer_hpp
 
 #include <chrono>
+#include <cstdint>
 
 namespace app { namespace utils {
 
@@ -17,6 +18,11 @@ public:
         auto end = std::chrono::high_resolution_clock::now();
         return std::chrono::duration_cast<std::chrono::microseconds>(end - m_start).count();
     }
+
+    uint64_t getElapsedNanos() const {
+        auto end = std::chrono::high_resolution_clock::now();
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_start).count();
+    }
 };
 
 }}
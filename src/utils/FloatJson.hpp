@@ -0,0 +1,50 @@
+#ifndef Utils_FloatJson_hpp
+#define Utils_FloatJson_hpp
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+namespace app { namespace utils {
+
+/**
+ * JSON number arrays straight from floats: shortest round-trip digits via
+ * std::to_chars (strtof gives back the exact same float), no locale, no printf.
+ * Non-finite values become null, JSON has nothing better.
+ */
+class FloatJson {
+public:
+    // Longest shortest-form float ("-1.1754944e-38") plus the separator
+    static constexpr size_t MAX_CHARS = 16;
+
+    // Writes ",value" (or "value" for the first) into out, which needs MAX_CHARS; returns chars written.
+    static size_t writeElement(char* out, float value, bool first) {
+        char* p = out;
+        if (!first) {
+            *p++ = ',';
+        }
+        if (!std::isfinite(value)) {
+            p[0] = 'n'; p[1] = 'u'; p[2] = 'l'; p[3] = 'l';
+            return (size_t)(p + 4 - out);
+        }
+        return (size_t)(std::to_chars(p, out + MAX_CHARS, value).ptr - out);
+    }
+
+    // Appends "[v0,v1,...]": one resize up front, one pass, one trim.
+    static void appendArray(std::string& out, const float* values, size_t count) {
+        size_t start = out.size();
+        out.resize(start + count * MAX_CHARS + 2);
+        char* p = &out[start];
+        *p++ = '[';
+        for (size_t i = 0; i < count; ++i) {
+            p += writeElement(p, values[i], i == 0);
+        }
+        *p++ = ']';
+        out.resize((size_t)(p - out.data()));
+    }
+};
+
+}}
+
+#endif
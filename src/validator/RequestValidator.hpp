@@ -3,6 +3,7 @@
 
 #include "dto/ProcessDto.hpp"
 #include "exception/AppExceptions.hpp"
+#include "worker/SharedMemoryStructs.hpp"
 #include "oatpp/web/server/api/ApiController.hpp"
 
 namespace app { namespace validator {
@@ -33,6 +34,45 @@ public:
         }
     }
 
+    static uint64_t parseSessionId(const oatpp::String& value) {
+        if (!value || value->empty() || value->size() > 20) {
+            throw ValidationException("Invalid session id");
+        }
+        uint64_t id = 0;
+        for (char c : *value) {
+            if (c < '0' || c > '9') {
+                throw ValidationException("Invalid session id");
+            }
+            id = id * 10 + (uint64_t)(c - '0');
+        }
+        return id;
+    }
+
+    // /debug/trace?seconds=N: 1 to 60, 5 when absent
+    static uint32_t parseTraceSeconds(const oatpp::String& value) {
+        if (!value || value->empty()) return 5;
+        uint32_t seconds = 0;
+        for (char c : *value) {
+            if (c < '0' || c > '9' || seconds > 60) {
+                throw ValidationException("seconds must be between 1 and 60");
+            }
+            seconds = seconds * 10 + (uint32_t)(c - '0');
+        }
+        if (seconds < 1 || seconds > 60) {
+            throw ValidationException("seconds must be between 1 and 60");
+        }
+        return seconds;
+    }
+
+    // X-Priority: interactive | normal | batch; absent means the endpoint's default
+    static app::worker::TaskPriority parsePriority(const oatpp::String& value, app::worker::TaskPriority fallback) {
+        if (!value || value->empty()) return fallback;
+        if (*value == "interactive") return app::worker::PRIORITY_INTERACTIVE;
+        if (*value == "normal") return app::worker::PRIORITY_NORMAL;
+        if (*value == "batch") return app::worker::PRIORITY_BATCH;
+        throw ValidationException("X-Priority must be interactive, normal or batch");
+    }
+
     static void validateProcessRequest(const oatpp::Object<ProcessRequestDto>& dto) {
         if (!dto || !dto->message || dto->message->size() == 0) {
             throw ValidationException("Message cannot be empty");
@@ -0,0 +1,33 @@
+#ifndef WORKER_AUDIO_PARAMS_HPP
+#define WORKER_AUDIO_PARAMS_HPP
+
+#include <cstddef>
+
+namespace app { namespace worker {
+
+// Whisper Parameters (shared by the CPU and CUDA backends)
+constexpr int SAMPLE_RATE = 16000;
+constexpr int N_FFT = 400;
+constexpr int HOP_LENGTH = 160;
+constexpr int N_MELS = 80;
+constexpr int N_FFT_HALF = N_FFT / 2 + 1; // 201
+
+// Floor applied before log10, same as Whisper's log_mel_spectrogram.
+constexpr float LOG_MEL_FLOOR = 1e-10f;
+
+// Number of complete STFT frames in a buffer.
+// No centre padding: frame i covers samples [i * HOP_LENGTH, i * HOP_LENGTH + N_FFT).
+constexpr size_t numFrames(size_t numSamples) {
+    return numSamples < (size_t)N_FFT ? 0 : (numSamples - N_FFT) / HOP_LENGTH + 1;
+}
+
+// One input of a batched mel pass. outMel holds numFrames(numSamples) * N_MELS floats.
+struct MelJob {
+    const float* audio;
+    size_t numSamples;
+    float* outMel;
+};
+
+}}
+
+#endif
@@ -0,0 +1,70 @@
+#include "Autoscaler.hpp"
+#include <algorithm>
+
+namespace app { namespace worker {
+
+namespace {
+
+// Weight of the newest utilization sample
+constexpr double UTILIZATION_WEIGHT = 0.25;
+constexpr uint64_t MS = 1000 * 1000;
+
+}
+
+Autoscaler::Autoscaler(const ScalingConfig& config)
+    : m_config(config)
+{
+    m_config.maxWorkers = std::min(std::max(m_config.maxWorkers, (size_t)1), MAX_WORKERS);
+    m_config.minWorkers = std::min(m_config.minWorkers, m_config.maxWorkers);
+    m_config.queuePerWorker = std::max(m_config.queuePerWorker, (size_t)1);
+}
+
+int Autoscaler::decide(const Sample& sample) {
+    const size_t workers = sample.workers;
+
+    // Out of bounds (startup, a crashed worker): fix it right away
+    if (workers < m_config.minWorkers) {
+        return (int)(m_config.minWorkers - workers);
+    }
+    if (workers > m_config.maxWorkers) {
+        return -(int)(workers - m_config.maxWorkers);
+    }
+
+    double utilization = 0.0;
+    if (workers > 0 && sample.elapsedNs > 0) {
+        utilization = std::min((double)sample.busyNs / ((double)sample.elapsedNs * workers), 1.0);
+    }
+    m_utilization += (utilization - m_utilization) * UTILIZATION_WEIGHT;
+
+    bool deep = sample.queued >= std::max(workers, (size_t)1) * m_config.queuePerWorker;
+    bool pressure = deep || m_utilization >= m_config.scaleUpUtilization;
+    bool idle = sample.queued == 0 && m_utilization <= m_config.scaleDownUtilization;
+
+    m_pressureNs = pressure ? m_pressureNs + sample.elapsedNs : 0;
+    m_idleNs = idle ? m_idleNs + sample.elapsedNs : 0;
+    m_sinceChangeNs += sample.elapsedNs;
+
+    if (m_sinceChangeNs < m_config.cooldownMs * MS) {
+        return 0;
+    }
+
+    int delta = 0;
+    if (m_pressureNs >= m_config.scaleUpAfterMs * MS && workers < m_config.maxWorkers) {
+        // Enough workers to bring the rings back under the threshold, at most double
+        size_t wanted = deep ? (sample.queued + m_config.queuePerWorker - 1) / m_config.queuePerWorker : workers + 1;
+        size_t step = std::min(std::max(wanted, workers + 1) - workers, std::max(workers, (size_t)1));
+        delta = (int)std::min(step, m_config.maxWorkers - workers);
+    } else if (m_idleNs >= m_config.scaleDownAfterMs * MS && workers > m_config.minWorkers) {
+        delta = -1;
+    }
+
+    if (delta != 0) {
+        // The next decision waits for fresh evidence from the resized pool
+        m_pressureNs = 0;
+        m_idleNs = 0;
+        m_sinceChangeNs = 0;
+    }
+    return delta;
+}
+
+}}
@@ -0,0 +1,62 @@
+#ifndef WORKER_AUTOSCALER_HPP
+#define WORKER_AUTOSCALER_HPP
+
+#include "SharedMemoryStructs.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace app { namespace worker {
+
+/**
+ * Bounds and thresholds for growing / shrinking the worker pool at runtime.
+ * minWorkers == maxWorkers pins the pool; 0 for both means "whatever start() was given".
+ */
+struct ScalingConfig {
+    size_t minWorkers = 0;
+    size_t maxWorkers = 0;
+    size_t queuePerWorker = 2;           // queued requests per worker that count as pressure
+    double scaleUpUtilization = 0.85;    // busy fraction that counts as pressure
+    double scaleDownUtilization = 0.25;  // below this with empty rings the pool is idle
+    uint64_t scaleUpAfterMs = 1000;      // pressure has to last this long
+    uint64_t scaleDownAfterMs = 30000;   // idle has to last this long
+    uint64_t cooldownMs = 5000;          // no change sooner than this after the last one
+};
+
+/**
+ * Decides, once per supervisor tick, how many workers to add or retire.
+ *
+ * Pressure (rings backing up, or workers busy most of the time) has to hold for
+ * scaleUpAfterMs, idleness for scaleDownAfterMs, and both thresholds are far
+ * apart, so a short burst or lull doesn't make the pool flap. Scale-up may double
+ * the pool at once when the rings are deep; scale-down retires one worker at a time.
+ * Pure bookkeeping, no clock or processes: WorkerManager feeds it samples.
+ */
+class Autoscaler {
+public:
+    struct Sample {
+        size_t workers = 0;       // running and not retiring
+        size_t queued = 0;        // requests waiting in all rings
+        uint64_t busyNs = 0;      // worker time spent computing since the last sample
+        uint64_t elapsedNs = 0;   // wall time since the last sample
+    };
+
+private:
+    ScalingConfig m_config;
+    double m_utilization = 0.0;
+    uint64_t m_pressureNs = 0;
+    uint64_t m_idleNs = 0;
+    uint64_t m_sinceChangeNs = 0;
+
+public:
+    explicit Autoscaler(const ScalingConfig& config);
+
+    // > 0: start that many workers, < 0: retire that many, 0: leave the pool alone
+    int decide(const Sample& sample);
+
+    // Smoothed busy fraction of the pool, 0..1
+    double utilization() const { return m_utilization; }
+};
+
+}}
+
+#endif
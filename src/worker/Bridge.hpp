@@ -1,7 +1,9 @@
 #ifndef WORKER_BRIDGE_HPP
 #define WORKER_BRIDGE_HPP
 
+#include "AudioParams.hpp"
 #include <vector>
+#include <cstddef>
 
 namespace app { namespace worker {
 
@@ -9,6 +11,14 @@ class AudioWorker {
 public:
     virtual ~AudioWorker() = default;
     void computeMelSpectrogram(const std::vector<float>& inputAudio, std::vector<float>& outputMel);
+
+    // In-place variant: reads/writes caller memory (e.g. SHM payload blocks) directly.
+    // outMel must hold numFrames(numSamples) * N_MELS floats. Returns the frame count.
+    size_t computeMelSpectrogram(const float* audio, size_t numSamples, float* outMel);
+
+    // Several inputs in one pass (one plan, one filterbank pass over all frames).
+    // Returns the total frame count.
+    size_t computeMelSpectrogramBatch(const MelJob* jobs, size_t count);
 };
 
 }}
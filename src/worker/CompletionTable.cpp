@@ -0,0 +1,194 @@
+#include "CompletionTable.hpp"
+#include <thread>
+#include <algorithm>
+
+namespace app { namespace worker {
+
+namespace {
+
+constexpr uint32_t NO_SLOT = 0xFFFFFFFF;
+
+inline uint64_t packHead(uint64_t tag, uint32_t slot) {
+    return (tag << 32) | slot;
+}
+
+}
+
+void TaskHandle::reset() {
+    if (m_table) {
+        m_table->drop(m_slot, m_taskId);
+        m_table = nullptr;
+    }
+}
+
+TaskCompletion& TaskHandle::operator*() const {
+    return m_table->m_entries[m_slot].completion;
+}
+
+CompletionTable::CompletionTable(size_t capacity) {
+    // Power of two so the slot is just the low bits of the task id
+    m_capacity = 2;
+    m_slotBits = 1;
+    while (m_capacity < capacity) {
+        m_capacity <<= 1;
+        ++m_slotBits;
+    }
+
+    m_entries.reset(new Entry[m_capacity]);
+    m_next.reset(new std::atomic<uint32_t>[m_capacity]);
+    m_freeHead.store(packHead(0, NO_SLOT), std::memory_order_relaxed);
+    for (uint32_t i = m_capacity; i-- > 0;) {
+        pushFree(i);
+    }
+}
+
+void CompletionTable::pushFree(uint32_t slot) {
+    uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+    do {
+        m_next[slot].store((uint32_t)head, std::memory_order_relaxed);
+    } while (!m_freeHead.compare_exchange_weak(head, packHead((head >> 32) + 1, slot),
+                                               std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool CompletionTable::popFree(uint32_t& slot) {
+    uint64_t head = m_freeHead.load(std::memory_order_acquire);
+    while ((uint32_t)head != NO_SLOT) {
+        uint32_t next = m_next[(uint32_t)head].load(std::memory_order_relaxed);
+        if (m_freeHead.compare_exchange_weak(head, packHead((head >> 32) + 1, next),
+                                             std::memory_order_acq_rel, std::memory_order_acquire)) {
+            slot = (uint32_t)head;
+            return true;
+        }
+    }
+    return false;
+}
+
+TaskHandle CompletionTable::claim(uint64_t deadlineNs) {
+    uint32_t slot;
+    if (!popFree(slot)) {
+        return TaskHandle();
+    }
+
+    // Popped entries are exclusively ours until published as PENDING
+    Entry& entry = m_entries[slot];
+    entry.generation++;
+    uint64_t taskId = (entry.generation << m_slotBits) | slot;
+    entry.completion.reset();
+    entry.deadline.store(deadlineNs, std::memory_order_relaxed);
+    entry.state.store(pack(taskId, PENDING), std::memory_order_release);
+    m_inFlight.fetch_add(1, std::memory_order_relaxed);
+    if (deadlineNs != 0) {
+        lowerNextDeadline(deadlineNs);
+    }
+
+    return TaskHandle(this, slot, taskId);
+}
+
+bool CompletionTable::complete(uint64_t taskId, TaskResult&& result) {
+    Entry& entry = m_entries[taskId & (m_capacity - 1)];
+
+    uint64_t expected = pack(taskId, PENDING);
+    if (entry.state.compare_exchange_strong(expected, pack(taskId, COMPLETING), std::memory_order_acq_rel)) {
+        entry.completion.complete(std::move(result));
+        entry.state.store(pack(taskId, READY), std::memory_order_release);
+        return true;
+    }
+
+    // The handle was dropped before we answered. The deadline thread, failAll() and the
+    // response thread may all get here for the same task: only the one that claims it recycles.
+    if (expected == pack(taskId, ABANDONED) &&
+        entry.state.compare_exchange_strong(expected, pack(taskId, COMPLETING), std::memory_order_acq_rel)) {
+        recycle((uint32_t)(taskId & (m_capacity - 1)));
+    }
+    return false;
+}
+
+void CompletionTable::drop(uint32_t slot, uint64_t taskId) {
+    Entry& entry = m_entries[slot];
+    for (;;) {
+        uint64_t expected = pack(taskId, PENDING);
+        // Still unanswered: leave recycling to whoever completes it, and tell the workers not to bother
+        if (entry.state.compare_exchange_strong(expected, pack(taskId, ABANDONED), std::memory_order_acq_rel)) {
+            cancel(taskId);
+            return;
+        }
+        if (expected == pack(taskId, READY)) {
+            recycle(slot);
+            return;
+        }
+        // COMPLETING: the response thread is mid-handoff, a few instructions at most
+        std::this_thread::yield();
+    }
+}
+
+void CompletionTable::recycle(uint32_t slot) {
+    Entry& entry = m_entries[slot];
+    // Drop any result nobody took (releases its payload lease)
+    entry.completion.reset();
+    entry.state.store(FREE, std::memory_order_release);
+    m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+    pushFree(slot);
+}
+
+void CompletionTable::failAll(uint32_t statusCode) {
+    for (uint32_t slot = 0; slot < m_capacity; ++slot) {
+        uint64_t state = m_entries[slot].state.load(std::memory_order_acquire);
+        uint64_t s = state & STATE_MASK;
+        if (s == PENDING || s == ABANDONED) {
+            RespSlot resp = {};
+            resp.task_id = state >> STATE_BITS;
+            resp.status_code = statusCode;
+            complete(resp.task_id, TaskResult{resp, PayloadLease()});
+        }
+    }
+}
+
+size_t CompletionTable::expire(uint64_t nowNs, uint32_t statusCode) {
+    if (nowNs < m_nextDeadline.load()) {
+        return 0;
+    }
+
+    // Claims racing with the scan lower it again themselves
+    m_nextDeadline.store(UINT64_MAX);
+    uint64_t next = UINT64_MAX;
+    size_t expired = 0;
+    for (uint32_t slot = 0; slot < m_capacity; ++slot) {
+        Entry& entry = m_entries[slot];
+        uint64_t state = entry.state.load(std::memory_order_acquire);
+        uint64_t s = state & STATE_MASK;
+        if (s != PENDING && s != ABANDONED) continue;
+
+        uint64_t deadline = entry.deadline.load(std::memory_order_relaxed);
+        if (deadline == 0) continue;
+        if (deadline > nowNs) {
+            next = std::min(next, deadline);
+            continue;
+        }
+
+        RespSlot resp = {};
+        resp.task_id = state >> STATE_BITS;
+        resp.status_code = statusCode;
+        cancel(resp.task_id);
+        if (complete(resp.task_id, TaskResult{resp, PayloadLease()})) {
+            ++expired;
+        }
+    }
+    if (next != UINT64_MAX) {
+        lowerNextDeadline(next);
+    }
+    return expired;
+}
+
+void CompletionTable::lowerNextDeadline(uint64_t deadlineNs) {
+    uint64_t current = m_nextDeadline.load();
+    while (deadlineNs < current && !m_nextDeadline.compare_exchange_weak(current, deadlineNs)) {}
+}
+
+void CompletionTable::cancel(uint64_t taskId) {
+    std::atomic<uint64_t>* flags = m_cancelFlags.load(std::memory_order_acquire);
+    if (flags) {
+        flags[taskId & (CANCEL_SLOTS - 1)].store(taskId, std::memory_order_relaxed);
+    }
+}
+
+}}
@@ -0,0 +1,144 @@
+#ifndef WORKER_COMPLETION_TABLE_HPP
+#define WORKER_COMPLETION_TABLE_HPP
+
+#include "TaskCompletion.hpp"
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace app { namespace worker {
+
+class CompletionTable;
+
+/**
+ * Caller's claim on one table entry. Move-only; dropping it hands the entry
+ * back for reuse (right away if answered, otherwise once the late answer arrives).
+ */
+class TaskHandle {
+    friend class CompletionTable;
+private:
+    CompletionTable* m_table = nullptr;
+    uint32_t m_slot = 0;
+    uint64_t m_taskId = 0;
+
+    TaskHandle(CompletionTable* table, uint32_t slot, uint64_t taskId)
+        : m_table(table), m_slot(slot), m_taskId(taskId) {}
+
+public:
+    TaskHandle() = default;
+
+    TaskHandle(TaskHandle&& other) noexcept
+        : m_table(other.m_table), m_slot(other.m_slot), m_taskId(other.m_taskId) {
+        other.m_table = nullptr;
+    }
+
+    TaskHandle& operator=(TaskHandle&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_table = other.m_table;
+            m_slot = other.m_slot;
+            m_taskId = other.m_taskId;
+            other.m_table = nullptr;
+        }
+        return *this;
+    }
+
+    TaskHandle(const TaskHandle&) = delete;
+    TaskHandle& operator=(const TaskHandle&) = delete;
+
+    ~TaskHandle() { reset(); }
+
+    void reset();
+
+    uint64_t taskId() const { return m_taskId; }
+    explicit operator bool() const { return m_table != nullptr; }
+
+    TaskCompletion& operator*() const;
+    TaskCompletion* operator->() const { return &**this; }
+};
+
+/**
+ * Preallocated, generation-tagged table of in-flight tasks. Replaces the
+ * mutex-guarded map of promises: claim and complete are a handful of atomics,
+ * no allocation and no lock shared between executor threads and the response thread.
+ *
+ * task_id = (generation << slotBits) | slot, so the response thread finds the
+ * entry by masking, and a late answer for an entry that has been recycled in
+ * the meantime simply doesn't match. Each entry's state word packs the task id
+ * with PENDING / COMPLETING / READY / ABANDONED, so every transition is one CAS
+ * against the exact task it was meant for.
+ *
+ * Tasks may carry a deadline; expire() settles the ones past it as if the worker
+ * had answered with an error. Tasks nobody waits for any more (abandoned or
+ * expired) are flagged in the attached SHM cancel flags so workers skip them.
+ */
+class CompletionTable {
+    friend class TaskHandle;
+private:
+    enum State : uint64_t {
+        FREE = 0,
+        PENDING = 1,
+        COMPLETING = 2,
+        READY = 3,
+        ABANDONED = 4
+    };
+    static constexpr uint64_t STATE_BITS = 3;
+    static constexpr uint64_t STATE_MASK = (1u << STATE_BITS) - 1;
+
+    struct alignas(64) Entry {
+        std::atomic<uint64_t> state{FREE};   // (taskId << STATE_BITS) | State
+        uint64_t generation = 0;             // only touched by the entry's owner
+        std::atomic<uint64_t> deadline{0};   // monotonicNowNs(), 0 = none
+        TaskCompletion completion;
+    };
+
+    std::unique_ptr<Entry[]> m_entries;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+    std::atomic<uint64_t> m_freeHead;      // (aba_tag << 32) | slot
+    std::atomic<size_t> m_inFlight{0};
+    std::atomic<uint64_t> m_nextDeadline{UINT64_MAX};   // no pending deadline before this
+    std::atomic<std::atomic<uint64_t>*> m_cancelFlags{nullptr};
+    uint32_t m_capacity;
+    uint32_t m_slotBits;
+
+    static uint64_t pack(uint64_t taskId, State state) {
+        return (taskId << STATE_BITS) | state;
+    }
+
+    void pushFree(uint32_t slot);
+    bool popFree(uint32_t& slot);
+    void recycle(uint32_t slot);
+    void drop(uint32_t slot, uint64_t taskId);
+    void cancel(uint64_t taskId);
+    void lowerNextDeadline(uint64_t deadlineNs);
+
+public:
+    explicit CompletionTable(size_t capacity = DEFAULT_MAX_IN_FLIGHT);
+
+    CompletionTable(const CompletionTable&) = delete;
+    CompletionTable& operator=(const CompletionTable&) = delete;
+
+    // Returns an empty handle when every entry is in flight.
+    TaskHandle claim(uint64_t deadlineNs = 0);
+
+    // Response thread. Returns false when nobody is waiting for taskId any more
+    // (caller gave up, or the id is stale); result is then dropped, releasing its payload.
+    bool complete(uint64_t taskId, TaskResult&& result);
+
+    // Completes every pending task with the given status (shutdown).
+    void failAll(uint32_t statusCode);
+
+    // Completes every pending task whose deadline is at or before nowNs with the given
+    // status. Cheap to call often: it only scans once the earliest deadline has passed.
+    size_t expire(uint64_t nowNs, uint32_t statusCode);
+
+    // SharedMem::cancelled (CANCEL_SLOTS entries), or nullptr to detach.
+    void attachCancelFlags(std::atomic<uint64_t>* flags) { m_cancelFlags.store(flags, std::memory_order_release); }
+
+    size_t capacity() const { return m_capacity; }
+    size_t inFlight() const { return m_inFlight.load(std::memory_order_relaxed); }
+};
+
+}}
+
+#endif
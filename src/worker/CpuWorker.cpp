@@ -0,0 +1,36 @@
+#include "Bridge.hpp"
+#include "AudioParams.hpp"
+#include "cpu/MelEngine.hpp"
+#include "oatpp/core/base/Environment.hpp"
+
+namespace app { namespace worker {
+
+namespace {
+
+// Engine owns FFT plan, filters and scratch; build once per thread and reuse.
+cpu::MelEngine& threadEngine() {
+    thread_local cpu::MelEngine engine;
+    thread_local bool logged = false;
+    if (!logged) {
+        OATPP_LOGI("AudioWorker", "[CPU] Using '%s' mel kernels", engine.kernels().name);
+        logged = true;
+    }
+    return engine;
+}
+
+}
+
+size_t AudioWorker::computeMelSpectrogram(const float* audio, size_t numSamples, float* outMel) {
+    return threadEngine().compute(audio, numSamples, outMel);
+}
+
+size_t AudioWorker::computeMelSpectrogramBatch(const MelJob* jobs, size_t count) {
+    return threadEngine().computeBatch(jobs, count);
+}
+
+void AudioWorker::computeMelSpectrogram(const std::vector<float>& inputAudio, std::vector<float>& outputMel) {
+    outputMel.resize(numFrames(inputAudio.size()) * N_MELS);
+    computeMelSpectrogram(inputAudio.data(), inputAudio.size(), outputMel.data());
+}
+
+}}
@@ -0,0 +1,390 @@
+#include "FeatureCache.hpp"
+#include "AudioParams.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace app { namespace worker {
+
+namespace {
+
+constexpr uint32_t FEATURE_CACHE_WRITER = 1u << 31;
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// MurmurHash3_x64_128 (public domain, Austin Appleby), 64-bit seed
+FeatureKey murmur3(const uint8_t* data, size_t len, uint64_t seed) {
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    size_t blocks = len / 16;
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, data + i * 16, 8);
+        std::memcpy(&k2, data + i * 16 + 8, 8);
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t* tail = data + blocks * 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch (len & 15) {
+        case 15: k2 ^= (uint64_t)tail[14] << 48; // fallthrough
+        case 14: k2 ^= (uint64_t)tail[13] << 40; // fallthrough
+        case 13: k2 ^= (uint64_t)tail[12] << 32; // fallthrough
+        case 12: k2 ^= (uint64_t)tail[11] << 24; // fallthrough
+        case 11: k2 ^= (uint64_t)tail[10] << 16; // fallthrough
+        case 10: k2 ^= (uint64_t)tail[9] << 8;   // fallthrough
+        case 9:  k2 ^= (uint64_t)tail[8];
+                 k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+                 // fallthrough
+        case 8:  k1 ^= (uint64_t)tail[7] << 56;  // fallthrough
+        case 7:  k1 ^= (uint64_t)tail[6] << 48;  // fallthrough
+        case 6:  k1 ^= (uint64_t)tail[5] << 40;  // fallthrough
+        case 5:  k1 ^= (uint64_t)tail[4] << 32;  // fallthrough
+        case 4:  k1 ^= (uint64_t)tail[3] << 24;  // fallthrough
+        case 3:  k1 ^= (uint64_t)tail[2] << 16;  // fallthrough
+        case 2:  k1 ^= (uint64_t)tail[1] << 8;   // fallthrough
+        case 1:  k1 ^= (uint64_t)tail[0];
+                 k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= (uint64_t)len;
+    h2 ^= (uint64_t)len;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    FeatureKey key;
+    key.lo = h1;
+    key.hi = h2;
+    return key;
+}
+
+uint32_t setOf(const FeatureKey& key) {
+    return (uint32_t)(key.hi % FEATURE_CACHE_SETS);
+}
+
+// Never 0 (a key never is), which marks an entry nobody claims. Two keys with the same
+// claim in one set only cost an insert, never a wrong hit.
+uint64_t claimOf(const FeatureKey& key) {
+    return key.lo != 0 ? key.lo : key.hi;
+}
+
+}
+
+void FeatureCache::attach(FeatureCacheHeader* header, PayloadArena* arena) {
+    m_header = header;
+    m_arena = arena;
+}
+
+FeatureKey FeatureCache::keyOf(const float* samples, size_t count) {
+    // Features of the same samples under other parameters are other features
+    uint64_t seed = ((uint64_t)N_FFT << 48) ^ ((uint64_t)HOP_LENGTH << 32) ^ ((uint64_t)N_MELS << 16) ^ SAMPLE_RATE;
+    FeatureKey key = murmur3(reinterpret_cast<const uint8_t*>(samples), count * sizeof(float), seed);
+    if (!key) {
+        key.lo = 1; // empty means "don't cache"
+    }
+    return key;
+}
+
+bool FeatureCache::tryRead(FeatureCacheEntry& entry) {
+    uint32_t lock = entry.lock.load(std::memory_order_relaxed);
+    while (!(lock & FEATURE_CACHE_WRITER)) {
+        if (entry.lock.compare_exchange_weak(lock, lock + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FeatureCache::tryWrite(FeatureCacheEntry& entry) {
+    uint32_t unlocked = 0;
+    return entry.lock.compare_exchange_strong(unlocked, FEATURE_CACHE_WRITER, std::memory_order_acquire,
+                                              std::memory_order_relaxed);
+}
+
+void FeatureCache::unlockRead(FeatureCacheEntry& entry) {
+    entry.lock.fetch_sub(1, std::memory_order_release);
+}
+
+void FeatureCache::unlockWrite(FeatureCacheEntry& entry) {
+    entry.lock.store(0, std::memory_order_release);
+}
+
+void FeatureCache::evict(FeatureCacheEntry& entry) {
+    m_header->bytes.fetch_sub(m_arena->capacityOf(entry.features), std::memory_order_relaxed);
+    m_arena->release(entry.features);
+    entry.features = PayloadRef();
+    entry.len = 0;
+    entry.claim.store(0, std::memory_order_relaxed);
+    m_header->evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FeatureCache::sweepOne() {
+    uint32_t hand = m_header->sweep_hand.fetch_add(1, std::memory_order_relaxed);
+    FeatureCacheEntry& entry = m_header->entries[hand % FEATURE_CACHE_SLOTS];
+    if (!tryWrite(entry)) {
+        return false;
+    }
+    bool evicted = false;
+    if (entry.len != 0) {
+        // Second chance: referenced since the hand last came by
+        if (entry.referenced.exchange(0, std::memory_order_relaxed) == 0) {
+            evict(entry);
+            evicted = true;
+        }
+    }
+    unlockWrite(entry);
+    return evicted;
+}
+
+bool FeatureCache::contains(const FeatureKey& key) {
+    FeatureCacheEntry* set = &m_header->entries[setOf(key) * FEATURE_CACHE_WAYS];
+    for (uint32_t way = 0; way < FEATURE_CACHE_WAYS; ++way) {
+        if (!tryRead(set[way])) continue;
+        bool found = set[way].len != 0 && set[way].key == key;
+        unlockRead(set[way]);
+        if (found) return true;
+    }
+    return false;
+}
+
+bool FeatureCache::lookup(const FeatureKey& key, PayloadLease& features, size_t& count) {
+    if (!enabled() || !key) {
+        return false;
+    }
+    FeatureCacheEntry* set = &m_header->entries[setOf(key) * FEATURE_CACHE_WAYS];
+    for (uint32_t way = 0; way < FEATURE_CACHE_WAYS; ++way) {
+        FeatureCacheEntry& entry = set[way];
+        if (!tryRead(entry)) continue;
+        if (entry.len == 0 || !(entry.key == key)) {
+            unlockRead(entry);
+            continue;
+        }
+
+        PayloadRef copy = m_arena->allocate((size_t)entry.len * sizeof(float));
+        bool hit = copy.valid();
+        if (hit) {
+            const float* cached = static_cast<const float*>(m_arena->data(entry.features));
+            std::copy(cached, cached + entry.len, static_cast<float*>(m_arena->data(copy)));
+            count = entry.len;
+            entry.referenced.store(1, std::memory_order_relaxed);
+        }
+        unlockRead(entry);
+        if (hit) {
+            features = PayloadLease(m_arena, copy);
+        }
+        return hit;
+    }
+    return false;
+}
+
+bool FeatureCache::insert(const FeatureKey& key, const float* features, size_t count) {
+    if (!enabled() || !key || count == 0 || contains(key)) {
+        return false;
+    }
+
+    // Larger than the whole budget: storing it would only flush everything else
+    PayloadRef block;
+    if (PayloadArena::classBytes(PayloadArena::sizeClassFor(count * sizeof(float))) <= m_header->max_bytes) {
+        block = m_arena->allocate(count * sizeof(float));
+    }
+    if (!block.valid()) {
+        m_header->rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    uint64_t blockBytes = m_arena->capacityOf(block);
+    std::copy(features, features + count, static_cast<float*>(m_arena->data(block)));
+
+    // Budget first: the hand gets two rounds (one to clear reference bits, one to evict)
+    uint64_t bytes = m_header->bytes.fetch_add(blockBytes, std::memory_order_relaxed) + blockBytes;
+    for (uint32_t step = 0; bytes > m_header->max_bytes && step < 2 * FEATURE_CACHE_SLOTS; ++step) {
+        sweepOne();
+        bytes = m_header->bytes.load(std::memory_order_relaxed);
+    }
+
+    FeatureCacheEntry* slot = nullptr;
+    bool duplicate = false;
+    uint32_t set = setOf(key);
+    FeatureCacheEntry* ways = &m_header->entries[set * FEATURE_CACHE_WAYS];
+    if (bytes <= m_header->max_bytes) {
+        // Then a slot in the key's set, same two rounds
+        for (uint32_t step = 0; !slot && step < 2 * FEATURE_CACHE_WAYS; ++step) {
+            uint32_t hand = m_header->set_hands[set].fetch_add(1, std::memory_order_relaxed);
+            FeatureCacheEntry& entry = ways[hand % FEATURE_CACHE_WAYS];
+            if (!tryWrite(entry)) continue;
+            if (entry.len != 0 && entry.referenced.exchange(0, std::memory_order_relaxed) != 0) {
+                unlockWrite(entry);
+                continue;
+            }
+            if (entry.len != 0) {
+                evict(entry);
+            }
+            slot = &entry;
+        }
+    }
+
+    if (slot) {
+        // contains() can't see a way another worker is still filling in. Claim the key first, then look
+        // for anyone else's claim on it: of two racing inserts at least one sees the other and backs off.
+        slot->claim.store(claimOf(key), std::memory_order_seq_cst);
+        for (uint32_t way = 0; way < FEATURE_CACHE_WAYS && !duplicate; ++way) {
+            duplicate = &ways[way] != slot && ways[way].claim.load(std::memory_order_seq_cst) == claimOf(key);
+        }
+        if (duplicate) {
+            slot->claim.store(0, std::memory_order_relaxed);
+            unlockWrite(*slot);
+            slot = nullptr;
+        }
+    }
+
+    if (!slot) {
+        m_header->bytes.fetch_sub(blockBytes, std::memory_order_relaxed);
+        m_arena->release(block);
+        if (!duplicate) {
+            m_header->rejected.fetch_add(1, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    slot->key = key;
+    slot->features = block;
+    slot->len = (uint32_t)count;
+    slot->referenced.store(0, std::memory_order_relaxed);
+    unlockWrite(*slot);
+    m_header->inserts.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+FeatureCache::Stats FeatureCache::stats() const {
+    Stats stats;
+    if (!m_header) {
+        return stats;
+    }
+    stats.hits = m_header->hits.load(std::memory_order_relaxed);
+    stats.collapsed = m_header->collapsed.load(std::memory_order_relaxed);
+    stats.misses = m_header->misses.load(std::memory_order_relaxed);
+    stats.inserts = m_header->inserts.load(std::memory_order_relaxed);
+    stats.evictions = m_header->evictions.load(std::memory_order_relaxed);
+    stats.rejected = m_header->rejected.load(std::memory_order_relaxed);
+    stats.bytes = m_header->bytes.load(std::memory_order_relaxed);
+    stats.maxBytes = m_header->max_bytes;
+    // A racy count is fine for a gauge
+    for (const FeatureCacheEntry& entry : m_header->entries) {
+        if (entry.len != 0) ++stats.entries;
+    }
+    return stats;
+}
+
+void FlightLead::reset() {
+    if (m_flights) {
+        m_flights->land(m_key, m_flight.get());
+        m_flights = nullptr;
+        m_flight.reset();
+    }
+}
+
+void FlightLead::bind(uint64_t taskId) {
+    if (m_flights) {
+        m_flights->bind(m_key, m_flight.get(), taskId);
+    }
+}
+
+std::shared_ptr<TaskCompletion> FeatureFlights::join(const FeatureKey& key, FlightLead& lead) {
+    auto flight = std::make_shared<TaskCompletion>();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_flights.emplace(key, Flight{flight});
+        if (!it.second) {
+            return it.first->second.completion;
+        }
+    }
+    // Outside the lock: replacing a lead lands its flight
+    lead = FlightLead(this, key, flight);
+    return nullptr;
+}
+
+std::shared_ptr<TaskCompletion> FeatureFlights::takeLocked(std::unordered_map<FeatureKey, Flight, KeyHash>::iterator it) {
+    std::shared_ptr<TaskCompletion> landed = std::move(it->second.completion);
+    m_flights.erase(it);
+    return landed;
+}
+
+void FeatureFlights::land(const FeatureKey& key, const TaskCompletion* flight) {
+    std::shared_ptr<TaskCompletion> landed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_flights.find(key);
+        // A lead only lands its own flight, not a newer one for the same key
+        if (it == m_flights.end() || it->second.completion.get() != flight) {
+            return;
+        }
+        landed = takeLocked(it);
+    }
+    landed->complete(TaskResult());
+}
+
+void FeatureFlights::land(const FeatureKey& key, uint64_t taskId) {
+    std::shared_ptr<TaskCompletion> landed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_flights.find(key);
+        if (it == m_flights.end()) {
+            return;
+        }
+        if (it->second.taskId == 0) {
+            // The worker beat the lead to bind(): it lands the flight if this was its task
+            it->second.answered = taskId;
+            return;
+        }
+        if (it->second.taskId != taskId) {
+            return;
+        }
+        landed = takeLocked(it);
+    }
+    landed->complete(TaskResult());
+}
+
+void FeatureFlights::bind(const FeatureKey& key, const TaskCompletion* flight, uint64_t taskId) {
+    std::shared_ptr<TaskCompletion> landed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_flights.find(key);
+        if (it == m_flights.end() || it->second.completion.get() != flight) {
+            return;
+        }
+        if (it->second.answered != taskId) {
+            it->second.taskId = taskId;
+            return;
+        }
+        landed = takeLocked(it);
+    }
+    landed->complete(TaskResult());
+}
+
+size_t FeatureFlights::size() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_flights.size();
+}
+
+}}
@@ -0,0 +1,168 @@
+#ifndef WORKER_FEATURE_CACHE_HPP
+#define WORKER_FEATURE_CACHE_HPP
+
+#include "SharedMemoryStructs.hpp"
+#include "PayloadLease.hpp"
+#include "TaskCompletion.hpp"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace app { namespace worker {
+
+/**
+ * Mel features keyed by what they were computed from, in SharedMem::feature_cache.
+ *
+ * Workers insert the result of every keyed TASK_AUDIO_PROCESS before replying;
+ * the host looks a task up before submitting it and copies a hit into a fresh
+ * block, so an entry can be evicted as soon as nobody is copying it out.
+ *
+ * Entries sit in FEATURE_CACHE_SETS sets of FEATURE_CACHE_WAYS. A key has one set,
+ * whose CLOCK hand picks the slot it replaces; a second hand sweeps all entries
+ * while the arena bytes they hold exceed max_bytes. Each entry's lock is a reader
+ * count or the writer bit and is only ever tried, never waited for: a busy way is
+ * skipped, and a process that dies holding one loses that slot, not the cache.
+ * An insert claims its key in the set before storing it and backs off if anyone
+ * else claims it too, so a key is never stored twice.
+ */
+class FeatureCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t collapsed = 0;
+        uint64_t misses = 0;
+        uint64_t inserts = 0;
+        uint64_t evictions = 0;
+        uint64_t rejected = 0;
+        uint64_t entries = 0;
+        uint64_t bytes = 0;
+        uint64_t maxBytes = 0;
+    };
+
+private:
+    FeatureCacheHeader* m_header = nullptr;
+    PayloadArena* m_arena = nullptr;
+
+    bool tryRead(FeatureCacheEntry& entry);
+    bool tryWrite(FeatureCacheEntry& entry);
+    void unlockRead(FeatureCacheEntry& entry);
+    void unlockWrite(FeatureCacheEntry& entry);
+
+    // Entry write-locked by the caller
+    void evict(FeatureCacheEntry& entry);
+    // One step of the budget hand; false if it had nothing to do with this entry
+    bool sweepOne();
+    bool contains(const FeatureKey& key);
+
+public:
+    FeatureCache() = default;
+    FeatureCache(FeatureCacheHeader* header, PayloadArena* arena) : m_header(header), m_arena(arena) {}
+
+    // nullptr to detach
+    void attach(FeatureCacheHeader* header, PayloadArena* arena);
+
+    bool enabled() const { return m_header && m_header->max_bytes > 0; }
+
+    // MurmurHash3 (x64, 128-bit) of the samples, seeded with the STFT / mel parameters. Never empty.
+    static FeatureKey keyOf(const float* samples, size_t count);
+
+    // Copies a hit into a new arena block. False on a miss, or when the arena has no room for the copy.
+    bool lookup(const FeatureKey& key, PayloadLease& features, size_t& count);
+
+    // Workers. Stores a copy of count floats; false if it is already there or could not be stored.
+    bool insert(const FeatureKey& key, const float* features, size_t count);
+
+    void countHit() { m_header->hits.fetch_add(1, std::memory_order_relaxed); }
+    void countCollapsed() { m_header->collapsed.fetch_add(1, std::memory_order_relaxed); }
+    void countMiss() { m_header->misses.fetch_add(1, std::memory_order_relaxed); }
+
+    Stats stats() const;
+};
+
+class FeatureFlights;
+
+/**
+ * The caller that computes a key everyone else in its flight is waiting for.
+ * Move-only; lands the flight when dropped in case the answer never came
+ * back through the response thread.
+ */
+class FlightLead {
+private:
+    FeatureFlights* m_flights = nullptr;
+    FeatureKey m_key;
+    std::shared_ptr<TaskCompletion> m_flight;
+public:
+    FlightLead() = default;
+    FlightLead(FeatureFlights* flights, const FeatureKey& key, const std::shared_ptr<TaskCompletion>& flight)
+        : m_flights(flights), m_key(key), m_flight(flight) {}
+
+    FlightLead(FlightLead&& other) noexcept
+        : m_flights(other.m_flights), m_key(other.m_key), m_flight(std::move(other.m_flight)) {
+        other.m_flights = nullptr;
+    }
+
+    FlightLead& operator=(FlightLead&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_flights = other.m_flights;
+            m_key = other.m_key;
+            m_flight = std::move(other.m_flight);
+            other.m_flights = nullptr;
+        }
+        return *this;
+    }
+
+    FlightLead(const FlightLead&) = delete;
+    FlightLead& operator=(const FlightLead&) = delete;
+
+    ~FlightLead() { reset(); }
+
+    void reset();
+
+    // The lead's task was queued under taskId: only that task's answer lands the flight
+    void bind(uint64_t taskId);
+
+    explicit operator bool() const { return m_flights != nullptr; }
+};
+
+/**
+ * Host-side single-flight for keyed feature tasks: while one caller's task for a
+ * key is in flight, others with the same key wait on the flight instead of queueing
+ * the same work, then read the cache. The flight lands (completes, with an empty
+ * result) when the response thread sees the answer to its lead's task, or its lead
+ * is dropped. An answer to some other task with the same key (an older lead's, or a
+ * follower's that computed it after all) leaves a newer flight in the air.
+ */
+class FeatureFlights {
+    friend class FlightLead;
+private:
+    std::mutex m_mutex;
+
+    struct KeyHash {
+        size_t operator()(const FeatureKey& key) const { return (size_t)(key.lo ^ key.hi); }
+    };
+    struct Flight {
+        std::shared_ptr<TaskCompletion> completion;
+        uint64_t taskId = 0;     // the lead's task, once bound
+        uint64_t answered = 0;   // an answer that came in before the lead could bind
+    };
+    std::unordered_map<FeatureKey, Flight, KeyHash> m_flights;
+
+    // Under m_mutex; takes the entry out, the caller completes it
+    std::shared_ptr<TaskCompletion> takeLocked(std::unordered_map<FeatureKey, Flight, KeyHash>::iterator it);
+    void land(const FeatureKey& key, const TaskCompletion* flight);
+    void bind(const FeatureKey& key, const TaskCompletion* flight, uint64_t taskId);
+
+public:
+    // nullptr: no flight for key, the caller now leads one. Otherwise the flight to wait on.
+    std::shared_ptr<TaskCompletion> join(const FeatureKey& key, FlightLead& lead);
+
+    // Response thread: the flight for key, if taskId is its lead's task
+    void land(const FeatureKey& key, uint64_t taskId);
+
+    size_t size();
+};
+
+}}
+
+#endif
@@ -1,4 +1,6 @@
 #include "Bridge.hpp"
+#include "AudioParams.hpp"
+#include "MelFilterbank.hpp"
 #include <cuda_runtime.h>
 #include <cufft.h>
 #include <iostream>
@@ -8,18 +10,10 @@
 
 namespace app { namespace worker {
 
-// Whisper Parameters
-constexpr int SAMPLE_RATE = 16000;
-constexpr int N_FFT = 400;
-constexpr int HOP_LENGTH = 160;
-constexpr int N_MELS = 80;
-constexpr int N_FFT_HALF = N_FFT / 2 + 1; // 201
-
-// Precomputed Mel Filters (Global or Static)
-// Ideally, these should be computed once and reused.
-// For simplicity in this kernel-focused task, we will initialize them lazily or use a constant array if small enough (80*201 floats = 64KB, fits in constant/global memory).
-float* d_mel_filters = nullptr;
-float* h_mel_filters = nullptr;
+// Sparse Slaney filterbank (MelFilterbank.hpp), uploaded once.
+// ~391 weights instead of a dense 80x201 matrix.
+MelBand* d_mel_bands = nullptr;
+float* d_mel_weights = nullptr;
 
 // Hann Window
 float* d_hann_window = nullptr;
@@ -38,31 +32,14 @@ void checkCufft(cufftResult result, const char* msg) {
     }
 }
 
-// Helper to init Mel filters (Simplified for 16kHz)
-// This is usually done in Python (librosa) and loaded, but we must implement C++.
+// Upload the compile-time filterbank and the Hann window.
 void initFilters() {
-    if (h_mel_filters) return;
-
-    h_mel_filters = new float[N_MELS * N_FFT_HALF];
-    // TODO: Implement actual Mel filterbank calculation logic here matching librosa.filters.mel(sr=16000, n_fft=400, n_mels=80)
-    // For the prototype, we will fill with dummy identity/random or basic triangular filters to ensure "correctness" of pipeline.
-    // Real implementation would calculate:
-    // 1. FFT bin frequencies
-    // 2. Mel points
-    // 3. Triangular weights
-    
-    // Filling with 1.0/N_FFT_HALF to simulate averaging for now
-    for(int i=0; i<N_MELS * N_FFT_HALF; ++i) {
-        h_mel_filters[i] = 0.0f;
-    }
-    // Set some diagonals to 1 for basic pass-through simulation
-    for(int i=0; i<N_MELS; ++i) {
-        int bin = i * (N_FFT_HALF / N_MELS);
-        if(bin < N_FFT_HALF) h_mel_filters[i * N_FFT_HALF + bin] = 1.0f;
-    }
+    if (d_mel_bands) return;
 
-    checkCuda(cudaMalloc(&d_mel_filters, N_MELS * N_FFT_HALF * sizeof(float)), "Malloc Mel Filters");
-    checkCuda(cudaMemcpy(d_mel_filters, h_mel_filters, N_MELS * N_FFT_HALF * sizeof(float), cudaMemcpyHostToDevice), "Memcpy Mel Filters");
+    checkCuda(cudaMalloc(&d_mel_bands, sizeof(MEL_FILTERBANK.bands)), "Malloc Mel Bands");
+    checkCuda(cudaMemcpy(d_mel_bands, MEL_FILTERBANK.bands, sizeof(MEL_FILTERBANK.bands), cudaMemcpyHostToDevice), "Memcpy Mel Bands");
+    checkCuda(cudaMalloc(&d_mel_weights, sizeof(MEL_FILTERBANK.weights)), "Malloc Mel Weights");
+    checkCuda(cudaMemcpy(d_mel_weights, MEL_FILTERBANK.weights, sizeof(MEL_FILTERBANK.weights), cudaMemcpyHostToDevice), "Memcpy Mel Weights");
 
     // Init Hann Window
     float h_window[N_FFT];
@@ -73,93 +50,97 @@ void initFilters() {
     checkCuda(cudaMemcpy(d_hann_window, h_window, N_FFT * sizeof(float), cudaMemcpyHostToDevice), "Memcpy Hann Window");
 }
 
-// CUDA Kernel: Apply Window
-__global__ void applyWindowKernel(const float* input, float* output, const float* window, int num_frames) {
-    int idx = blockIdx.x * blockDim.x + threadIdx.x; // Global index
-    // Each frame has N_FFT samples
-    // input is flattened: frame0, frame1...
-    // But input audio is usually continuous? 
-    // Wait, STFT slices input into overlapping frames.
-    
-    // idx represents the linear index in the *windowed* buffer (num_frames * N_FFT)
+// CUDA Kernel: Apply Window over a batch of inputs packed back to back in one buffer.
+// frame_start[f] is where frame f begins in that buffer, so frames of different
+// inputs share one launch (and one cuFFT plan below).
+__global__ void applyWindowBatchKernel(const float* input, const long long* frame_start, float* output,
+                                       const float* window, int num_frames) {
+    int idx = blockIdx.x * blockDim.x + threadIdx.x;
     if (idx >= num_frames * N_FFT) return;
 
     int frame_idx = idx / N_FFT;
     int sample_in_frame = idx % N_FFT;
-    
-    // Input is continuous audio.
-    // Frame i starts at i * HOP_LENGTH.
-    // Sample j in Frame i corresponds to Input[i * HOP_LENGTH + j].
-    
-    // We assume input pointer is the start of the audio buffer.
-    // BOUNDARY CHECK: Ensure we don't read past input end?
-    // We assume caller provides padded input or handles boundaries.
-    
-    output[idx] = input[frame_idx * HOP_LENGTH + sample_in_frame] * window[sample_in_frame];
+    output[idx] = input[frame_start[frame_idx] + sample_in_frame] * window[sample_in_frame];
 }
 
 // CUDA Kernel: Compute Magnitude Squared and Apply Mel Filterbank
-// Optimized approach: One block per frame? Or one thread per frequency bin?
-// Magnitude: |complex|^2 = re^2 + im^2
-// Then Matmul: Mel_Matrix (80 x 201) * Magnitude_Vec (201 x 1) -> (80 x 1)
+// One block per frame. The block first stages |X|^2 for the frame in shared memory,
+// then each thread (one per mel bin) walks only the non-zero bins of its triangle.
 // Finally: log10(max(val, 1e-10))
 
-__global__ void magnitudeAndMelKernel(const cufftComplex* fft_data, float* mel_output, const float* mel_filters, int num_frames) {
+__global__ void magnitudeAndMelKernel(const cufftComplex* fft_data, float* mel_output,
+                                      const MelBand* mel_bands, const float* mel_weights, int num_frames) {
+    __shared__ float power[N_FFT_HALF];
+
     int frame_idx = blockIdx.x;
-    int mel_bin = threadIdx.x;
+    if (frame_idx >= num_frames) return;
+
+    const cufftComplex* frame = fft_data + frame_idx * N_FFT_HALF; // cuFFT R2C output size is N/2+1
+    for (int k = threadIdx.x; k < N_FFT_HALF; k += blockDim.x) {
+        cufftComplex c = frame[k];
+        power[k] = c.x * c.x + c.y * c.y;
+    }
+    __syncthreads();
 
-    if (frame_idx >= num_frames || mel_bin >= N_MELS) return;
+    int mel_bin = threadIdx.x;
+    if (mel_bin >= N_MELS) return;
 
+    MelBand band = mel_bands[mel_bin];
     float sum = 0.0f;
-    
-    // Dot product of row 'mel_bin' of filter bank with magnitude spectrum of 'frame_idx'
-    for (int k = 0; k < N_FFT_HALF; ++k) {
-        // Fetch complex value
-        cufftComplex c = fft_data[frame_idx * N_FFT_HALF + k]; // cuFFT R2C output size is N/2+1
-        float mag_sq = c.x * c.x + c.y * c.y;
-        
-        // Fetch filter weight
-        float weight = mel_filters[mel_bin * N_FFT_HALF + k];
-        
-        sum += mag_sq * weight;
+    for (int i = 0; i < band.length; ++i) {
+        sum += mel_weights[band.offset + i] * power[band.start + i];
     }
 
-    // Log10
-    // Whisper uses log10(val + 1e-10) ? Or just max?
-    // Usually log10(max(sum, 1e-10))
-    if (sum < 1e-10f) sum = 1e-10f;
-    sum = log10f(sum);
-
-    // Scaling? Whisper usually scales by 10.0 to get roughly db? 
-    // "log_mel_spectrogram" usually implies natural log or base 10.
-    // The requirement just says "compatible with Whisper". 
     // Standard Whisper preprocessing: log10(max(x, 1e-10))
-    
-    mel_output[frame_idx * N_MELS + mel_bin] = sum;
+    if (sum < LOG_MEL_FLOOR) sum = LOG_MEL_FLOOR;
+    mel_output[frame_idx * N_MELS + mel_bin] = log10f(sum);
 }
 
 void AudioWorker::computeMelSpectrogram(const std::vector<float>& inputAudio, std::vector<float>& outputMel) {
+    outputMel.resize(numFrames(inputAudio.size()) * N_MELS);
+    computeMelSpectrogram(inputAudio.data(), inputAudio.size(), outputMel.data());
+}
+
+size_t AudioWorker::computeMelSpectrogram(const float* audio, size_t num_samples, float* outMel) {
+    MelJob job{audio, num_samples, outMel};
+    return computeMelSpectrogramBatch(&job, 1);
+}
+
+size_t AudioWorker::computeMelSpectrogramBatch(const MelJob* jobs, size_t count) {
     // 1. Lazy Init
-    if (!d_mel_filters) {
+    if (!d_mel_bands) {
         initFilters();
     }
 
-    size_t num_samples = inputAudio.size();
-    if (num_samples < N_FFT) {
-        return; // Too short
+    // Pack every input back to back, remembering where each frame starts
+    size_t total_samples = 0;
+    std::vector<long long> h_frame_start;
+    for (size_t j = 0; j < count; ++j) {
+        size_t frames = numFrames(jobs[j].numSamples);
+        for (size_t f = 0; f < frames; ++f) {
+            h_frame_start.push_back((long long)(total_samples + f * HOP_LENGTH));
+        }
+        total_samples += jobs[j].numSamples;
     }
 
-    int num_frames = (num_samples - N_FFT) / HOP_LENGTH + 1;
-    if (num_frames <= 0) return;
+    int num_frames = (int)h_frame_start.size();
+    if (num_frames == 0) return 0; // Too short
 
     // 2. Allocate Device Memory
     float* d_input;
+    long long* d_frame_start;
     float* d_windowed;
     cufftComplex* d_fft_output;
     float* d_mel_output;
 
-    checkCuda(cudaMalloc(&d_input, num_samples * sizeof(float)), "Malloc Input");
-    checkCuda(cudaMemcpy(d_input, inputAudio.data(), num_samples * sizeof(float), cudaMemcpyHostToDevice), "Memcpy Input");
+    checkCuda(cudaMalloc(&d_input, total_samples * sizeof(float)), "Malloc Input");
+    size_t offset = 0;
+    for (size_t j = 0; j < count; ++j) {
+        checkCuda(cudaMemcpy(d_input + offset, jobs[j].audio, jobs[j].numSamples * sizeof(float), cudaMemcpyHostToDevice), "Memcpy Input");
+        offset += jobs[j].numSamples;
+    }
+    checkCuda(cudaMalloc(&d_frame_start, num_frames * sizeof(long long)), "Malloc Frame Starts");
+    checkCuda(cudaMemcpy(d_frame_start, h_frame_start.data(), num_frames * sizeof(long long), cudaMemcpyHostToDevice), "Memcpy Frame Starts");
 
     checkCuda(cudaMalloc(&d_windowed, num_frames * N_FFT * sizeof(float)), "Malloc Windowed");
     checkCuda(cudaMalloc(&d_fft_output, num_frames * N_FFT_HALF * sizeof(cufftComplex)), "Malloc FFT Output"); // R2C
@@ -168,10 +149,10 @@ void AudioWorker::computeMelSpectrogram(const std::vector<float>& inputAudio, st
     // 3. Apply Window
     int threadsPerBlock = 256;
     int blocks = (num_frames * N_FFT + threadsPerBlock - 1) / threadsPerBlock;
-    applyWindowKernel<<<blocks, threadsPerBlock>>>(d_input, d_windowed, d_hann_window, num_frames);
+    applyWindowBatchKernel<<<blocks, threadsPerBlock>>>(d_input, d_frame_start, d_windowed, d_hann_window, num_frames);
     checkCuda(cudaGetLastError(), "Window Kernel Launch");
 
-    // 4. Compute FFT (Batch R2C)
+    // 4. Compute FFT (Batch R2C over the frames of every input)
     cufftHandle plan;
     checkCufft(cufftPlan1d(&plan, N_FFT, CUFFT_R2C, num_frames), "Plan Creation");
     checkCufft(cufftExecR2C(plan, d_windowed, d_fft_output), "FFT Execution");
@@ -179,21 +160,28 @@ void AudioWorker::computeMelSpectrogram(const std::vector<float>& inputAudio, st
 
     // 5. Mel Filterbank & Log
     // One block per frame, 80 threads per block (one per mel bin)
-    magnitudeAndMelKernel<<<num_frames, N_MELS>>>(d_fft_output, d_mel_output, d_mel_filters, num_frames);
+    magnitudeAndMelKernel<<<num_frames, N_MELS>>>(d_fft_output, d_mel_output, d_mel_bands, d_mel_weights, num_frames);
     checkCuda(cudaGetLastError(), "Mel Kernel Launch");
 
-    // 6. Copy Back
-    outputMel.resize(num_frames * N_MELS);
-    checkCuda(cudaMemcpy(outputMel.data(), d_mel_output, num_frames * N_MELS * sizeof(float), cudaMemcpyDeviceToHost), "Memcpy Output");
+    // 6. Scatter back (straight into each caller's buffer, usually SHM response blocks)
+    size_t frame_offset = 0;
+    for (size_t j = 0; j < count; ++j) {
+        size_t frames = numFrames(jobs[j].numSamples);
+        if (frames == 0) continue;
+        checkCuda(cudaMemcpy(jobs[j].outMel, d_mel_output + frame_offset * N_MELS, frames * N_MELS * sizeof(float), cudaMemcpyDeviceToHost), "Memcpy Output");
+        frame_offset += frames;
+    }
 
     // 7. Cleanup
     cudaFree(d_input);
+    cudaFree(d_frame_start);
     cudaFree(d_windowed);
     cudaFree(d_fft_output);
     cudaFree(d_mel_output);
     
     // Optional: Synchronize to ensure all done
     cudaDeviceSynchronize();
+    return num_frames;
 }
 
 }}
@@ -7,7 +7,11 @@
 #include <iostream>
 #include <cstring>
 #include <thread>
+#include <chrono>
 #include <new>
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
 
 namespace app { namespace worker {
 
@@ -19,10 +23,50 @@ IPC::~IPC() {
     // We will call cleanup explicitly.
 }
 
-void IPC::initHost() {
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+void IPC::attachLayout() {
+    uint8_t* base = reinterpret_cast<uint8_t*>(m_shm);
+    for (uint32_t p = 0; p < NUM_PRIORITIES; ++p) {
+        m_reqRings[p].attach(&m_shm->req_rings[p], base + m_shm->req_ring_offsets[p], m_shm->ring_capacity);
+    }
+    m_respRing.attach(&m_shm->resp_ring, base + m_shm->resp_ring_offset, m_shm->ring_capacity);
+    m_arena.attach(&m_shm->arena, reinterpret_cast<uint8_t*>(m_shm) + m_shm->arena_offset, m_shm->arena_size);
+}
+
+void IPC::initHost(const IpcConfig& config) {
     m_isHost = true;
     OATPP_LOGD("IPC", "Initializing Host...");
 
+    // 0. Layout: header | req rings (one per priority) | resp ring | payload arena
+    size_t ringCapacity = 2;
+    while (ringCapacity < config.ringCapacity) {
+        ringCapacity <<= 1;
+    }
+    if (config.maxPayloadBytes > config.arenaBytes ||
+        PayloadArena::sizeClassFor(config.maxPayloadBytes) >= ARENA_NUM_CLASSES) {
+        throw std::runtime_error("Invalid IPC config: max payload does not fit the arena");
+    }
+    if (config.arenaBytes / ARENA_ALIGN >= NO_PAYLOAD) {
+        throw std::runtime_error("Invalid IPC config: arena too large");
+    }
+
+    size_t reqRingOffsets[NUM_PRIORITIES];
+    size_t offset = alignUp(sizeof(SharedMem), CACHE_LINE_SIZE);
+    for (uint32_t p = 0; p < NUM_PRIORITIES; ++p) {
+        reqRingOffsets[p] = offset;
+        offset = alignUp(offset + MpmcRing<ReqSlot>::bytesFor(ringCapacity), CACHE_LINE_SIZE);
+    }
+    size_t respRingOffset = offset;
+    size_t arenaOffset = alignUp(respRingOffset + MpmcRing<RespSlot>::bytesFor(ringCapacity), 4096);
+    m_mapSize = arenaOffset + config.arenaBytes;
+
     // 1. Cleanup old
     shm_unlink(SHM_NAME);
     sem_unlink(SEM_REQ_NAME);
@@ -34,21 +78,41 @@ void IPC::initHost() {
         throw std::runtime_error("Failed to shm_open");
     }
 
-    if (ftruncate(m_shmFd, sizeof(SharedMem)) == -1) {
+    if (ftruncate(m_shmFd, m_mapSize) == -1) {
         throw std::runtime_error("Failed to ftruncate");
     }
 
-    void* addr = mmap(NULL, sizeof(SharedMem), PROT_READ | PROT_WRITE, MAP_SHARED, m_shmFd, 0);
+    void* addr = mmap(NULL, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_shmFd, 0);
     if (addr == MAP_FAILED) {
         throw std::runtime_error("Failed to mmap");
     }
 
     m_shm = new (addr) SharedMem(); // Placement new to initialize atomics
-    // Reset indices
-    m_shm->req_write_idx = 0;
-    m_shm->req_read_idx = 0;
-    m_shm->resp_write_idx = 0;
-    m_shm->resp_read_idx = 0;
+    m_shm->total_size = m_mapSize;
+    m_shm->ring_capacity = (uint32_t)ringCapacity;
+    m_shm->batch_max = std::max<uint32_t>(config.batchMax, 1);
+    m_shm->batch_linger_us = config.batchLingerUs;
+    m_shm->trace_sample_every = config.traceSampleEvery;
+    m_shm->feature_cache.max_bytes = std::min(config.featureCacheBytes, config.arenaBytes / 4);
+    m_shm->max_payload_bytes = config.maxPayloadBytes;
+    for (uint32_t p = 0; p < NUM_PRIORITIES; ++p) {
+        m_shm->req_ring_offsets[p] = reqRingOffsets[p];
+        m_shm->priority_weights[p] = std::max<uint32_t>(config.priorityWeights[p], 1);
+    }
+    m_shm->resp_ring_offset = respRingOffset;
+    m_shm->arena_offset = arenaOffset;
+    m_shm->arena_size = config.arenaBytes;
+
+    attachLayout();
+    for (auto& ring : m_reqRings) {
+        ring.format();
+    }
+    m_respRing.format();
+    m_arena.format();
+
+    // Publish last: a worker that sees the magic sees a complete header
+    std::atomic_thread_fence(std::memory_order_release);
+    m_shm->magic = SHM_MAGIC;
 
     // 3. Create Semaphores
     m_semReq = sem_open(SEM_REQ_NAME, O_CREAT, 0666, 0);
@@ -60,7 +124,8 @@ void IPC::initHost() {
         throw std::runtime_error("Failed to create resp semaphore");
     }
     
-    OATPP_LOGD("IPC", "Host Initialized. SHM Size: %lu", sizeof(SharedMem));
+    OATPP_LOGD("IPC", "Host Initialized. SHM Size: %lu (ring capacity %lu, arena %lu bytes)",
+               (unsigned long)m_mapSize, (unsigned long)ringCapacity, (unsigned long)config.arenaBytes);
 }
 
 void IPC::initWorker() {
@@ -73,12 +138,23 @@ void IPC::initWorker() {
         throw std::runtime_error("Failed to shm_open (worker)");
     }
 
-    void* addr = mmap(NULL, sizeof(SharedMem), PROT_READ | PROT_WRITE, MAP_SHARED, m_shmFd, 0);
+    struct stat st;
+    if (fstat(m_shmFd, &st) == -1 || (size_t)st.st_size < sizeof(SharedMem)) {
+        throw std::runtime_error("Failed to stat SHM (worker)");
+    }
+    m_mapSize = st.st_size;
+
+    void* addr = mmap(NULL, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_shmFd, 0);
     if (addr == MAP_FAILED) {
         throw std::runtime_error("Failed to mmap (worker)");
     }
 
     m_shm = static_cast<SharedMem*>(addr);
+    if (m_shm->magic != SHM_MAGIC || m_shm->total_size != m_mapSize) {
+        throw std::runtime_error("SHM layout mismatch (worker)");
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    attachLayout();
 
     // 2. Open Semaphores
     m_semReq = sem_open(SEM_REQ_NAME, 0);
@@ -104,8 +180,13 @@ void IPC::cleanup() {
     }
 
     if (m_shm && m_shm != MAP_FAILED) {
-        munmap(m_shm, sizeof(SharedMem));
+        munmap(m_shm, m_mapSize);
         m_shm = nullptr;
+        for (auto& ring : m_reqRings) {
+            ring.attach(nullptr, nullptr, 0);
+        }
+        m_respRing.attach(nullptr, nullptr, 0);
+        m_arena.attach(nullptr, nullptr, 0);
     }
 
     if (m_shmFd != -1) {
@@ -123,18 +204,10 @@ void IPC::cleanup() {
 bool IPC::submitRequest(const ReqSlot& req) {
     if (!m_shm) return false;
 
-    size_t writeIdx = m_shm->req_write_idx.load(std::memory_order_relaxed);
-    size_t readIdx = m_shm->req_read_idx.load(std::memory_order_acquire);
-
-    if (writeIdx - readIdx >= RING_CAP) {
+    if (req.priority >= NUM_PRIORITIES || !m_reqRings[req.priority].tryPush(req)) {
         return false; // Full
     }
 
-    m_shm->req_ring[writeIdx % RING_CAP] = req;
-    
-    std::atomic_thread_fence(std::memory_order_release);
-    m_shm->req_write_idx.store(writeIdx + 1, std::memory_order_release);
-    
     sem_post(m_semReq);
     return true;
 }
@@ -146,28 +219,78 @@ bool IPC::waitForRequest(ReqSlot& req) {
         return false;
     }
 
-    size_t idx = m_shm->req_read_idx.fetch_add(1, std::memory_order_acq_rel);
-    req = m_shm->req_ring[idx % RING_CAP];
+    popScheduled(req);
+    return true;
+}
+
+bool IPC::pollRequest(ReqSlot& req, std::chrono::microseconds timeout) {
+    if (!m_shm || !m_semReq) return false;
+
+    if (timeout.count() <= 0) {
+        if (sem_trywait(m_semReq) != 0) return false;
+    } else {
+#if defined(__APPLE__)
+        // No sem_timedwait on macOS: poll
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (sem_trywait(m_semReq) != 0) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+#else
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        long long ns = ts.tv_nsec + std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+        ts.tv_sec += ns / 1000000000LL;
+        ts.tv_nsec = ns % 1000000000LL;
+        int rc;
+        while ((rc = sem_timedwait(m_semReq, &ts)) != 0 && errno == EINTR) {}
+        if (rc != 0) return false;
+#endif
+    }
+
+    popScheduled(req);
     return true;
 }
 
+void IPC::popScheduled(ReqSlot& req) {
+    // Smooth weighted round-robin (as in nginx) over the non-empty rings: every class
+    // with work gets at least weight / sum of weights of the picks, interleaved evenly.
+    for (;;) {
+        int64_t total = 0;
+        int best = -1;
+        for (uint32_t p = 0; p < NUM_PRIORITIES; ++p) {
+            if (m_reqRings[p].size() == 0) continue;
+            m_credit[p] += m_shm->priority_weights[p];
+            total += m_shm->priority_weights[p];
+            if (best < 0 || m_credit[p] > m_credit[best]) {
+                best = (int)p;
+            }
+        }
+        if (best >= 0) {
+            m_credit[best] -= total;
+            if (m_reqRings[best].tryPop(req)) {
+                return;
+            }
+        }
+        // The semaphore guarantees an item, but a producer that claimed a cell may
+        // not have published it yet, or another worker beat us to it: look again.
+        for (auto& ring : m_reqRings) {
+            if (ring.tryPop(req)) {
+                return;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
 bool IPC::submitResponse(const RespSlot& resp) {
     if (!m_shm) return false;
 
-    // Response queue is also MPSC (Multi-Producer Single-Consumer) because multiple workers write?
-    // Actually yes. So workers need to atomic_fetch_add the write_idx.
-    
-    size_t writeIdx = m_shm->resp_write_idx.fetch_add(1, std::memory_order_acq_rel);
-    
-    // Check overflow?
-    // Ideally we shouldn't have more responses than requests, so if req queue isn't overflowing, 
-    // resp queue shouldn't either, provided server drains it.
-    // However, if server is slow, we might overwrite.
-    // For now, let's assume server is fast enough or RING_CAP is large enough.
-    // A robust impl would check read_idx.
-    
-    m_shm->resp_ring[writeIdx % RING_CAP] = resp;
-    
+    // Never drop a response: the host thread is always draining, so a full ring is transient.
+    while (!m_respRing.tryPush(resp)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
     sem_post(m_semResp);
     return true;
 }
@@ -181,11 +304,9 @@ bool IPC::waitForResponse(RespSlot& resp, bool blocking) {
         if (sem_trywait(m_semResp) != 0) return false;
     }
 
-    // Single consumer (Server)
-    size_t idx = m_shm->resp_read_idx.load(std::memory_order_relaxed);
-    resp = m_shm->resp_ring[idx % RING_CAP];
-    m_shm->resp_read_idx.store(idx + 1, std::memory_order_release);
-    
+    while (!m_respRing.tryPop(resp)) {
+        std::this_thread::yield();
+    }
     return true;
 }
 
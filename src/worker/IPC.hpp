@@ -2,9 +2,11 @@
 #define WORKER_IPC_HPP
 
 #include "SharedMemoryStructs.hpp"
+#include "PayloadArena.hpp"
 #include <string>
 #include <semaphore.h>
 #include <optional>
+#include <chrono>
 
 namespace app { namespace worker {
 
@@ -12,40 +14,86 @@ class IPC {
 private:
     int m_shmFd = -1;
     SharedMem* m_shm = nullptr;
+    size_t m_mapSize = 0;
+    MpmcRing<ReqSlot> m_reqRings[NUM_PRIORITIES];
+    MpmcRing<RespSlot> m_respRing;
+    PayloadArena m_arena;
     sem_t* m_semReq = nullptr;
     sem_t* m_semResp = nullptr;
     bool m_isHost = false;
+    int64_t m_credit[NUM_PRIORITIES] = {};   // worker-local weighted round-robin state
+
+    void attachLayout();
+    void popScheduled(ReqSlot& req);
 
 public:
     IPC();
     ~IPC();
 
     // Initialize as the Host (Server). Creates SHM and Semaphores.
-    void initHost();
+    // Ring capacity and arena size come from config.
+    void initHost(const IpcConfig& config = IpcConfig());
 
-    // Initialize as a Worker. Attaches to existing SHM and Semaphores.
+    // Initialize as a Worker. Attaches to existing SHM and Semaphores,
+    // layout is read from the SHM header.
     void initWorker();
 
     void cleanup();
 
     // --- Request Queue Operations ---
     
-    // For Host to send work
+    // For Host to send work, into the ring of req.priority. Safe from any number of
+    // threads; returns false when that ring is full.
     bool submitRequest(const ReqSlot& req);
     
-    // For Worker to get work (blocking or non-blocking)
+    // For Worker to get work (blocking). One semaphore counts the requests in all rings;
+    // which ring a request is taken from follows the priority weights.
     // Returns true if a request was retrieved
     bool waitForRequest(ReqSlot& req);
 
+    // For Worker batching: waits at most timeout (0 = only if one is already queued)
+    bool pollRequest(ReqSlot& req, std::chrono::microseconds timeout);
+
+    // Batching knobs the host published in the header
+    uint32_t batchMax() const { return m_shm ? m_shm->batch_max : 1; }
+    std::chrono::microseconds batchLinger() const {
+        return std::chrono::microseconds(m_shm ? m_shm->batch_linger_us : 0);
+    }
+
+    // Requests waiting in one priority class's ring
+    size_t requestDepth(TaskPriority priority) const { return m_reqRings[priority].size(); }
+    // Responses the host hasn't picked up yet
+    size_t responseDepth() const { return m_respRing.size(); }
+    uint32_t ringCapacity() const { return m_shm ? m_shm->ring_capacity : 0; }
+
     // --- Response Queue Operations ---
 
-    // For Worker to send result
+    // For Worker to send result. Waits for room rather than dropping the response.
     bool submitResponse(const RespSlot& resp);
 
     // For Host to get result
     // Returns true if a response was retrieved
     bool waitForResponse(RespSlot& resp, bool blocking = true);
 
+    // --- Payload Arena ---
+
+    PayloadArena& arena() { return m_arena; }
+
+    template<typename T>
+    T* payloadAs(const PayloadRef& ref) const {
+        return static_cast<T*>(m_arena.data(ref));
+    }
+
+    // --- Cancellation (SharedMem::cancelled) ---
+
+    std::atomic<uint64_t>* cancelFlags() const { return m_shm ? m_shm->cancelled : nullptr; }
+
+    bool isCancelled(uint64_t taskId) const {
+        return m_shm && m_shm->cancelled[taskId & (CANCEL_SLOTS - 1)].load(std::memory_order_relaxed) == taskId;
+    }
+
+    uint64_t maxPayloadBytes() const { return m_shm ? m_shm->max_payload_bytes : 0; }
+
     SharedMem* getMemory() const { return m_shm; }
 };
 
@@ -0,0 +1,103 @@
+#ifndef WORKER_LATENCY_HISTOGRAM_HPP
+#define WORKER_LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace app { namespace worker {
+
+/**
+ * Lock-free log-linear (HDR-style) histogram of nanosecond durations.
+ *
+ * Every power of two is split into 2^SubBits buckets, so any value is off by at most
+ * 1/2^SubBits of itself, from 1 ns up to the full uint64_t range. Recording is
+ * one relaxed fetch_add; there are no pointers, so it works the same in SHM
+ * (written by any number of worker processes) as in host memory. All zero is
+ * the empty histogram.
+ */
+template<uint32_t SubBits>
+struct BasicLatencyHistogram {
+    static constexpr uint32_t SUB_BITS = SubBits;
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BITS;
+    static constexpr uint32_t BUCKETS = (64 - SUB_BITS + 1) << SUB_BITS;
+
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> sum_ns;
+
+    static uint32_t bucketOf(uint64_t ns) {
+        if (ns < SUB_BUCKETS) {
+            return (uint32_t)ns;
+        }
+        uint32_t exponent = 63 - (uint32_t)__builtin_clzll(ns);
+        uint32_t shift = exponent - SUB_BITS;
+        return ((shift + 1) << SUB_BITS) | (uint32_t)((ns >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    // Smallest value that lands in `bucket`
+    static uint64_t lowerBound(uint32_t bucket) {
+        uint32_t group = bucket >> SUB_BITS;
+        uint64_t sub = bucket & (SUB_BUCKETS - 1);
+        if (group == 0) {
+            return sub;
+        }
+        return (SUB_BUCKETS + sub) << (group - 1);
+    }
+
+    // Largest value that lands in `bucket`
+    static uint64_t upperBound(uint32_t bucket) {
+        return bucket + 1 < BUCKETS ? lowerBound(bucket + 1) - 1 : UINT64_MAX;
+    }
+
+    void record(uint64_t ns) {
+        counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    /**
+     * Copy of the counts at one moment. Writers don't stop for it, so count()
+     * is taken from the copied buckets rather than kept separately: the
+     * snapshot is always consistent with itself.
+     */
+    struct Snapshot {
+        uint64_t counts[BUCKETS];
+        uint64_t count = 0;
+        uint64_t sumNs = 0;
+
+        // Samples in buckets that end at or below ns (exact on bucket edges, else under by < 1/2^SubBits)
+        uint64_t countAtOrBelow(uint64_t ns) const {
+            uint64_t total = 0;
+            for (uint32_t b = 0; b < BUCKETS && upperBound(b) <= ns; ++b) {
+                total += counts[b];
+            }
+            return total;
+        }
+
+        // Upper bound of the bucket holding the q-th sample (0 when empty)
+        uint64_t quantile(double q) const {
+            if (count == 0) return 0;
+            uint64_t rank = (uint64_t)(q * (double)(count - 1)) + 1;
+            uint64_t seen = 0;
+            for (uint32_t b = 0; b < BUCKETS; ++b) {
+                seen += counts[b];
+                if (seen >= rank) return upperBound(b);
+            }
+            return UINT64_MAX;
+        }
+    };
+
+    void snapshot(Snapshot& out) const {
+        out.count = 0;
+        for (uint32_t b = 0; b < BUCKETS; ++b) {
+            out.counts[b] = counts[b].load(std::memory_order_relaxed);
+            out.count += out.counts[b];
+        }
+        out.sumNs = sum_ns.load(std::memory_order_relaxed);
+    }
+};
+
+// 8 buckets per power of two (within 1/8), ~4 KB: what the server and workers record
+typedef BasicLatencyHistogram<3> LatencyHistogram;
+
+}}
+
+#endif
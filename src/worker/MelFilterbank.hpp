@@ -0,0 +1,154 @@
+#ifndef WORKER_MEL_FILTERBANK_HPP
+#define WORKER_MEL_FILTERBANK_HPP
+
+#include "AudioParams.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace app { namespace worker {
+
+/**
+ * Slaney mel filterbank, bit-for-bit what librosa.filters.mel(sr=16000, n_fft=400, n_mels=80)
+ * produces up to float rounding (that is the matrix Whisper ships in mel_filters.npz).
+ *
+ * Built at compile time and stored sparsely: each band is a contiguous run of
+ * non-zero weights, so band m is weights[offset .. offset + length) applied to
+ * power bins [start .. start + length).
+ */
+struct MelBand {
+    uint16_t start;
+    uint16_t length;
+    uint32_t offset;
+};
+
+template<size_t NNZ>
+struct SparseMelFilterbank {
+    MelBand bands[N_MELS];
+    float weights[NNZ];
+};
+
+namespace detail {
+
+// <cmath> isn't constexpr, so the filterbank brings its own log/exp.
+constexpr double LN2 = 0.693147180559945309417232121458;
+
+constexpr double constLog(double x) {
+    // x = m * 2^k, m in [1, 2)
+    int k = 0;
+    while (x >= 2.0) { x /= 2.0; ++k; }
+    while (x < 1.0) { x *= 2.0; --k; }
+    // ln(m) = 2 * atanh((m - 1) / (m + 1))
+    double t = (x - 1.0) / (x + 1.0);
+    double t2 = t * t;
+    double term = t;
+    double sum = 0.0;
+    for (int n = 1; n < 60; n += 2) {
+        sum += term / n;
+        term *= t2;
+    }
+    return 2.0 * sum + k * LN2;
+}
+
+constexpr double constExp(double x) {
+    // x = k * ln2 + r, |r| <= ln2 / 2
+    int k = (int)(x / LN2 + (x < 0 ? -0.5 : 0.5));
+    double r = x - k * LN2;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 30; ++n) {
+        term *= r / n;
+        sum += term;
+    }
+    while (k > 0) { sum *= 2.0; --k; }
+    while (k < 0) { sum /= 2.0; ++k; }
+    return sum;
+}
+
+constexpr double F_SP = 200.0 / 3.0;
+constexpr double MIN_LOG_HZ = 1000.0;
+constexpr double MIN_LOG_MEL = MIN_LOG_HZ / F_SP;
+
+constexpr double logStep() {
+    return constLog(6.4) / 27.0;
+}
+
+constexpr double hzToMel(double hz) {
+    return hz >= MIN_LOG_HZ ? MIN_LOG_MEL + constLog(hz / MIN_LOG_HZ) / logStep() : hz / F_SP;
+}
+
+constexpr double melToHz(double mel) {
+    return mel >= MIN_LOG_MEL ? MIN_LOG_HZ * constExp(logStep() * (mel - MIN_LOG_MEL)) : mel * F_SP;
+}
+
+struct MelEdges {
+    double hz[N_MELS + 2];
+};
+
+constexpr MelEdges melEdges() {
+    MelEdges edges{};
+    double melMax = hzToMel(SAMPLE_RATE / 2.0);
+    for (int i = 0; i < N_MELS + 2; ++i) {
+        edges.hz[i] = melToHz(melMax * i / (N_MELS + 1));
+    }
+    return edges;
+}
+
+constexpr MelEdges MEL_EDGES = melEdges();
+
+// Triangle weight of FFT bin k in band m, slaney-normalized (area 1 in Hz).
+constexpr float weight(int m, int k) {
+    double lower = MEL_EDGES.hz[m];
+    double centre = MEL_EDGES.hz[m + 1];
+    double upper = MEL_EDGES.hz[m + 2];
+    double freq = (double)k * SAMPLE_RATE / N_FFT;
+    double rising = (freq - lower) / (centre - lower);
+    double falling = (upper - freq) / (upper - centre);
+    double w = rising < falling ? rising : falling;
+    if (w <= 0.0) return 0.0f;
+    return (float)(w * 2.0 / (upper - lower));
+}
+
+constexpr size_t countNonZero() {
+    size_t count = 0;
+    for (int m = 0; m < N_MELS; ++m) {
+        for (int k = 0; k < N_FFT_HALF; ++k) {
+            if (weight(m, k) > 0.0f) ++count;
+        }
+    }
+    return count;
+}
+
+template<size_t NNZ>
+constexpr SparseMelFilterbank<NNZ> buildFilterbank() {
+    SparseMelFilterbank<NNZ> fb{};
+    uint32_t offset = 0;
+    for (int m = 0; m < N_MELS; ++m) {
+        int start = -1;
+        int end = 0;
+        for (int k = 0; k < N_FFT_HALF; ++k) {
+            if (weight(m, k) > 0.0f) {
+                if (start < 0) start = k;
+                end = k + 1;
+            }
+        }
+        if (start < 0) {
+            // Empty band: nothing above the floor, log10 yields the floor value
+            fb.bands[m] = { 0, 0, offset };
+            continue;
+        }
+        fb.bands[m] = { (uint16_t)start, (uint16_t)(end - start), offset };
+        for (int k = start; k < end; ++k) {
+            fb.weights[offset++] = weight(m, k);
+        }
+    }
+    return fb;
+}
+
+}
+
+constexpr size_t MEL_FILTER_NNZ = detail::countNonZero();
+constexpr SparseMelFilterbank<MEL_FILTER_NNZ> MEL_FILTERBANK = detail::buildFilterbank<MEL_FILTER_NNZ>();
+
+}}
+
+#endif
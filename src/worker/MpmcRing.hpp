@@ -0,0 +1,127 @@
+#ifndef WORKER_MPMC_RING_HPP
+#define WORKER_MPMC_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace app { namespace worker {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "ring positions are shared between processes and must be lock-free");
+
+/**
+ * Producer and consumer positions of one ring, each on its own cache line so
+ * producers bumping enqueue_pos don't keep invalidating the consumers' line.
+ * Lives in SHM.
+ */
+struct RingHeader {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> enqueue_pos;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> dequeue_pos;
+};
+
+template<typename T>
+struct RingCell {
+    std::atomic<uint64_t> sequence;
+    T data;
+};
+
+/**
+ * Bounded lock-free MPMC queue (Vyukov) over memory in the SHM segment.
+ *
+ * Each cell carries a sequence number: sequence == pos means the cell is free
+ * for the producer that claims pos, sequence == pos + 1 means it holds the item
+ * for the consumer that claims pos. Producers and consumers claim positions with
+ * a CAS on their own counter and then only touch their cell, so neither side can
+ * overwrite or read a cell the other hasn't finished with.
+ */
+template<typename T>
+class MpmcRing {
+private:
+    RingHeader* m_header = nullptr;
+    RingCell<T>* m_cells = nullptr;
+    uint64_t m_mask = 0;
+
+public:
+    static size_t bytesFor(size_t capacity) {
+        return capacity * sizeof(RingCell<T>);
+    }
+
+    // capacity must be a power of two
+    void attach(RingHeader* header, void* cells, size_t capacity) {
+        m_header = header;
+        m_cells = static_cast<RingCell<T>*>(cells);
+        m_mask = capacity - 1;
+    }
+
+    // Host only, before anyone else attaches.
+    void format() {
+        for (uint64_t i = 0; i <= m_mask; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_header->enqueue_pos.store(0, std::memory_order_relaxed);
+        m_header->dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return (size_t)m_mask + 1; }
+
+    // Returns false when the ring is full.
+    bool tryPush(const T& item) {
+        RingCell<T>* cell;
+        uint64_t pos = m_header->enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)seq - (int64_t)pos;
+            if (diff == 0) {
+                if (m_header->enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // a lap behind: the consumer of this cell hasn't finished yet
+            } else {
+                pos = m_header->enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when the ring is empty (or the oldest claimed cell isn't published yet).
+    bool tryPop(T& item) {
+        RingCell<T>* cell;
+        uint64_t pos = m_header->dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)seq - (int64_t)(pos + 1);
+            if (diff == 0) {
+                if (m_header->dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_header->dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        item = cell->data;
+        // Free the cell for the producer one lap ahead
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate, for gauges only
+    size_t size() const {
+        uint64_t enq = m_header->enqueue_pos.load(std::memory_order_relaxed);
+        uint64_t deq = m_header->dequeue_pos.load(std::memory_order_relaxed);
+        return enq > deq ? (size_t)(enq - deq) : 0;
+    }
+};
+
+}}
+
+#endif
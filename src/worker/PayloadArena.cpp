@@ -0,0 +1,121 @@
+#include "PayloadArena.hpp"
+
+namespace app { namespace worker {
+
+namespace {
+
+inline uint64_t packHead(uint64_t tag, uint32_t block) {
+    return (tag << 32) | block;
+}
+
+inline uint32_t headBlock(uint64_t head) {
+    return (uint32_t)(head & 0xFFFFFFFFULL);
+}
+
+inline uint64_t headTag(uint64_t head) {
+    return head >> 32;
+}
+
+}
+
+void PayloadArena::attach(ArenaHeader* header, void* base, uint64_t size) {
+    m_header = header;
+    m_base = static_cast<uint8_t*>(base);
+    m_size = size;
+}
+
+void PayloadArena::format() {
+    m_header->bump.store(0, std::memory_order_relaxed);
+    m_header->bytes_in_use.store(0, std::memory_order_relaxed);
+    for (uint32_t c = 0; c < ARENA_NUM_CLASSES; ++c) {
+        m_header->free_heads[c].store(packHead(0, NO_PAYLOAD), std::memory_order_relaxed);
+    }
+}
+
+uint32_t PayloadArena::sizeClassFor(size_t bytes) {
+    uint32_t c = 0;
+    size_t blockBytes = ARENA_MIN_BLOCK;
+    while (blockBytes < bytes && c < ARENA_NUM_CLASSES) {
+        blockBytes <<= 1;
+        ++c;
+    }
+    return c;
+}
+
+size_t PayloadArena::classBytes(uint32_t sizeClass) {
+    return ARENA_MIN_BLOCK << sizeClass;
+}
+
+std::atomic<uint32_t>& PayloadArena::nextOf(uint32_t block) const {
+    // A free block stores the index of the next free block in its first word
+    return *reinterpret_cast<std::atomic<uint32_t>*>(m_base + (size_t)block * ARENA_ALIGN);
+}
+
+uint32_t PayloadArena::popFree(uint32_t sizeClass) {
+    auto& headRef = m_header->free_heads[sizeClass];
+    uint64_t head = headRef.load(std::memory_order_acquire);
+    while (headBlock(head) != NO_PAYLOAD) {
+        uint32_t next = nextOf(headBlock(head)).load(std::memory_order_relaxed);
+        // The tag makes a stale 'next' (block popped and pushed back meanwhile) fail the CAS
+        if (headRef.compare_exchange_weak(head, packHead(headTag(head) + 1, next),
+                                          std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return headBlock(head);
+        }
+    }
+    return NO_PAYLOAD;
+}
+
+uint32_t PayloadArena::carve(uint32_t sizeClass) {
+    uint64_t bytes = classBytes(sizeClass);
+    uint64_t offset = m_header->bump.load(std::memory_order_relaxed);
+    do {
+        if (offset + bytes > m_size) {
+            return NO_PAYLOAD;
+        }
+    } while (!m_header->bump.compare_exchange_weak(offset, offset + bytes, std::memory_order_relaxed));
+    return (uint32_t)(offset / ARENA_ALIGN);
+}
+
+PayloadRef PayloadArena::allocate(size_t bytes) {
+    PayloadRef ref;
+    uint32_t sizeClass = sizeClassFor(bytes);
+    if (!m_header || sizeClass >= ARENA_NUM_CLASSES) {
+        return ref;
+    }
+
+    uint32_t block = popFree(sizeClass);
+    if (block == NO_PAYLOAD) {
+        block = carve(sizeClass);
+    }
+    // Arena fully carved: settle for a bigger free block rather than failing
+    for (uint32_t c = sizeClass + 1; block == NO_PAYLOAD && c < ARENA_NUM_CLASSES; ++c) {
+        block = popFree(c);
+        if (block != NO_PAYLOAD) sizeClass = c;
+    }
+    if (block == NO_PAYLOAD) {
+        return ref;
+    }
+
+    ref.block = block;
+    ref.size_class = sizeClass;
+    m_header->bytes_in_use.fetch_add(classBytes(sizeClass), std::memory_order_relaxed);
+    return ref;
+}
+
+void PayloadArena::release(const PayloadRef& ref) {
+    if (!m_header || !ref.valid()) return;
+
+    auto& headRef = m_header->free_heads[ref.size_class];
+    uint64_t head = headRef.load(std::memory_order_relaxed);
+    do {
+        nextOf(ref.block).store(headBlock(head), std::memory_order_relaxed);
+    } while (!headRef.compare_exchange_weak(head, packHead(headTag(head) + 1, ref.block),
+                                            std::memory_order_release, std::memory_order_relaxed));
+    m_header->bytes_in_use.fetch_sub(classBytes(ref.size_class), std::memory_order_relaxed);
+}
+
+uint64_t PayloadArena::bytesInUse() const {
+    return m_header ? m_header->bytes_in_use.load(std::memory_order_relaxed) : 0;
+}
+
+}}
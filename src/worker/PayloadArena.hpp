@@ -0,0 +1,54 @@
+#ifndef WORKER_PAYLOAD_ARENA_HPP
+#define WORKER_PAYLOAD_ARENA_HPP
+
+#include "SharedMemoryStructs.hpp"
+#include <cstddef>
+
+namespace app { namespace worker {
+
+/**
+ * Slab allocator over the SHM payload area, shared by host and workers.
+ *
+ * Blocks come in power-of-two size classes (256 B and up). Freed blocks go
+ * onto a lock-free per-class free list (Treiber stack with an ABA tag); new
+ * blocks are carved from a bump pointer. Blocks are never split or merged,
+ * so a free list only ever holds blocks of its own class.
+ */
+class PayloadArena {
+private:
+    ArenaHeader* m_header = nullptr;
+    uint8_t* m_base = nullptr;
+    uint64_t m_size = 0;
+
+    std::atomic<uint32_t>& nextOf(uint32_t block) const;
+    uint32_t popFree(uint32_t sizeClass);
+    uint32_t carve(uint32_t sizeClass);
+
+public:
+    void attach(ArenaHeader* header, void* base, uint64_t size);
+
+    // Host only, before any worker attaches.
+    void format();
+
+    // ARENA_NUM_CLASSES when bytes is too large for any class
+    static uint32_t sizeClassFor(size_t bytes);
+    static size_t classBytes(uint32_t sizeClass);
+
+    // Returns an invalid ref when the arena is exhausted.
+    PayloadRef allocate(size_t bytes);
+    void release(const PayloadRef& ref);
+
+    void* data(const PayloadRef& ref) const {
+        return m_base + (size_t)ref.block * ARENA_ALIGN;
+    }
+
+    size_t capacityOf(const PayloadRef& ref) const {
+        return classBytes(ref.size_class);
+    }
+
+    uint64_t bytesInUse() const;
+};
+
+}}
+
+#endif
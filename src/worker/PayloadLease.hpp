@@ -0,0 +1,69 @@
+#ifndef WORKER_PAYLOAD_LEASE_HPP
+#define WORKER_PAYLOAD_LEASE_HPP
+
+#include "PayloadArena.hpp"
+#include <utility>
+
+namespace app { namespace worker {
+
+/**
+ * Owning handle to one arena block. Move-only; the block goes back to the
+ * arena when the lease is destroyed, unless ownership was handed to the
+ * other side with detach().
+ */
+class PayloadLease {
+private:
+    PayloadArena* m_arena = nullptr;
+    PayloadRef m_ref;
+
+public:
+    PayloadLease() = default;
+    PayloadLease(PayloadArena* arena, const PayloadRef& ref) : m_arena(arena), m_ref(ref) {}
+
+    PayloadLease(PayloadLease&& other) noexcept
+        : m_arena(other.m_arena)
+        , m_ref(other.detach())
+    {}
+
+    PayloadLease& operator=(PayloadLease&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_arena = other.m_arena;
+            m_ref = other.detach();
+        }
+        return *this;
+    }
+
+    PayloadLease(const PayloadLease&) = delete;
+    PayloadLease& operator=(const PayloadLease&) = delete;
+
+    ~PayloadLease() { reset(); }
+
+    void reset() {
+        if (m_arena && m_ref.valid()) {
+            m_arena->release(m_ref);
+        }
+        m_ref = PayloadRef();
+    }
+
+    // Gives up ownership without releasing (the block now belongs to whoever got the ref)
+    PayloadRef detach() {
+        PayloadRef ref = m_ref;
+        m_ref = PayloadRef();
+        return ref;
+    }
+
+    bool valid() const { return m_arena && m_ref.valid(); }
+    const PayloadRef& ref() const { return m_ref; }
+
+    template<typename T>
+    T* as() const {
+        return valid() ? static_cast<T*>(m_arena->data(m_ref)) : nullptr;
+    }
+
+    size_t capacity() const { return valid() ? m_arena->capacityOf(m_ref) : 0; }
+};
+
+}}
+
+#endif
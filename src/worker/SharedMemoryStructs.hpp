@@ -1,76 +1,258 @@
 #ifndef SharedMemoryStructs_hpp
 #define SharedMemoryStructs_hpp
 
+#include "AudioParams.hpp"
+#include "MpmcRing.hpp"
+#include "LatencyHistogram.hpp"
+#include "Trace.hpp"
 #include <cstdint>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 
 namespace app { namespace worker {
 
-constexpr size_t RING_CAP        = 256;
+// Ring and arena sizes are chosen at startup (IpcConfig); these are the defaults.
+constexpr uint32_t DEFAULT_RING_CAPACITY    = 1024;
+constexpr uint64_t DEFAULT_ARENA_BYTES      = 64ULL << 20;
+// 2 MiB = ~32 s of 16 kHz float audio, enough for a full Whisper window
+constexpr uint64_t DEFAULT_MAX_PAYLOAD_BYTES = 2ULL << 20;
+// Host-side completion table size (tasks in flight at once)
+constexpr size_t   DEFAULT_MAX_IN_FLIGHT    = 8192;
+// Worker micro-batching: audio tasks per mel pass, and how long to wait for
+// the batch to fill. 0 = only batch what is already queued, never add latency.
+constexpr uint32_t DEFAULT_BATCH_MAX        = 8;
+constexpr uint32_t DEFAULT_BATCH_LINGER_US  = 0;
+// How long the host waits for a task before answering 504 (0 = forever)
+constexpr uint64_t DEFAULT_TASK_TIMEOUT_MS  = 30000;
+// Stage tracing: 1 task in N is traced (see /debug/trace), 0 = off
+constexpr uint32_t DEFAULT_TRACE_SAMPLE_EVERY = 100;
+// Arena bytes the mel feature cache may hold (see FeatureCache), 0 = off
+constexpr uint64_t DEFAULT_FEATURE_CACHE_BYTES = 16ULL << 20;
+
+// Request rings, one per priority class (see TaskPriority). Workers pick among the
+// non-empty ones by smooth weighted round-robin, so no class ever starves.
+enum TaskPriority : uint32_t {
+    PRIORITY_INTERACTIVE = 0,   // /process, session appends, live audio
+    PRIORITY_NORMAL = 1,        // /audio/stream
+    PRIORITY_BATCH = 2,         // opted in with X-Priority: batch
+    NUM_PRIORITIES = 3
+};
+constexpr uint32_t DEFAULT_PRIORITY_WEIGHTS[NUM_PRIORITIES] = {8, 4, 1};
+
 constexpr size_t TEXT_CHUNK_SIZE = 4096;
 // Whisper usually takes 16kHz audio.
-// 1 second buffer = 16000 samples.
-// float = 4 bytes. 16000 * 4 = 64KB.
-// This is reasonable for SHM.
-constexpr size_t AUDIO_CHUNK_SIZE = 16000; 
+// Largest single append to a streaming session: 1 second = 16000 samples.
+constexpr size_t AUDIO_CHUNK_SIZE = 16000;
+// A micro-batch stops growing once it holds this much audio: the frame blocks are
+// full by then, and anything more is better left queued for an idle worker.
+constexpr size_t BATCH_MAX_SAMPLES = AUDIO_CHUNK_SIZE;
 constexpr size_t MAX_WORKERS     = 8;
+constexpr size_t MAX_STREAM_SESSIONS = 64;
+// Feature cache entries, in sets of FEATURE_CACHE_WAYS (a key can only live in its own set)
+constexpr uint32_t FEATURE_CACHE_SLOTS = 1024;
+constexpr uint32_t FEATURE_CACHE_WAYS = 8;
+constexpr uint32_t FEATURE_CACHE_SETS = FEATURE_CACHE_SLOTS / FEATURE_CACHE_WAYS;
+// Cancellation flags, indexed by the low bits of the task id (see SharedMem::cancelled)
+constexpr size_t CANCEL_SLOTS = 8192;
+// TASK_AUDIO_STREAM payloads leave this many floats free in front of the samples,
+// so the worker can prepend the session carry in place instead of copying the chunk.
+constexpr size_t STREAM_PAYLOAD_HEADROOM = N_FFT;
+// Sessions untouched for this long may be reclaimed when the table is full.
+constexpr uint64_t STREAM_SESSION_IDLE_NS = 60ULL * 1000 * 1000 * 1000;
 constexpr char SHM_NAME[]        = "/oatpp_whisper_shm";
 constexpr char SEM_REQ_NAME[]    = "/oatpp_whisper_sem_req";
 constexpr char SEM_RESP_NAME[]   = "/oatpp_whisper_sem_resp";
 
+constexpr uint64_t SHM_MAGIC = 0x5748535052494E47ULL; // "WHSPRING"
+
+// Payload arena: power-of-two size classes from ARENA_MIN_BLOCK bytes up.
+constexpr size_t   ARENA_ALIGN       = 64;
+constexpr size_t   ARENA_MIN_BLOCK   = 256;
+constexpr uint32_t ARENA_NUM_CLASSES = 24;   // 256 B .. 2 GiB
+constexpr uint32_t NO_PAYLOAD        = 0xFFFFFFFF;
+
+struct IpcConfig {
+    uint32_t ringCapacity = DEFAULT_RING_CAPACITY;      // rounded up to a power of two
+    uint64_t arenaBytes = DEFAULT_ARENA_BYTES;
+    uint64_t maxPayloadBytes = DEFAULT_MAX_PAYLOAD_BYTES;
+    uint32_t batchMax = DEFAULT_BATCH_MAX;               // 1 disables batching
+    uint32_t batchLingerUs = DEFAULT_BATCH_LINGER_US;
+    uint32_t priorityWeights[NUM_PRIORITIES] = {DEFAULT_PRIORITY_WEIGHTS[0], DEFAULT_PRIORITY_WEIGHTS[1],
+                                                DEFAULT_PRIORITY_WEIGHTS[2]};
+    uint32_t traceSampleEvery = DEFAULT_TRACE_SAMPLE_EVERY;
+    uint64_t featureCacheBytes = DEFAULT_FEATURE_CACHE_BYTES;   // capped at a quarter of the arena
+};
+
 enum TaskType : uint32_t {
     TASK_TEXT_PROCESS = 0,
     TASK_AUDIO_PROCESS = 1,
+    TASK_AUDIO_STREAM = 2,   // append to a StreamSession, returns only newly completed frames
     TASK_SHUTDOWN = 99
 };
+// Task types with metrics (SharedMem::task_metrics), indexed by TaskType
+constexpr uint32_t NUM_TASK_TYPES = 3;
 
+// Handle to a block in the payload arena. block is in ARENA_ALIGN units.
+struct PayloadRef {
+    uint32_t block = NO_PAYLOAD;
+    uint32_t size_class = 0;
+
+    bool valid() const { return block != NO_PAYLOAD; }
+};
+
+// 128-bit hash of a task's input samples and the STFT / mel parameters (FeatureCache::keyOf)
+struct FeatureKey {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    explicit operator bool() const { return lo != 0 || hi != 0; }
+    bool operator==(const FeatureKey& other) const { return lo == other.lo && hi == other.hi; }
+};
+
+// Ring entries are small descriptors; the data itself sits in the payload arena.
 struct ReqSlot {
     uint64_t  task_id;
     TaskType  type;
-    uint32_t  len;
-    uint64_t  enqueue_timestamp_ns;  // for latency tracking
-    union {
-        char  text_data[TEXT_CHUNK_SIZE];
-        struct {
-            uint32_t sample_rate;
-            uint32_t num_samples;
-            float    audio_data[AUDIO_CHUNK_SIZE];
-        } audio;
-    };
+    uint32_t  len;                   // text: bytes, audio: samples
+    TaskPriority priority;           // which request ring it goes through
+    uint64_t  enqueue_timestamp_ns;  // monotonicNowNs(), for latency tracking
+    uint64_t  deadline_ns;           // monotonicNowNs() after which nobody waits for it, 0 = none
+    PayloadRef payload;              // char[len], float[len] or float[STREAM_PAYLOAD_HEADROOM + len]
+    FeatureKey cache_key;            // TASK_AUDIO_PROCESS: store the features under this key, empty = don't
+    struct {
+        uint32_t sample_rate;
+        uint32_t session_slot;   // TASK_AUDIO_STREAM only
+        uint64_t session_id;     // TASK_AUDIO_STREAM only, must match stream_sessions[session_slot]
+    } audio;
 };
 
 struct RespSlot {
     uint64_t  task_id;
     TaskType  type;
-    uint32_t  len;
-    uint32_t  status_code; // 0 = success
+    uint32_t  len;                 // text: bytes, audio: floats (80 mels * frames)
+    uint32_t  status_code;         // 0 = success
+    uint32_t  batch_size;          // tasks that shared the mel pass (and processing_time_ns)
     uint64_t  processing_time_ns;  // worker processing time
-    union {
-        char  text_result[TEXT_CHUNK_SIZE];
-        // Mel spectrogram: 80 mels * frames.
-        // If we process 1 sec of audio (16000 samples)
-        // Hop length 160 => 100 frames.
-        // 80 * 100 = 8000 floats.
-        float mel_features[80 * 100];
-    };
+    uint64_t  queue_time_ns;       // enqueue -> dequeue
+    TaskPriority priority;         // copied from the request
+    uint32_t  session_slot;        // TASK_AUDIO_STREAM: copied from the request, released on arrival
+    uint64_t  reply_timestamp_ns;  // monotonicNowNs() when the worker pushed it
+    PayloadRef payload;            // owned by the receiver, release once consumed
+    FeatureKey cache_key;          // copied from the request: features are in the cache by now
 };
 
+// Shared clock for deadlines: CLOCK_MONOTONIC, the same in the host and every worker
+inline uint64_t monotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+enum SessionState : uint32_t {
+    SESSION_FREE = 0,
+    SESSION_IDLE = 1,   // open, no append in flight
+    SESSION_BUSY = 2    // an append is queued or being computed
+};
+
+// Streaming STFT state. Lives in SHM so whichever worker picks up the next
+// append can continue where the previous one stopped.
+struct StreamSession {
+    std::atomic<uint32_t> state;
+    uint32_t carry_len;        // samples not yet covered by a full hop (< N_FFT)
+    std::atomic<uint64_t> session_id;
+    uint64_t frames_emitted;
+    uint64_t last_used_ns;
+    float    carry[N_FFT];
+};
+
+// Per worker process, at the slot the host passed on its command line (--worker <slot>).
+// Counters only ever grow, so a slot can be handed to a new process without resetting it.
+struct WorkerSlot {
+    std::atomic<uint64_t> busy_ns;   // time spent computing tasks
+    std::atomic<uint64_t> tasks;     // tasks computed (a batch counts each of its tasks)
+};
+
+// Per task type, recorded by the worker that answers it (see /metrics)
+struct TaskMetrics {
+    LatencyHistogram queue_wait;   // enqueue -> dequeue
+    LatencyHistogram compute;      // worker processing time (a batch's whole pass)
+    std::atomic<uint64_t> failed;  // answered with a non-zero status
+    std::atomic<uint64_t> skipped; // cancelled or expired before a worker got to it
+};
+
+// One cached result: float[len] mel features in an arena block the cache owns. len 0 = empty.
+struct FeatureCacheEntry {
+    std::atomic<uint32_t> lock;         // readers copying out, or the writer bit
+    std::atomic<uint32_t> referenced;   // CLOCK bit, set by every hit
+    std::atomic<uint64_t> claim;        // set from before the key is stored until eviction (see FeatureCache::insert), 0 = none
+    FeatureKey key;
+    PayloadRef features;
+    uint32_t len;
+};
+
+/**
+ * Content-addressed mel features (see FeatureCache). Workers insert what they
+ * computed, the host copies hits out; the counters are what /metrics exports.
+ */
+struct FeatureCacheHeader {
+    uint64_t max_bytes;                                  // 0 = cache off
+    std::atomic<uint64_t> bytes;                         // arena bytes held by entries
+    std::atomic<uint32_t> sweep_hand;                    // CLOCK over every entry, for the byte budget
+    std::atomic<uint32_t> set_hands[FEATURE_CACHE_SETS]; // CLOCK within a set, for a slot
+    std::atomic<uint64_t> hits;        // host: answered from the cache
+    std::atomic<uint64_t> collapsed;   // host: waited for an identical task in flight, then hit
+    std::atomic<uint64_t> misses;      // host: computed by a worker
+    std::atomic<uint64_t> inserts;     // workers
+    std::atomic<uint64_t> evictions;
+    std::atomic<uint64_t> rejected;    // not stored: over the budget, no arena room, or set busy (not duplicates)
+    FeatureCacheEntry entries[FEATURE_CACHE_SLOTS];
+};
+
+// Slab allocator state; see PayloadArena.
+struct ArenaHeader {
+    std::atomic<uint64_t> bump;                                 // bytes carved so far
+    std::atomic<uint64_t> free_heads[ARENA_NUM_CLASSES];        // (aba_tag << 32) | block
+    std::atomic<uint64_t> bytes_in_use;
+};
+
+/**
+ * Fixed-size header at the start of the SHM segment. The rings and the
+ * arena follow it at the offsets recorded here, so workers can attach
+ * without knowing the host's IpcConfig.
+ */
 struct SharedMem {
-    std::atomic<size_t> req_head;
-    std::atomic<size_t> req_tail; // Unused in my logic currently? Or used for logic?
-    
-    // We used explicit indices in IPC.cpp
-    std::atomic<size_t> req_write_idx; // Where producer puts next item
-    std::atomic<size_t> req_read_idx;  // Where consumer takes next item
-    
-    std::atomic<size_t> resp_write_idx;
-    std::atomic<size_t> resp_read_idx;
-
-    ReqSlot  req_ring[RING_CAP];
-    RespSlot resp_ring[RING_CAP];
+    uint64_t magic;
+    uint64_t total_size;
+    uint32_t ring_capacity;
+    uint32_t batch_max;
+    uint32_t batch_linger_us;
+    uint32_t priority_weights[NUM_PRIORITIES];
+    uint32_t trace_sample_every;
+    uint64_t max_payload_bytes;
+    uint64_t req_ring_offsets[NUM_PRIORITIES];
+    uint64_t resp_ring_offset;
+    uint64_t arena_offset;
+    uint64_t arena_size;
+
+    RingHeader req_rings[NUM_PRIORITIES];   // host threads -> workers, by TaskPriority
+    RingHeader resp_ring;  // workers -> host response thread
+
+    ArenaHeader arena;
+
+    StreamSession stream_sessions[MAX_STREAM_SESSIONS];
+
+    WorkerSlot workers[MAX_WORKERS];   // read by the host's autoscaler
+    TaskMetrics task_metrics[NUM_TASK_TYPES];
+    TraceRing traces[MAX_WORKERS];     // each worker's sampled spans, by slot
+    FeatureCacheHeader feature_cache;
+
+    // The host stores a task id at [task_id & (CANCEL_SLOTS - 1)] once nobody waits for
+    // its answer; a worker that dequeues it afterwards skips the work. Ids never collide
+    // while the completion table has at most CANCEL_SLOTS entries, otherwise a later
+    // cancel just overwrites an earlier one (that task is then computed for nothing).
+    std::atomic<uint64_t> cancelled[CANCEL_SLOTS];
 };
 
 }}
 
-#endif
\ No newline at end of file
+#endif
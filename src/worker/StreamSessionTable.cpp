@@ -0,0 +1,179 @@
+#include "StreamSessionTable.hpp"
+#include <chrono>
+
+namespace app { namespace worker {
+
+namespace {
+
+// Session ids carry their slot index in the low bits
+constexpr uint64_t SLOT_BITS = 16;
+constexpr uint64_t SLOT_MASK = (1ULL << SLOT_BITS) - 1;
+
+uint64_t nowNs() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+}
+
+void StreamSessionTable::attach(SharedMem* shm) {
+    m_shm = shm;
+    for (auto& pending : m_closeOnRelease) {
+        pending.store(0, std::memory_order_relaxed);
+    }
+    for (auto& since : m_busySince) {
+        since.store(0, std::memory_order_relaxed);
+    }
+    if (!m_shm) return;
+    for (size_t i = 0; i < MAX_STREAM_SESSIONS; ++i) {
+        m_shm->stream_sessions[i].state.store(SESSION_FREE, std::memory_order_relaxed);
+        m_shm->stream_sessions[i].session_id = 0;
+    }
+}
+
+StreamSession* StreamSessionTable::find(uint64_t sessionId) const {
+    if (!m_shm) return nullptr;
+    uint64_t slot = sessionId & SLOT_MASK;
+    if (slot >= MAX_STREAM_SESSIONS) return nullptr;
+    StreamSession* session = &m_shm->stream_sessions[slot];
+    if (session->session_id != sessionId) return nullptr;
+    return session;
+}
+
+StreamSessionTable::Status StreamSessionTable::open(uint64_t& sessionId) {
+    if (!m_shm) return Status::FULL;
+
+    uint64_t now = nowNs();
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < MAX_STREAM_SESSIONS; ++i) {
+            StreamSession& session = m_shm->stream_sessions[i];
+            uint32_t expected = SESSION_FREE;
+            bool claimed = session.state.compare_exchange_strong(expected, SESSION_BUSY, std::memory_order_acq_rel);
+
+            // Second pass: reclaim sessions whose client went away without closing
+            if (!claimed && pass == 1 && expected == SESSION_IDLE && now - session.last_used_ns > STREAM_SESSION_IDLE_NS) {
+                claimed = session.state.compare_exchange_strong(expected, SESSION_BUSY, std::memory_order_acq_rel);
+            }
+            // ...and expired ones whose append was never answered (its worker died). Taking the
+            // busy-since stamp is what makes it ours: a late release() finds it gone and backs off.
+            if (!claimed && pass == 1 && expected == SESSION_BUSY && session.session_id == 0) {
+                uint64_t since = m_busySince[i].load(std::memory_order_acquire);
+                claimed = since != 0 && now - since > STREAM_SESSION_IDLE_NS &&
+                          m_busySince[i].compare_exchange_strong(since, 0, std::memory_order_acq_rel);
+            }
+            if (!claimed) continue;
+
+            sessionId = (m_idCounter.fetch_add(1, std::memory_order_relaxed) << SLOT_BITS) | i;
+            session.session_id = sessionId;
+            session.carry_len = 0;
+            session.frames_emitted = 0;
+            session.last_used_ns = now;
+            session.state.store(SESSION_IDLE, std::memory_order_release);
+            return Status::OK;
+        }
+    }
+    return Status::FULL;
+}
+
+StreamSessionTable::Status StreamSessionTable::acquire(uint64_t sessionId, uint32_t& slot) {
+    StreamSession* session = find(sessionId);
+    if (!session) return Status::NOT_FOUND;
+
+    uint32_t expected = SESSION_IDLE;
+    if (!session->state.compare_exchange_strong(expected, SESSION_BUSY, std::memory_order_acq_rel)) {
+        return expected == SESSION_BUSY ? Status::BUSY : Status::NOT_FOUND;
+    }
+    // Closed and reopened between find() and the CAS
+    if (session->session_id != sessionId) {
+        session->state.store(SESSION_IDLE, std::memory_order_release);
+        return Status::NOT_FOUND;
+    }
+
+    slot = (uint32_t)(sessionId & SLOT_MASK);
+    m_busySince[slot].store(nowNs(), std::memory_order_release);
+    return Status::OK;
+}
+
+void StreamSessionTable::release(uint32_t slot) {
+    if (!m_shm || slot >= MAX_STREAM_SESSIONS) return;
+    // Already taken back by open() as dead
+    if (m_busySince[slot].exchange(0, std::memory_order_acq_rel) == 0) return;
+
+    StreamSession& session = m_shm->stream_sessions[slot];
+    session.last_used_ns = nowNs();
+    if (session.session_id == 0) {
+        // Expired while the append was out: nobody owns the session any more
+        session.state.store(SESSION_FREE, std::memory_order_release);
+        m_closeOnRelease[slot].store(0, std::memory_order_relaxed);
+        return;
+    }
+    session.state.store(SESSION_IDLE, std::memory_order_release);
+
+    // Its owner is gone (closeWhenIdle); a stale id from an earlier session just doesn't match
+    uint64_t closeId = m_closeOnRelease[slot].exchange(0, std::memory_order_acq_rel);
+    if (closeId != 0) {
+        uint64_t framesEmitted = 0;
+        close(closeId, framesEmitted);
+    }
+}
+
+StreamSessionTable::Status StreamSessionTable::close(uint64_t sessionId, uint64_t& framesEmitted) {
+    StreamSession* session = find(sessionId);
+    if (!session) return Status::NOT_FOUND;
+
+    uint32_t expected = SESSION_IDLE;
+    if (!session->state.compare_exchange_strong(expected, SESSION_BUSY, std::memory_order_acq_rel)) {
+        return expected == SESSION_BUSY ? Status::BUSY : Status::NOT_FOUND;
+    }
+    if (session->session_id != sessionId) {
+        session->state.store(SESSION_IDLE, std::memory_order_release);
+        return Status::NOT_FOUND;
+    }
+
+    framesEmitted = session->frames_emitted;
+    session->session_id = 0;
+    session->state.store(SESSION_FREE, std::memory_order_release);
+    return Status::OK;
+}
+
+void StreamSessionTable::closeWhenIdle(uint64_t sessionId) {
+    if (!find(sessionId)) return;
+    auto& pending = m_closeOnRelease[sessionId & SLOT_MASK];
+    // Flag first: a release() after the failed close below is then bound to see it
+    pending.store(sessionId, std::memory_order_release);
+    uint64_t framesEmitted = 0;
+    if (close(sessionId, framesEmitted) != Status::BUSY) {
+        uint64_t expected = sessionId;
+        pending.compare_exchange_strong(expected, 0, std::memory_order_acq_rel);
+    }
+}
+
+size_t StreamSessionTable::expire(uint64_t timeoutNs) {
+    if (!m_shm || timeoutNs == 0) return 0;
+    uint64_t now = nowNs();
+    size_t expired = 0;
+    for (size_t i = 0; i < MAX_STREAM_SESSIONS; ++i) {
+        uint64_t since = m_busySince[i].load(std::memory_order_acquire);
+        if (since == 0 || now - since <= timeoutNs) continue;
+        StreamSession& session = m_shm->stream_sessions[i];
+        // The worker checks the id before it touches the carry, so an append still queued fails with 404
+        uint64_t sessionId = session.session_id.load(std::memory_order_relaxed);
+        if (sessionId == 0 || !session.session_id.compare_exchange_strong(sessionId, 0, std::memory_order_acq_rel)) {
+            continue;
+        }
+        // Answered and acquired again since we looked: that append is a new one, leave it be
+        if (m_busySince[i].load(std::memory_order_acquire) != since) {
+            uint64_t closed = 0;
+            session.session_id.compare_exchange_strong(closed, sessionId, std::memory_order_acq_rel);
+            continue;
+        }
+        ++expired;
+    }
+    return expired;
+}
+
+uint64_t StreamSessionTable::framesEmitted(uint32_t slot) const {
+    if (!m_shm || slot >= MAX_STREAM_SESSIONS) return 0;
+    return m_shm->stream_sessions[slot].frames_emitted;
+}
+
+}}
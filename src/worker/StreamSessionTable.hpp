@@ -0,0 +1,107 @@
+#ifndef WORKER_STREAM_SESSION_TABLE_HPP
+#define WORKER_STREAM_SESSION_TABLE_HPP
+
+#include "SharedMemoryStructs.hpp"
+#include <atomic>
+
+namespace app { namespace worker {
+
+/**
+ * Host-side bookkeeping for SharedMem::stream_sessions.
+ * The host owns the session lifecycle (open / acquire / release / close);
+ * workers only read and update carry + frames_emitted of a BUSY session.
+ */
+class StreamSessionTable {
+public:
+    enum class Status {
+        OK,
+        NOT_FOUND,
+        BUSY,
+        FULL
+    };
+
+private:
+    SharedMem* m_shm = nullptr;
+    std::atomic<uint64_t> m_idCounter{1};
+    std::atomic<uint64_t> m_closeOnRelease[MAX_STREAM_SESSIONS] {};   // session id to close at release(), 0 = none
+    std::atomic<uint64_t> m_busySince[MAX_STREAM_SESSIONS] {};        // when acquire() took it, 0 = not held by an append
+
+    StreamSession* find(uint64_t sessionId) const;
+
+public:
+    void attach(SharedMem* shm);
+
+    // Opens a new session and writes its id.
+    Status open(uint64_t& sessionId);
+
+    // Marks the session BUSY so exactly one append is in flight. Writes the slot index.
+    Status acquire(uint64_t sessionId, uint32_t& slot);
+
+    // Back to IDLE (or FREE once expired). The response thread calls this when the append's answer arrives.
+    void release(uint32_t slot);
+
+    // Frees the slot and writes how many frames the session produced.
+    Status close(uint64_t sessionId, uint64_t& framesEmitted);
+
+    // For an owner that goes away with an append in flight: closes the session now if
+    // it is IDLE, otherwise as soon as that append's answer releases it.
+    void closeWhenIdle(uint64_t sessionId);
+
+    // Deadline thread. Closes every session whose append has been out longer than timeoutNs, so
+    // its owner gets NOT_FOUND from then on. The slot stays BUSY until the late answer arrives,
+    // or until open() takes it back after STREAM_SESSION_IDLE_NS if that never happens.
+    size_t expire(uint64_t timeoutNs);
+
+    // Frames emitted so far. Only meaningful while the caller holds the session.
+    uint64_t framesEmitted(uint32_t slot) const;
+};
+
+/**
+ * Returns an acquired session to IDLE if the append never gets queued. Move-only;
+ * once the task is queued, detach() it: from then on the response thread releases
+ * the session when the worker's answer arrives, so it stays BUSY for as long as
+ * a worker may still touch the carry.
+ */
+class SessionHold {
+private:
+    StreamSessionTable* m_table = nullptr;
+    uint32_t m_slot = 0;
+public:
+    SessionHold() = default;
+    SessionHold(StreamSessionTable* table, uint32_t slot) : m_table(table), m_slot(slot) {}
+
+    SessionHold(SessionHold&& other) noexcept : m_table(other.m_table), m_slot(other.m_slot) {
+        other.m_table = nullptr;
+    }
+
+    SessionHold& operator=(SessionHold&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_table = other.m_table;
+            m_slot = other.m_slot;
+            other.m_table = nullptr;
+        }
+        return *this;
+    }
+
+    SessionHold(const SessionHold&) = delete;
+    SessionHold& operator=(const SessionHold&) = delete;
+
+    ~SessionHold() { reset(); }
+
+    void reset() {
+        if (m_table) {
+            m_table->release(m_slot);
+            m_table = nullptr;
+        }
+    }
+
+    // The append was queued; the response thread owns the release now
+    void detach() { m_table = nullptr; }
+
+    uint32_t slot() const { return m_slot; }
+};
+
+}}
+
+#endif
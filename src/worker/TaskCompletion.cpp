@@ -0,0 +1,39 @@
+#include "TaskCompletion.hpp"
+
+namespace app { namespace worker {
+
+TaskCompletion::TaskCompletion() {
+    m_waitList.setListener(this);
+}
+
+void TaskCompletion::onNewItem(oatpp::async::CoroutineWaitList& list) {
+    if (isReady()) {
+        list.notifyAll();
+    }
+}
+
+void TaskCompletion::complete(TaskResult&& result) {
+    m_result = std::move(result);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready.store(true, std::memory_order_release);
+    }
+    m_cv.notify_all();
+    m_waitList.notifyAll();
+}
+
+void TaskCompletion::reset() {
+    m_ready.store(false, std::memory_order_relaxed);
+    m_result = TaskResult();
+}
+
+TaskResult TaskCompletion::take() {
+    return std::move(m_result);
+}
+
+void TaskCompletion::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this] { return isReady(); });
+}
+
+}}
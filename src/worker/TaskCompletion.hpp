@@ -0,0 +1,75 @@
+#ifndef WORKER_TASK_COMPLETION_HPP
+#define WORKER_TASK_COMPLETION_HPP
+
+#include "SharedMemoryStructs.hpp"
+#include "PayloadLease.hpp"
+#include "oatpp/core/async/CoroutineWaitList.hpp"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace app { namespace worker {
+
+/**
+ * Worker reply. payload leases the response block straight out of SHM;
+ * keep it alive until the data has been serialized.
+ */
+struct TaskResult {
+    RespSlot resp;
+    PayloadLease payload;
+};
+
+/**
+ * Completion of one submitted task, filled in by the WorkerManager response thread.
+ *
+ * Async callers (ENDPOINT_ASYNC steps) suspend on waitList() until isReady():
+ *
+ *   Action awaitResult() {
+ *       if (!m_pending->isReady()) {
+ *           return oatpp::async::Action::createWaitListAction(m_pending->waitList());
+ *       }
+ *       ... m_pending->take() ...
+ *   }
+ *
+ * The coroutine re-enters the same step when woken, so no executor thread is parked
+ * while the worker computes. Sync callers (tests, tools) use wait().
+ */
+class TaskCompletion : private oatpp::async::CoroutineWaitList::Listener {
+private:
+    std::atomic<bool> m_ready{false};
+    TaskResult m_result;
+    oatpp::async::CoroutineWaitList m_waitList;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+    // A coroutine that checked isReady() just before complete() ran must not sleep forever
+    void onNewItem(oatpp::async::CoroutineWaitList& list) override;
+
+public:
+    TaskCompletion();
+
+    TaskCompletion(const TaskCompletion&) = delete;
+    TaskCompletion& operator=(const TaskCompletion&) = delete;
+
+    // Response thread only, exactly once per use.
+    void complete(TaskResult&& result);
+
+    // Back to not-ready for reuse; drops any result nobody took.
+    // Only while no one else can see the completion (see CompletionTable).
+    void reset();
+
+    bool isReady() const { return m_ready.load(std::memory_order_acquire); }
+
+    oatpp::async::CoroutineWaitList* waitList() { return &m_waitList; }
+
+    // Moves the result out. Only after isReady().
+    TaskResult take();
+
+    // Blocks the calling thread until the result is in.
+    void wait();
+};
+
+}}
+
+#endif
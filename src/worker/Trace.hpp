@@ -0,0 +1,110 @@
+#ifndef WORKER_TRACE_HPP
+#define WORKER_TRACE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace app { namespace worker {
+
+// Stages of a task, in the order it goes through them (see /debug/trace)
+enum TraceStage : uint32_t {
+    TRACE_BODY_READ = 0,   // host: request body (an upload: one chunk's worth) arriving
+    TRACE_CONVERT,         // host: PCM16 -> float into the payload block
+    TRACE_ENQUEUE,         // host: completion entry + ring push
+    TRACE_QUEUE,           // worker: enqueue -> dequeue, semaphore wakeup included
+    TRACE_COMPUTE,         // worker
+    TRACE_DISPATCH,        // host: worker reply -> caller woken (response ring + response thread)
+    TRACE_SERIALIZE,       // host: response body encoding
+    NUM_TRACE_STAGES
+};
+
+// Events per ring (power of two); a ring is one writer thread's last TRACE_RING_CAPACITY spans
+constexpr size_t TRACE_RING_CAPACITY = 4096;
+
+// Whether taskId is in the 1-in-`every` sample (0 = tracing off). A hash of the id, so the
+// host and every worker agree on it without a flag in the ring entries.
+inline bool traceSampled(uint64_t taskId, uint32_t every) {
+    if (every == 0) return false;
+    uint64_t x = taskId + 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x % every == 0;
+}
+
+// One span as exported: process 0 is the host, 1 + slot a worker
+struct TraceSpan {
+    uint64_t startNs;
+    uint64_t durNs;
+    uint64_t taskId;
+    TraceStage stage;
+    uint32_t process;
+    uint32_t thread;
+};
+
+struct TraceEvent {
+    std::atomic<uint64_t> start_ns;   // monotonicNowNs()
+    std::atomic<uint64_t> dur_ns;
+    std::atomic<uint64_t> task_id;
+    std::atomic<uint64_t> stage;
+};
+
+/**
+ * Fixed-size ring of spans with a single writer, read by anyone at any time.
+ * Fields are relaxed atomics, so it works in SHM (a worker writes, the host reads)
+ * as well as in host memory. The writer never waits: old spans are overwritten, and
+ * a reader drops whatever may have been overwritten while it was copying. All zero
+ * is the empty ring.
+ */
+struct TraceRing {
+    std::atomic<uint64_t> head;   // spans written so far
+    TraceEvent events[TRACE_RING_CAPACITY];
+
+    void push(TraceStage stage, uint64_t taskId, uint64_t startNs, uint64_t endNs) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        TraceEvent& e = events[h & (TRACE_RING_CAPACITY - 1)];
+        e.start_ns.store(startNs, std::memory_order_relaxed);
+        e.dur_ns.store(endNs > startNs ? endNs - startNs : 0, std::memory_order_relaxed);
+        e.task_id.store(taskId, std::memory_order_relaxed);
+        e.stage.store(stage, std::memory_order_relaxed);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Appends the spans that ended at or after sinceNs
+    void read(uint64_t sinceNs, uint32_t process, uint32_t thread, std::vector<TraceSpan>& out) const {
+        uint64_t end = head.load(std::memory_order_acquire);
+        uint64_t begin = end > TRACE_RING_CAPACITY ? end - TRACE_RING_CAPACITY : 0;
+
+        std::vector<TraceSpan> copied;
+        copied.reserve(end - begin);
+        for (uint64_t i = begin; i < end; ++i) {
+            const TraceEvent& e = events[i & (TRACE_RING_CAPACITY - 1)];
+            TraceSpan span;
+            span.startNs = e.start_ns.load(std::memory_order_relaxed);
+            span.durNs = e.dur_ns.load(std::memory_order_relaxed);
+            span.taskId = e.task_id.load(std::memory_order_relaxed);
+            span.stage = (TraceStage)e.stage.load(std::memory_order_relaxed);
+            span.process = process;
+            span.thread = thread;
+            copied.push_back(span);
+        }
+
+        // Span i may have been overwritten (and mixed with another) once the writer got to i + capacity
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t now = head.load(std::memory_order_relaxed);
+        uint64_t valid = now >= TRACE_RING_CAPACITY ? now - TRACE_RING_CAPACITY + 1 : 0;
+
+        for (size_t k = 0; k < copied.size(); ++k) {
+            const TraceSpan& span = copied[k];
+            if (begin + k >= valid && span.startNs + span.durNs >= sinceNs && span.stage < NUM_TRACE_STAGES) {
+                out.push_back(span);
+            }
+        }
+    }
+};
+
+}}
+
+#endif
@@ -0,0 +1,142 @@
+#include "Tracer.hpp"
+#include "SharedMemoryStructs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+namespace app { namespace worker {
+
+namespace {
+
+std::atomic<uint32_t> g_sampleEvery{DEFAULT_TRACE_SAMPLE_EVERY};
+
+// Rings are never freed: a thread that exits leaves its last spans readable
+std::mutex g_ringsMutex;
+std::vector<std::unique_ptr<TraceRing>> g_rings;
+thread_local TraceRing* t_ring = nullptr;
+
+TraceRing* threadRing() {
+    if (!t_ring) {
+        auto ring = std::make_unique<TraceRing>();   // value-initialized: empty
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        t_ring = ring.get();
+        g_rings.push_back(std::move(ring));
+    }
+    return t_ring;
+}
+
+const char* const STAGE_NAMES[NUM_TRACE_STAGES] = {
+    "body_read", "convert", "enqueue", "queue", "compute", "dispatch", "serialize"
+};
+
+void appendEvent(std::string& out, bool& first, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+void appendEvent(std::string& out, bool& first, const char* format, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, format);
+    int len = std::vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (len <= 0) return;
+    if (!first) out += ",\n";
+    first = false;
+    out.append(line, std::min((size_t)len, sizeof(line) - 1));
+}
+
+double micros(uint64_t ns) {
+    return ns / 1000.0;
+}
+
+}
+
+void Tracer::setSampleEvery(uint32_t every) {
+    g_sampleEvery.store(every, std::memory_order_relaxed);
+}
+
+uint32_t Tracer::sampleEvery() {
+    return g_sampleEvery.load(std::memory_order_relaxed);
+}
+
+void Tracer::record(TraceStage stage, uint64_t taskId, uint64_t startNs, uint64_t endNs) {
+    if (sampled(taskId)) {
+        threadRing()->push(stage, taskId, startNs, endNs);
+    }
+}
+
+void Tracer::collect(uint64_t sinceNs, std::vector<TraceSpan>& out) {
+    std::lock_guard<std::mutex> lock(g_ringsMutex);
+    for (size_t t = 0; t < g_rings.size(); ++t) {
+        g_rings[t]->read(sinceNs, 0, (uint32_t)t, out);
+    }
+}
+
+const char* Tracer::stageName(TraceStage stage) {
+    return stage < NUM_TRACE_STAGES ? STAGE_NAMES[stage] : "unknown";
+}
+
+std::string Tracer::toChromeJson(const std::vector<TraceSpan>& spans) {
+    std::string out;
+    out.reserve(128 + spans.size() * 160);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+
+    // Name the processes: 0 is the host, 1 + slot the workers
+    std::set<uint32_t> processes = {0};
+    for (const TraceSpan& span : spans) processes.insert(span.process);
+    for (uint32_t p : processes) {
+        if (p == 0) {
+            appendEvent(out, first, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"host\"}}");
+        } else {
+            appendEvent(out, first, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"worker %u\"}}", p, p - 1);
+        }
+    }
+
+    // Per task: where the flows start and end
+    struct Ends { const TraceSpan* enqueue = nullptr; const TraceSpan* compute = nullptr; const TraceSpan* dispatch = nullptr; };
+    std::map<uint64_t, Ends> tasks;
+
+    for (const TraceSpan& span : spans) {
+        appendEvent(out, first,
+                    "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"task_id\":%" PRIu64 "}}",
+                    stageName(span.stage), span.process == 0 ? "host" : "worker", span.process, span.thread,
+                    micros(span.startNs), micros(span.durNs), span.taskId);
+
+        Ends& ends = tasks[span.taskId];
+        if (span.stage == TRACE_ENQUEUE) ends.enqueue = &span;
+        if (span.stage == TRACE_COMPUTE) ends.compute = &span;
+        if (span.stage == TRACE_DISPATCH) ends.dispatch = &span;
+    }
+
+    // Flow arrows: "s" at the end of one span, "f" binding to the span that encloses its timestamp.
+    // A worker may dequeue before the host thread is done pushing: never start after the finish.
+    auto flow = [&](const char* name, uint64_t taskId, const TraceSpan* from, const TraceSpan* to) {
+        uint64_t fromNs = std::min(from->startNs + from->durNs, std::max(to->startNs, from->startNs));
+        appendEvent(out, first,
+                    "{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"s\",\"id\":\"%" PRIu64 ".%s\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}",
+                    name, taskId, name, from->process, from->thread, micros(fromNs));
+        appendEvent(out, first,
+                    "{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"f\",\"bp\":\"e\",\"id\":\"%" PRIu64 ".%s\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}",
+                    name, taskId, name, to->process, to->thread, micros(to->startNs));
+    };
+    for (const auto& task : tasks) {
+        if (task.second.enqueue && task.second.compute) {
+            flow("request", task.first, task.second.enqueue, task.second.compute);
+        }
+        if (task.second.compute && task.second.dispatch) {
+            flow("reply", task.first, task.second.compute, task.second.dispatch);
+        }
+    }
+
+    out += "\n]}\n";
+    return out;
+}
+
+}}
@@ -0,0 +1,39 @@
+#ifndef WORKER_TRACER_HPP
+#define WORKER_TRACER_HPP
+
+#include "Trace.hpp"
+#include <string>
+#include <vector>
+
+namespace app { namespace worker {
+
+/**
+ * Host side of the stage tracing: each thread that records gets its own TraceRing
+ * on first use, so recording is a few relaxed stores with no lock. The workers
+ * write theirs into SHM (SharedMem::traces); WorkerManager::collectTrace() merges both.
+ *
+ * Only tasks in the 1-in-N sample are recorded (traceSampled), N from IpcConfig.
+ */
+class Tracer {
+public:
+    static void setSampleEvery(uint32_t every);
+    static uint32_t sampleEvery();
+
+    static bool sampled(uint64_t taskId) { return traceSampled(taskId, sampleEvery()); }
+
+    // Records into the calling thread's ring if taskId is sampled
+    static void record(TraceStage stage, uint64_t taskId, uint64_t startNs, uint64_t endNs);
+
+    // Host spans that ended at or after sinceNs; thread is the ring's registration order
+    static void collect(uint64_t sinceNs, std::vector<TraceSpan>& out);
+
+    // Chrome / Perfetto trace JSON: one complete event per span, and flow arrows from each
+    // task's enqueue to its compute and from its compute to the dispatch on the host
+    static std::string toChromeJson(const std::vector<TraceSpan>& spans);
+
+    static const char* stageName(TraceStage stage);
+};
+
+}}
+
+#endif
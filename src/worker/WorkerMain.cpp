@@ -1,6 +1,8 @@
 #include "WorkerMain.hpp"
 #include "IPC.hpp"
 #include "Bridge.hpp"
+#include "AudioParams.hpp"
+#include "FeatureCache.hpp"
 #include <iostream>
 #include <algorithm>
 #include <thread>
@@ -9,79 +11,337 @@
 
 namespace app { namespace worker {
 
-void processText(const ReqSlot& req, RespSlot& resp) {
+namespace {
+
+// Allocates the response payload; on exhaustion the task fails with 503 instead of blocking.
+template<typename T>
+T* allocResponse(IPC& ipc, RespSlot& resp, size_t count) {
+    resp.payload = ipc.arena().allocate(count * sizeof(T));
+    if (!resp.payload.valid()) {
+        resp.status_code = 503;
+        resp.len = 0;
+        return nullptr;
+    }
+    return ipc.payloadAs<T>(resp.payload);
+}
+
+}
+
+void processText(IPC& ipc, const ReqSlot& req, RespSlot& resp) {
     // Example: Reverse the string
-    size_t len = strnlen(req.text_data, TEXT_CHUNK_SIZE);
-    len = std::min(len, (size_t)TEXT_CHUNK_SIZE - 1);
-    
-    std::string s(req.text_data, len);
-    std::reverse(s.begin(), s.end());
-    
-    strncpy(resp.text_result, s.c_str(), TEXT_CHUNK_SIZE);
-    resp.len = s.length();
+    const char* text = ipc.payloadAs<char>(req.payload);
+    size_t len = std::min((size_t)req.len, (size_t)TEXT_CHUNK_SIZE);
+
+    char* out = allocResponse<char>(ipc, resp, len);
+    if (!out) return;
+
+    std::reverse_copy(text, text + len, out);
+    resp.len = (uint32_t)len;
 }
 
-void processAudio(const ReqSlot& req, RespSlot& resp) {
-    // Convert raw array to vector for the existing interface
-    std::vector<float> input(req.audio.audio_data, req.audio.audio_data + req.audio.num_samples);
-    std::vector<float> output;
-    
+void processAudio(IPC& ipc, const ReqSlot& req, RespSlot& resp) {
+    // Computes straight from the request block into the response block
+    const float* audio = ipc.payloadAs<float>(req.payload);
+    size_t frames = numFrames(req.len);
+    if (frames == 0) {
+        return; // Too short, empty reply
+    }
+
+    float* out = allocResponse<float>(ipc, resp, frames * N_MELS);
+    if (!out) return;
+
     AudioWorker worker;
-    worker.computeMelSpectrogram(input, output);
-    
-    // Copy back
-    // Capacity of mel_features is 80 * 100 = 8000 floats
-    size_t maxFloats = 80 * 100;
-    size_t copyLen = std::min(output.size(), maxFloats); 
-    
-    for(size_t i=0; i<copyLen; ++i) {
-        resp.mel_features[i] = output[i];
-    }
-    resp.len = copyLen;
+    worker.computeMelSpectrogram(audio, req.len, out);
+    resp.len = (uint32_t)(frames * N_MELS);
+}
+
+void processStreamAppend(IPC& ipc, const ReqSlot& req, RespSlot& resp) {
+    resp.len = 0;
+    if (req.len > AUDIO_CHUNK_SIZE) {
+        resp.status_code = 413;
+        return;
+    }
+    if (req.audio.session_slot >= MAX_STREAM_SESSIONS) {
+        resp.status_code = 404;
+        return;
+    }
+
+    // The host holds the session BUSY for the duration of this task, so we own carry/frames_emitted.
+    StreamSession& session = ipc.getMemory()->stream_sessions[req.audio.session_slot];
+    if (session.session_id != req.audio.session_id || session.state.load(std::memory_order_acquire) != SESSION_BUSY) {
+        resp.status_code = 404;
+        return;
+    }
+
+    // carry (< N_FFT samples) goes into the headroom right before the new chunk: work is O(new samples)
+    float* input = ipc.payloadAs<float>(req.payload) + STREAM_PAYLOAD_HEADROOM - session.carry_len;
+    std::copy(session.carry, session.carry + session.carry_len, input);
+    size_t inputLen = session.carry_len + req.len;
+
+    // Short appends that complete no frame reply without a payload
+    size_t frames = numFrames(inputLen);
+    if (frames > 0) {
+        float* out = allocResponse<float>(ipc, resp, frames * N_MELS);
+        if (!out) return;
+
+        AudioWorker worker;
+        worker.computeMelSpectrogram(input, inputLen, out);
+    }
+
+    // Keep everything from the first sample of the next (incomplete) frame: < N_FFT samples
+    size_t consumed = frames * HOP_LENGTH;
+    session.carry_len = (uint32_t)(inputLen - consumed);
+    std::copy(input + consumed, input + inputLen, session.carry);
+    session.frames_emitted += frames;
+
+    resp.len = (uint32_t)(frames * N_MELS);
+}
+
+namespace {
+
+// Our slot's ring in SHM, for sampled tasks (see /debug/trace); null without a slot
+TraceRing* g_trace = nullptr;
+
+RespSlot makeResponse(const ReqSlot& req) {
+    RespSlot resp;
+    resp.task_id = req.task_id;
+    resp.type = req.type;
+    resp.len = 0;
+    resp.status_code = 0;
+    resp.batch_size = 1;
+    resp.priority = req.priority;
+    resp.session_slot = req.type == TASK_AUDIO_STREAM ? req.audio.session_slot : 0;
+    resp.reply_timestamp_ns = 0;
+    resp.cache_key = req.cache_key;
+    uint64_t now = monotonicNowNs();
+    resp.queue_time_ns = now > req.enqueue_timestamp_ns ? now - req.enqueue_timestamp_ns : 0;
+    return resp;
+}
+
+uint64_t elapsedNs(std::chrono::high_resolution_clock::time_point start) {
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+// Leaves a copy of a keyed task's features in the shared cache, before the host hears about it
+void storeFeatures(IPC& ipc, const RespSlot& resp) {
+    FeatureCache cache(&ipc.getMemory()->feature_cache, &ipc.arena());
+    cache.insert(resp.cache_key, ipc.payloadAs<float>(resp.payload), resp.len);
 }
 
-void runWorker() {
+// Records the task in SHM for /metrics (and /debug/trace if sampled), then sends the answer
+void reply(IPC& ipc, RespSlot& resp) {
+    if (resp.cache_key && resp.status_code == 0 && resp.len > 0) {
+        storeFeatures(ipc, resp);
+    }
+    resp.reply_timestamp_ns = monotonicNowNs();
+    if (g_trace && traceSampled(resp.task_id, ipc.getMemory()->trace_sample_every)) {
+        // Dequeue ~ start of the computation; a batch's tasks share both spans
+        uint64_t start = resp.reply_timestamp_ns - std::min(resp.processing_time_ns, resp.reply_timestamp_ns);
+        g_trace->push(TRACE_QUEUE, resp.task_id, start - std::min(resp.queue_time_ns, start), start);
+        g_trace->push(TRACE_COMPUTE, resp.task_id, start, resp.reply_timestamp_ns);
+    }
+    if (resp.type < NUM_TASK_TYPES) {
+        TaskMetrics& metrics = ipc.getMemory()->task_metrics[resp.type];
+        if (resp.status_code == 0) {
+            metrics.queue_wait.record(resp.queue_time_ns);
+            metrics.compute.record(resp.processing_time_ns);
+        } else {
+            metrics.failed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    ipc.submitResponse(resp);
+}
+
+void handleRequest(IPC& ipc, const ReqSlot& req) {
+    RespSlot resp = makeResponse(req);
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (!req.payload.valid()) {
+        resp.status_code = 400; // Every task except shutdown carries a payload
+    } else if (req.type == TASK_TEXT_PROCESS) {
+        processText(ipc, req, resp);
+    } else if (req.type == TASK_AUDIO_PROCESS) {
+        processAudio(ipc, req, resp);
+    } else if (req.type == TASK_AUDIO_STREAM) {
+        processStreamAppend(ipc, req, resp);
+    } else {
+        resp.status_code = 400; // Unknown task
+    }
+
+    // Request payload is ours once dequeued; hand the block back before replying
+    ipc.arena().release(req.payload);
+
+    resp.processing_time_ns = elapsedNs(start);
+    reply(ipc, resp);
+}
+
+// Nobody will read the answer (caller gave up, or the deadline passed while it was queued):
+// reply without computing so the host can recycle the entry. Stream appends are computed
+// regardless: the session carry has to follow every chunk, read or not.
+bool skipIfAbandoned(IPC& ipc, const ReqSlot& req) {
+    if (req.type == TASK_AUDIO_STREAM) {
+        return false;
+    }
+    uint32_t status;
+    if (ipc.isCancelled(req.task_id)) {
+        status = 499; // Client Closed Request
+    } else if (req.deadline_ns != 0 && monotonicNowNs() >= req.deadline_ns) {
+        status = 504;
+    } else {
+        return false;
+    }
+
+    RespSlot resp = makeResponse(req);
+    resp.status_code = status;
+    if (req.payload.valid()) {
+        ipc.arena().release(req.payload);
+    }
+    if (req.type < NUM_TASK_TYPES) {
+        ipc.getMemory()->task_metrics[req.type].skipped.fetch_add(1, std::memory_order_relaxed);
+    }
+    resp.reply_timestamp_ns = monotonicNowNs();
+    ipc.submitResponse(resp);
+    return true;
+}
+
+bool isBatchable(const ReqSlot& req) {
+    return req.type == TASK_AUDIO_PROCESS && req.payload.valid();
+}
+
+// Credits the time until it goes out of scope to our SHM slot, for the host's autoscaler
+class BusyTime {
+private:
+    WorkerSlot* m_slot;
+    size_t m_tasks;
+    std::chrono::steady_clock::time_point m_start;
+public:
+    BusyTime(WorkerSlot* slot, size_t tasks)
+        : m_slot(slot)
+        , m_tasks(tasks)
+        , m_start(std::chrono::steady_clock::now())
+    {}
+
+    ~BusyTime() {
+        if (!m_slot) return;
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+        m_slot->busy_ns.fetch_add((uint64_t)elapsed.count(), std::memory_order_relaxed);
+        m_slot->tasks.fetch_add(m_tasks, std::memory_order_relaxed);
+    }
+};
+
+}
+
+void processAudioBatch(IPC& ipc, const std::vector<ReqSlot>& batch) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<RespSlot> resps;
+    std::vector<MelJob> jobs;
+    resps.reserve(batch.size());
+    jobs.reserve(batch.size());
+
+    for (const ReqSlot& req : batch) {
+        resps.push_back(makeResponse(req));
+        RespSlot& resp = resps.back();
+
+        size_t frames = numFrames(req.len);
+        if (frames == 0) continue; // Too short, empty reply
+
+        float* out = allocResponse<float>(ipc, resp, frames * N_MELS);
+        if (!out) continue;
+
+        jobs.push_back(MelJob{ipc.payloadAs<float>(req.payload), req.len, out});
+        resp.len = (uint32_t)(frames * N_MELS);
+    }
+
+    // One mel pass for the whole batch
+    if (!jobs.empty()) {
+        AudioWorker worker;
+        worker.computeMelSpectrogramBatch(jobs.data(), jobs.size());
+    }
+
+    // Every task waited for the whole batch, so that is its processing time
+    uint64_t processingNs = elapsedNs(start);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        ipc.arena().release(batch[i].payload);
+        resps[i].processing_time_ns = processingNs;
+        resps[i].batch_size = (uint32_t)batch.size();
+        reply(ipc, resps[i]);
+    }
+}
+
+int runWorker(int slot) {
     IPC ipc;
     try {
         ipc.initWorker();
     } catch(const std::exception& e) {
         std::cerr << "Worker failed to init IPC: " << e.what() << std::endl;
-        return;
+        // Non-zero so the host reaps this as a crash and replaces it, not as a retirement
+        return 1;
     }
 
-    std::cout << "Worker process started. Waiting for tasks..." << std::endl;
+    WorkerSlot* stats = slot >= 0 && slot < (int)MAX_WORKERS ? &ipc.getMemory()->workers[slot] : nullptr;
+    g_trace = stats ? &ipc.getMemory()->traces[slot] : nullptr;
+    const size_t batchMax = ipc.batchMax();
+    const auto linger = ipc.batchLinger();
+    std::cout << "Worker process started (audio batch " << batchMax << ", linger "
+              << linger.count() << "us). Waiting for tasks..." << std::endl;
+
+    std::vector<ReqSlot> batch;
+    batch.reserve(batchMax);
 
     ReqSlot req;
-    while (true) {
-        if (ipc.waitForRequest(req)) {
+    bool running = true;
+    while (running) {
+        if (!ipc.waitForRequest(req)) continue;
+
+        if (req.type == TASK_SHUTDOWN) {
+            break;
+        }
+        if (skipIfAbandoned(ipc, req)) {
+            continue;
+        }
+        if (batchMax <= 1 || !isBatchable(req)) {
+            BusyTime busy(stats, 1);
+            handleRequest(ipc, req);
+            continue;
+        }
+
+        // Micro-batch: take whatever audio is already queued, waiting at most
+        // `linger` (from the first task) for the batch to fill up. Long tasks
+        // (e.g. upload chunks) fill it on their own and never queue behind each other.
+        batch.clear();
+        batch.push_back(req);
+        size_t batchSamples = req.len;
+        auto deadline = std::chrono::steady_clock::now() + linger;
+        while (batch.size() < batchMax && batchSamples < BATCH_MAX_SAMPLES) {
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+            if (!ipc.pollRequest(req, std::max(remaining, std::chrono::microseconds(0)))) {
+                break;
+            }
             if (req.type == TASK_SHUTDOWN) {
-                std::cout << "Worker received shutdown signal." << std::endl;
+                running = false; // Finish what we hold first
                 break;
             }
-
-            RespSlot resp;
-            resp.task_id = req.task_id;
-            resp.type = req.type;
-            resp.status_code = 0;
-            
-            auto start = std::chrono::high_resolution_clock::now();
-
-            if (req.type == TASK_TEXT_PROCESS) {
-                processText(req, resp);
-            } else if (req.type == TASK_AUDIO_PROCESS) {
-                processAudio(req, resp);
+            if (skipIfAbandoned(ipc, req)) {
+                continue;
+            }
+            if (isBatchable(req)) {
+                batch.push_back(req);
+                batchSamples += req.len;
             } else {
-                resp.status_code = 400; // Unknown task
+                BusyTime busy(stats, 1);
+                handleRequest(ipc, req); // Text and stream appends don't wait for the batch
             }
-
-            auto end = std::chrono::high_resolution_clock::now();
-            resp.processing_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
-
-            ipc.submitResponse(resp);
         }
+
+        BusyTime busy(stats, batch.size());
+        processAudioBatch(ipc, batch);
     }
-    
+
+    std::cout << "Worker received shutdown signal." << std::endl;
     ipc.cleanup();
+    return 0;
 }
 
 }}
@@ -3,7 +3,9 @@
 
 namespace app { namespace worker {
 
-void runWorker();
+// slot: SharedMem::workers entry to account busy time in, -1 for none (manual workers).
+// Returns the process exit status: 0 after a shutdown, non-zero if the worker never came up.
+int runWorker(int slot = -1);
 
 }}
 
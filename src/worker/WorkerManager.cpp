@@ -1,90 +1,263 @@
 #include "WorkerManager.hpp"
+#include "Tracer.hpp"
 #include <iostream>
 #include <csignal>
 #include <sys/wait.h>
 #include <chrono>
+#include <algorithm>
 
 namespace app { namespace worker {
 
-WorkerManager::WorkerManager() {}
+namespace {
+
+// How often the host looks for tasks past their deadline
+constexpr auto DEADLINE_TICK = std::chrono::milliseconds(10);
+// How often the supervisor reaps workers and samples load for the autoscaler
+constexpr auto SUPERVISOR_TICK = std::chrono::milliseconds(250);
+// Weight of the newest sample in the moving averages: 1/8
+constexpr uint64_t AVG_SHIFT = 3;
+
+// Single writer (the response thread), so a plain load/store is enough
+void addSample(std::atomic<uint64_t>& avg, uint64_t sample) {
+    uint64_t value = avg.load(std::memory_order_relaxed);
+    value = value == 0 ? sample : value - (value >> AVG_SHIFT) + (sample >> AVG_SHIFT);
+    avg.store(value, std::memory_order_relaxed);
+}
+
+}
+
+WorkerManager::WorkerManager(const IpcConfig& ipcConfig, size_t maxInFlight, uint64_t taskTimeoutMs)
+    : m_ipcConfig(ipcConfig)
+    , m_completions(maxInFlight)
+    , m_taskTimeoutNs(taskTimeoutMs * 1000 * 1000)
+{}
 
 WorkerManager::~WorkerManager() {
     stop();
 }
 
-void WorkerManager::start(int numWorkers, const char* execPath) {
+void WorkerManager::start(int numWorkers, const char* execPath, const ScalingConfig& scaling) {
     if (m_running) return;
 
-    m_ipc.initHost();
+    m_ipc.initHost(m_ipcConfig);
+    Tracer::setSampleEvery(m_ipcConfig.traceSampleEvery);
+    m_streamSessions.attach(m_ipc.getMemory());
+    m_completions.attachCancelFlags(m_ipc.cancelFlags());
+    m_featureCache.attach(&m_ipc.getMemory()->feature_cache, &m_ipc.arena());
     m_running = true;
 
     // Start Response Thread
     m_responseThread = std::thread(&WorkerManager::responseLoop, this);
+    m_deadlineThread = std::thread(&WorkerManager::deadlineLoop, this);
 
-    std::cout << "Starting " << numWorkers << " workers..." << std::endl;
-
-    // Fork Workers
-    for (int i = 0; i < numWorkers; ++i) {
-        pid_t pid = fork();
-        if (pid == 0) {
-            // Child
-            // Re-execute self with --worker flag
-            // Ensure execPath is valid.
-            execl(execPath, execPath, "--worker", (char*)NULL);
-            // If exec fails
-            std::cerr << "Failed to execl worker!" << std::endl;
-            exit(1);
-        } else if (pid > 0) {
-            m_workerPids.push_back(pid);
-        } else {
-            std::cerr << "Failed to fork worker" << std::endl;
+    if (!execPath) {
+        return; // Manual workers (tests): nothing to fork or supervise
+    }
+    m_execPath = execPath;
+
+    // No bounds given: the pool stays at numWorkers
+    m_scaling = scaling;
+    if (m_scaling.minWorkers == 0 && m_scaling.maxWorkers == 0) {
+        m_scaling.minWorkers = m_scaling.maxWorkers = (size_t)std::max(numWorkers, 0);
+    }
+    m_scaling.maxWorkers = std::min(std::max(m_scaling.maxWorkers, (size_t)1), MAX_WORKERS);
+    m_scaling.minWorkers = std::min(m_scaling.minWorkers, m_scaling.maxWorkers);
+    size_t initial = std::min(std::max((size_t)std::max(numWorkers, 0), m_scaling.minWorkers), m_scaling.maxWorkers);
+
+    std::cout << "Starting " << initial << " workers (min " << m_scaling.minWorkers
+              << ", max " << m_scaling.maxWorkers << ")..." << std::endl;
+
+    {
+        std::lock_guard<std::mutex> lock(m_workersMutex);
+        for (size_t i = 0; i < initial; ++i) {
+            spawnWorkerLocked();
         }
+        m_activeWorkers = m_workers.size();
     }
+    m_supervisorThread = std::thread(&WorkerManager::supervisorLoop, this);
 }
 
 void WorkerManager::stop() {
     if (!m_running) return;
     m_running = false;
 
-    // Send Shutdown Signal via SHM
-    for (size_t i = 0; i < m_workerPids.size(); ++i) {
+    if (m_supervisorThread.joinable()) {
+        m_supervisorThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_workersMutex);
+
+    // Send Shutdown Signal via SHM (retiring workers already have theirs)
+    for (size_t i = m_retiring; i < m_workers.size(); ++i) {
         sendShutdownSignal();
     }
 
-    // Detach response thread (simplest shutdown for blocking sem_wait)
-    if (m_responseThread.joinable()) {
-        m_responseThread.detach(); 
+    if (m_deadlineThread.joinable()) {
+        m_deadlineThread.join();
     }
 
-    // Wait for children
-    for (pid_t pid : m_workerPids) {
+    // Wait for children; the response thread keeps draining so none blocks on a full ring
+    for (const WorkerProcess& worker : m_workers) {
         int status;
-        waitpid(pid, &status, 0);
+        waitpid(worker.pid, &status, 0);
+    }
+    m_workers.clear();
+    m_retiring = 0;
+    m_activeWorkers = 0;
+
+    // Wake the response thread with a reply of our own and wait for it to go: past this
+    // point nothing else may complete tasks or read the SHM
+    if (m_responseThread.joinable()) {
+        RespSlot wake = {};
+        wake.type = TASK_SHUTDOWN;
+        m_ipc.submitResponse(wake);
+        m_responseThread.join();
     }
-    m_workerPids.clear();
 
+    // Nobody will answer what's still pending: wake the waiters with an error
+    m_completions.failAll(503);
+
+    m_streamSessions.attach(nullptr);
+    m_completions.attachCancelFlags(nullptr);
+    m_featureCache.attach(nullptr, nullptr);
     m_ipc.cleanup();
 }
 
-void WorkerManager::sendShutdownSignal() {
-    ReqSlot req;
+bool WorkerManager::sendShutdownSignal() {
+    ReqSlot req = {};
     req.task_id = 0;
     req.type = TASK_SHUTDOWN;
-    m_ipc.submitRequest(req);
+    req.priority = PRIORITY_BATCH;
+    return m_ipc.submitRequest(req);
 }
 
-void WorkerManager::responseLoop() {
+bool WorkerManager::spawnWorkerLocked() {
+    // Lowest slot no running (or retiring) worker holds
+    uint32_t slot = 0;
+    while (slot < MAX_WORKERS && std::any_of(m_workers.begin(), m_workers.end(),
+                                             [slot](const WorkerProcess& w) { return w.slot == slot; })) {
+        ++slot;
+    }
+    if (slot == MAX_WORKERS) {
+        return false;
+    }
+
+    std::string slotArg = std::to_string(slot);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Child
+        // Re-execute self with --worker flag
+        execl(m_execPath.c_str(), m_execPath.c_str(), "--worker", slotArg.c_str(), (char*)NULL);
+        // If exec fails
+        std::cerr << "Failed to execl worker!" << std::endl;
+        exit(1);
+    } else if (pid > 0) {
+        m_workers.push_back(WorkerProcess{pid, slot});
+        return true;
+    }
+    std::cerr << "Failed to fork worker" << std::endl;
+    return false;
+}
+
+void WorkerManager::reapWorkersLocked() {
+    size_t crashed = 0;
+    for (auto it = m_workers.begin(); it != m_workers.end();) {
+        int status;
+        if (waitpid(it->pid, &status, WNOHANG) != it->pid) {
+            ++it;
+            continue;
+        }
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && m_retiring > 0) {
+            // Took a shutdown: one retirement done
+            --m_retiring;
+        } else {
+            std::cerr << "Worker " << it->pid << " died (status " << status << "), replacing it" << std::endl;
+            ++crashed;
+        }
+        it = m_workers.erase(it);
+    }
+    for (; crashed > 0 && spawnWorkerLocked(); --crashed) {}
+}
+
+uint64_t WorkerManager::busyNs() const {
+    uint64_t total = 0;
+    for (const WorkerSlot& slot : m_ipc.getMemory()->workers) {
+        total += slot.busy_ns.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void WorkerManager::supervisorLoop() {
+    Autoscaler autoscaler(m_scaling);
+    uint64_t lastBusy = busyNs();
+    uint64_t lastNs = monotonicNowNs();
+
     while (m_running) {
+        std::this_thread::sleep_for(SUPERVISOR_TICK);
+        std::lock_guard<std::mutex> lock(m_workersMutex);
+        if (!m_running) break;
+
+        reapWorkersLocked();
+
+        Autoscaler::Sample sample;
+        uint64_t busy = busyNs();
+        uint64_t now = monotonicNowNs();
+        sample.workers = m_workers.size() - m_retiring;
+        for (uint32_t p = 0; p < NUM_PRIORITIES; ++p) {
+            sample.queued += m_ipc.requestDepth((TaskPriority)p);
+        }
+        sample.busyNs = busy - lastBusy;
+        sample.elapsedNs = now - lastNs;
+        lastBusy = busy;
+        lastNs = now;
+
+        int delta = autoscaler.decide(sample);
+        if (delta != 0) {
+            std::cout << "Scaling workers " << sample.workers << " -> " << (int)sample.workers + delta
+                      << " (queued " << sample.queued << ", utilization "
+                      << (int)(autoscaler.utilization() * 100) << "%)" << std::endl;
+        }
+        for (; delta > 0 && spawnWorkerLocked(); --delta) {}
+        // Whichever worker dequeues the shutdown retires, after finishing what it holds
+        for (; delta < 0 && sendShutdownSignal(); ++delta) {
+            ++m_retiring;
+        }
+        m_activeWorkers = m_workers.size() - m_retiring;
+    }
+}
+
+void WorkerManager::responseLoop() {
+    // Runs until stop() queues its TASK_SHUTDOWN reply, behind anything the workers sent
+    for (;;) {
         RespSlot resp;
         // Blocking wait
         if (m_ipc.waitForResponse(resp, true)) {
-            std::lock_guard<std::mutex> lock(m_mapMutex);
-            auto it = m_pendingTasks.find(resp.task_id);
-            if (it != m_pendingTasks.end()) {
-                it->second.set_value(resp);
-                m_pendingTasks.erase(it);
-            } else {
-                // Unknown task or timed out?
+            if (resp.type == TASK_SHUTDOWN) {
+                break;
+            }
+            // Skipped tasks (cancelled, expired) took no compute and would drag the average down
+            if (resp.status_code == 0) {
+                addSample(m_avgTaskNs, resp.processing_time_ns / std::max<uint32_t>(resp.batch_size, 1));
+                if (resp.priority < NUM_PRIORITIES) {
+                    ClassCounters& counters = m_classes[resp.priority];
+                    counters.completed.fetch_add(1, std::memory_order_relaxed);
+                    addSample(counters.avgQueueNs, resp.queue_time_ns);
+                    addSample(counters.avgLatencyNs, resp.queue_time_ns + resp.processing_time_ns);
+                }
+            }
+            // The worker is done with the session's carry: only now may the next append go out,
+            // whether or not anyone still waits for this one
+            if (resp.type == TASK_AUDIO_STREAM) {
+                m_streamSessions.release(resp.session_slot);
+            }
+            // If the caller is gone the result (and its payload lease) is dropped right here
+            m_completions.complete(resp.task_id, TaskResult{resp, PayloadLease(&m_ipc.arena(), resp.payload)});
+            // Whoever waits for the same features can read them from the cache now (or compute them)
+            if (resp.cache_key) {
+                m_featureFlights.land(resp.cache_key, resp.task_id);
+            }
+            if (resp.reply_timestamp_ns != 0) {
+                Tracer::record(TRACE_DISPATCH, resp.task_id, resp.reply_timestamp_ns, monotonicNowNs());
             }
         } else {
             // Error
@@ -93,29 +266,73 @@ void WorkerManager::responseLoop() {
     }
 }
 
-std::future<RespSlot> WorkerManager::submitTask(const ReqSlot& req) {
-    ReqSlot mutableReq = req;
-    mutableReq.task_id = m_taskIdCounter++;
-    mutableReq.enqueue_timestamp_ns = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+void WorkerManager::deadlineLoop() {
+    while (m_running) {
+        std::this_thread::sleep_for(DEADLINE_TICK);
+        // Covers a worker that died mid-task too: its callers get 504 instead of waiting forever
+        m_completions.expire(monotonicNowNs(), 504);
+        // ...and a stream whose append it was can't be used again
+        m_streamSessions.expire(m_taskTimeoutNs);
+    }
+}
 
-    std::promise<RespSlot> promise;
-    auto future = promise.get_future();
+PriorityStats WorkerManager::priorityStats(TaskPriority priority) const {
+    PriorityStats stats;
+    const ClassCounters& counters = m_classes[priority];
+    stats.depth = m_ipc.requestDepth(priority);
+    stats.completed = counters.completed.load(std::memory_order_relaxed);
+    stats.avgQueueNs = counters.avgQueueNs.load(std::memory_order_relaxed);
+    stats.avgLatencyNs = counters.avgLatencyNs.load(std::memory_order_relaxed);
+    return stats;
+}
 
-    {
-        std::lock_guard<std::mutex> lock(m_mapMutex);
-        m_pendingTasks[mutableReq.task_id] = std::move(promise);
+PayloadLease WorkerManager::reserve(size_t bytes) {
+    if (bytes > m_ipcConfig.maxPayloadBytes) {
+        throw std::runtime_error("Payload exceeds max payload size");
     }
+    PayloadRef ref = m_ipc.arena().allocate(bytes);
+    if (!ref.valid()) {
+        throw std::runtime_error("Payload Arena Exhausted");
+    }
+    return PayloadLease(&m_ipc.arena(), ref);
+}
+
+TaskHandle WorkerManager::commit(const ReqSlot& req, PayloadLease payload) {
+    uint64_t startNs = monotonicNowNs();
+    uint64_t deadline = m_taskTimeoutNs != 0 ? startNs + m_taskTimeoutNs : 0;
+
+    TaskHandle handle = m_completions.claim(deadline);
+    if (!handle) {
+        throw std::runtime_error("Too Many Tasks In Flight");
+    }
+
+    ReqSlot mutableReq = req;
+    mutableReq.payload = payload.ref();
+    mutableReq.task_id = handle.taskId();
+    mutableReq.enqueue_timestamp_ns = monotonicNowNs();
+    // Workers never skip an append (the session's carry depends on it), however late; the caller
+    // still gets 504 at the deadline and the deadline thread closes the session
+    mutableReq.deadline_ns = req.type == TASK_AUDIO_STREAM ? 0 : deadline;
 
     if (!m_ipc.submitRequest(mutableReq)) {
-        // Queue full - cleanup and throw
-        {
-            std::lock_guard<std::mutex> lock(m_mapMutex);
-            m_pendingTasks.erase(mutableReq.task_id);
-        }
+        // Queue full - nobody will ever answer this id, so settle it ourselves and throw
+        m_completions.complete(handle.taskId(), TaskResult());
         throw std::runtime_error("Request Queue Full");
     }
 
-    return future;
+    // Queued: the worker owns the block now
+    payload.detach();
+    Tracer::record(TRACE_ENQUEUE, handle.taskId(), startNs, monotonicNowNs());
+    return handle;
+}
+
+void WorkerManager::collectTrace(uint64_t sinceNs, std::vector<TraceSpan>& out) const {
+    Tracer::collect(sinceNs, out);
+    if (SharedMem* shm = m_ipc.getMemory()) {
+        for (uint32_t slot = 0; slot < MAX_WORKERS; ++slot) {
+            shm->traces[slot].read(sinceNs, 1 + slot, 0, out);
+        }
+    }
 }
 
 }}
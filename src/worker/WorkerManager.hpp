@@ -2,42 +2,140 @@
 #define WORKER_MANAGER_HPP
 
 #include "IPC.hpp"
+#include "PayloadLease.hpp"
+#include "CompletionTable.hpp"
+#include "StreamSessionTable.hpp"
+#include "FeatureCache.hpp"
+#include "Autoscaler.hpp"
 #include <thread>
-#include <mutex>
-#include <map>
-#include <future>
 #include <atomic>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <unistd.h>
 
 namespace app { namespace worker {
 
+/**
+ * Per priority class: requests waiting in its ring, and moving averages (1/8) over
+ * answered tasks of time spent queued and of queued + worker time.
+ */
+struct PriorityStats {
+    size_t depth = 0;
+    uint64_t completed = 0;
+    uint64_t avgQueueNs = 0;
+    uint64_t avgLatencyNs = 0;
+};
+
 class WorkerManager {
 private:
+    struct ClassCounters {
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> avgQueueNs{0};
+        std::atomic<uint64_t> avgLatencyNs{0};
+    };
+
     IPC m_ipc;
+    IpcConfig m_ipcConfig;
+    StreamSessionTable m_streamSessions;
+    FeatureCache m_featureCache;
+    FeatureFlights m_featureFlights;
     std::thread m_responseThread;
+    std::thread m_deadlineThread;
     std::atomic<bool> m_running{false};
-    std::atomic<uint64_t> m_taskIdCounter{1};
+    CompletionTable m_completions;
+    uint64_t m_taskTimeoutNs;
+    std::atomic<uint64_t> m_avgTaskNs{0};   // written by the response thread only
+    ClassCounters m_classes[NUM_PRIORITIES];  // same
 
-    std::mutex m_mapMutex;
-    std::map<uint64_t, std::promise<RespSlot>> m_pendingTasks;
+    struct WorkerProcess {
+        pid_t pid;
+        uint32_t slot;   // SharedMem::workers index
+    };
 
-    std::vector<pid_t> m_workerPids;
+    std::string m_execPath;
+    ScalingConfig m_scaling;
+    std::thread m_supervisorThread;
+    std::mutex m_workersMutex;
+    std::vector<WorkerProcess> m_workers;
+    size_t m_retiring = 0;                  // shutdowns queued that no worker has acted on yet
+    std::atomic<size_t> m_activeWorkers{0}; // m_workers minus m_retiring
 
     void responseLoop();
+    void deadlineLoop();
+    void supervisorLoop();
+
+    // Both with m_workersMutex held
+    bool spawnWorkerLocked();
+    void reapWorkersLocked();
+    uint64_t busyNs() const;
 
 public:
-    WorkerManager();
+    // taskTimeoutMs: tasks unanswered after this long fail with status 504 (0 = wait forever)
+    explicit WorkerManager(const IpcConfig& ipcConfig = IpcConfig(),
+                           size_t maxInFlight = DEFAULT_MAX_IN_FLIGHT,
+                           uint64_t taskTimeoutMs = DEFAULT_TASK_TIMEOUT_MS);
     ~WorkerManager();
 
-    // Start workers. execPath is the path to the current executable.
-    void start(int numWorkers, const char* execPath);
+    // Start workers. execPath is the path to the current executable (nullptr: the caller
+    // runs its own workers). With scaling bounds apart, a supervisor thread then grows and
+    // shrinks the pool between them; either way it replaces workers that crash.
+    void start(int numWorkers, const char* execPath, const ScalingConfig& scaling = ScalingConfig());
     void stop();
     
-    // Send a single shutdown signal (useful for manual/test workers)
-    void sendShutdownSignal();
+    // Send a single shutdown signal (useful for manual/test workers). False if the ring is full.
+    bool sendShutdownSignal();
+
+    // Workers running and not about to retire (0 with manual workers)
+    size_t workerCount() const { return m_activeWorkers.load(std::memory_order_relaxed); }
+
+    // --- Zero-copy submission ---
+    //
+    // reserve() hands out an arena block the caller fills in place (e.g. PCM -> float
+    // conversion writes straight into SHM). commit() queues the task and passes the
+    // block to the worker; if queueing fails the lease releases it. The returned
+    // handle's completion can be awaited from a coroutine without blocking an executor thread.
+    //
+    // Every task gets a deadline of now + task timeout, after which its caller gets 504.
+    // Workers skip tasks that are past it, or that were abandoned (handle dropped before
+    // the answer), except stream appends: the session carry has to follow every chunk.
+    // Their session goes back to IDLE when the answer arrives, not when the handle is
+    // dropped, and is closed if the answer hasn't come by the deadline.
+
+    // Throws when the arena is exhausted or bytes exceeds the configured max payload.
+    PayloadLease reserve(size_t bytes);
+    TaskHandle commit(const ReqSlot& req, PayloadLease payload);
+
+    uint64_t maxPayloadBytes() const { return m_ipcConfig.maxPayloadBytes; }
+    uint64_t payloadBytesInUse() { return m_ipc.arena().bytesInUse(); }
+    size_t tasksInFlight() const { return m_completions.inFlight(); }
+    PriorityStats priorityStats(TaskPriority priority) const;
+
+    // Moving average of worker time per task (a batch's time split over its tasks), 0 until the first answer
+    uint64_t averageTaskNs() const { return m_avgTaskNs.load(std::memory_order_relaxed); }
+
+    // --- Metrics (see /metrics); workers keep these in SHM, nullptr before start() ---
+
+    const TaskMetrics* taskMetrics(TaskType type) const {
+        return m_ipc.getMemory() && type < NUM_TASK_TYPES ? &m_ipc.getMemory()->task_metrics[type] : nullptr;
+    }
+    const WorkerSlot* workerSlot(size_t slot) const {
+        return m_ipc.getMemory() && slot < MAX_WORKERS ? &m_ipc.getMemory()->workers[slot] : nullptr;
+    }
+    size_t responseDepth() const { return m_ipc.responseDepth(); }
+    uint32_t ringCapacity() const { return m_ipc.ringCapacity(); }
+    uint64_t arenaBytes() const { return m_ipcConfig.arenaBytes; }
+
+    // Sampled spans (see Tracer) that ended at or after sinceNs: the host's threads and every worker slot
+    void collectTrace(uint64_t sinceNs, std::vector<TraceSpan>& out) const;
+
+    // Streaming STFT sessions (TASK_AUDIO_STREAM), backed by SharedMem::stream_sessions
+    StreamSessionTable& streamSessions() { return m_streamSessions; }
 
-    std::future<RespSlot> submitTask(const ReqSlot& req);
+    // Mel features by input hash (SharedMem::feature_cache), and the keyed tasks in flight
+    FeatureCache& featureCache() { return m_featureCache; }
+    FeatureFlights& featureFlights() { return m_featureFlights; }
+    FeatureCache::Stats featureCacheStats() const { return m_featureCache.stats(); }
 };
 
 }}
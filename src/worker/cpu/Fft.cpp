@@ -0,0 +1,154 @@
+#include "Fft.hpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace app { namespace worker { namespace cpu {
+
+namespace {
+
+inline Complex mul(const Complex& a, const Complex& b) {
+    return { a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re };
+}
+
+inline Complex add(const Complex& a, const Complex& b) {
+    return { a.re + b.re, a.im + b.im };
+}
+
+inline Complex sub(const Complex& a, const Complex& b) {
+    return { a.re - b.re, a.im - b.im };
+}
+
+constexpr size_t STACK_SCRATCH = 64;
+
+}
+
+FftPlan::FftPlan(size_t size)
+    : m_size(size)
+{
+    if (size == 0) {
+        throw std::invalid_argument("FFT size must be > 0");
+    }
+
+    // Twiddles computed in double so large sizes don't accumulate float error
+    m_twiddles.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        double phase = -2.0 * M_PI * (double)i / (double)size;
+        m_twiddles[i] = { (float)std::cos(phase), (float)std::sin(phase) };
+    }
+
+    // Factorize: radix 4 first, then 2, then odd factors
+    size_t n = size;
+    size_t p = 4;
+    while (n > 1) {
+        while (n % p != 0) {
+            switch (p) {
+                case 4: p = 2; break;
+                case 2: p = 3; break;
+                default: p += 2; break;
+            }
+            if (p * p > n) p = n;
+        }
+        n /= p;
+        m_factors.push_back(p);
+        m_factors.push_back(n);
+    }
+}
+
+void FftPlan::butterfly2(Complex* out, size_t fstride, size_t m) const {
+    for (size_t k = 0; k < m; ++k) {
+        Complex t = mul(out[k + m], m_twiddles[k * fstride]);
+        out[k + m] = sub(out[k], t);
+        out[k] = add(out[k], t);
+    }
+}
+
+void FftPlan::butterfly4(Complex* out, size_t fstride, size_t m) const {
+    for (size_t k = 0; k < m; ++k) {
+        Complex s0 = mul(out[k + m], m_twiddles[k * fstride]);
+        Complex s1 = mul(out[k + 2 * m], m_twiddles[2 * k * fstride]);
+        Complex s2 = mul(out[k + 3 * m], m_twiddles[3 * k * fstride]);
+
+        Complex s5 = sub(out[k], s1);
+        Complex s4 = add(out[k], s1);
+        Complex s3 = add(s0, s2);
+        Complex s6 = sub(s0, s2);
+
+        out[k + 2 * m] = sub(s4, s3);
+        out[k] = add(s4, s3);
+        out[k + m] = { s5.re + s6.im, s5.im - s6.re };
+        out[k + 3 * m] = { s5.re - s6.im, s5.im + s6.re };
+    }
+}
+
+void FftPlan::butterflyGeneric(Complex* out, size_t fstride, size_t m, size_t p, Complex* scratch) const {
+    for (size_t u = 0; u < m; ++u) {
+        for (size_t q = 0; q < p; ++q) {
+            scratch[q] = out[u + q * m];
+        }
+
+        for (size_t q1 = 0; q1 < p; ++q1) {
+            size_t k = u + q1 * m;
+            Complex acc = scratch[0];
+            size_t twIdx = 0;
+            for (size_t q = 1; q < p; ++q) {
+                twIdx += fstride * k;
+                if (twIdx >= m_size) twIdx -= m_size;
+                acc = add(acc, mul(scratch[q], m_twiddles[twIdx]));
+            }
+            out[k] = acc;
+        }
+    }
+}
+
+void FftPlan::work(Complex* out, const Complex* in, size_t fstride, const size_t* factors, Complex* scratch) const {
+    const size_t p = factors[0];
+    const size_t m = factors[1];
+
+    if (m == 1) {
+        for (size_t i = 0; i < p; ++i) {
+            out[i] = in[i * fstride];
+        }
+    } else {
+        for (size_t q = 0; q < p; ++q) {
+            work(out + q * m, in + q * fstride, fstride * p, factors + 2, scratch);
+        }
+    }
+
+    switch (p) {
+        case 2: butterfly2(out, fstride, m); break;
+        case 4: butterfly4(out, fstride, m); break;
+        default: butterflyGeneric(out, fstride, m, p, scratch); break;
+    }
+}
+
+void FftPlan::forward(const Complex* in, Complex* out) const {
+    if (m_size == 1) {
+        out[0] = in[0];
+        return;
+    }
+
+    size_t maxRadix = 0;
+    for (size_t i = 0; i < m_factors.size(); i += 2) {
+        if (m_factors[i] > maxRadix) maxRadix = m_factors[i];
+    }
+
+    if (maxRadix <= STACK_SCRATCH) {
+        Complex scratch[STACK_SCRATCH];
+        work(out, in, 1, m_factors.data(), scratch);
+    } else {
+        std::vector<Complex> scratch(maxRadix);
+        work(out, in, 1, m_factors.data(), scratch.data());
+    }
+}
+
+void FftPlan::forwardReal(const float* in, Complex* out, Complex* scratchIn, Complex* scratchOut) const {
+    for (size_t i = 0; i < m_size; ++i) {
+        scratchIn[i] = { in[i], 0.0f };
+    }
+    forward(scratchIn, scratchOut);
+    for (size_t i = 0; i <= m_size / 2; ++i) {
+        out[i] = scratchOut[i];
+    }
+}
+
+}}}
@@ -0,0 +1,45 @@
+#ifndef WORKER_CPU_FFT_HPP
+#define WORKER_CPU_FFT_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace app { namespace worker { namespace cpu {
+
+struct Complex {
+    float re;
+    float im;
+};
+
+/**
+ * Generic mixed-radix forward FFT (radix 4/2 butterflies, generic odd radices).
+ * The plan is immutable after construction, so one plan can be shared by several engines.
+ */
+class FftPlan {
+private:
+    size_t m_size;
+    std::vector<Complex> m_twiddles;
+    // (radix, stride) pairs, outermost stage first
+    std::vector<size_t> m_factors;
+
+    void work(Complex* out, const Complex* in, size_t fstride, const size_t* factors, Complex* scratch) const;
+    void butterfly2(Complex* out, size_t fstride, size_t m) const;
+    void butterfly4(Complex* out, size_t fstride, size_t m) const;
+    void butterflyGeneric(Complex* out, size_t fstride, size_t m, size_t p, Complex* scratch) const;
+
+public:
+    explicit FftPlan(size_t size);
+
+    size_t size() const { return m_size; }
+
+    // out-of-place transform, both buffers hold size() elements
+    void forward(const Complex* in, Complex* out) const;
+
+    // Real input transform. Writes size() / 2 + 1 bins to out.
+    // scratchIn / scratchOut must hold size() elements each.
+    void forwardReal(const float* in, Complex* out, Complex* scratchIn, Complex* scratchOut) const;
+};
+
+}}}
+
+#endif
@@ -0,0 +1,70 @@
+#include "MelEngine.hpp"
+#include <cmath>
+
+namespace app { namespace worker { namespace cpu {
+
+MelEngine::MelEngine(const MelKernels& kernels)
+    : m_kernels(kernels)
+    , m_fft(N_FFT)
+    , m_window(N_FFT)
+    , m_frames(FRAME_BLOCK * N_FFT)
+    , m_fftIn(N_FFT)
+    , m_fftOut(N_FFT)
+    , m_spectrum(N_FFT_HALF)
+    , m_power(FRAME_BLOCK * N_FFT_HALF)
+    , m_melOut(FRAME_BLOCK)
+{
+    // Periodic Hann window (torch.hann_window default), same as the CUDA backend
+    for (int i = 0; i < N_FFT; ++i) {
+        m_window[i] = (float)(0.5 * (1.0 - std::cos(2.0 * M_PI * i / N_FFT)));
+    }
+}
+
+size_t MelEngine::compute(const float* audio, size_t numSamples, float* outMel) {
+    MelJob job{audio, numSamples, outMel};
+    return computeBatch(&job, 1);
+}
+
+size_t MelEngine::computeBatch(const MelJob* jobs, size_t count) {
+    size_t total = 0;
+    size_t job = 0;
+    size_t frame = 0;
+
+    while (true) {
+        // Gather the next block of frames, possibly spanning several jobs
+        size_t block = 0;
+        while (block < FRAME_BLOCK && job < count) {
+            if (frame >= numFrames(jobs[job].numSamples)) {
+                ++job;
+                frame = 0;
+                continue;
+            }
+            m_kernels.applyWindow(jobs[job].audio + frame * HOP_LENGTH, m_window.data(), m_frames.data() + block * N_FFT, N_FFT);
+            m_melOut[block] = jobs[job].outMel + frame * N_MELS;
+            ++frame;
+            ++block;
+        }
+        if (block == 0) break;
+
+        if (m_kernels.framePower) {
+            m_kernels.framePower(m_frames.data(), m_power.data(), block);
+        } else {
+            for (size_t b = 0; b < block; ++b) {
+                m_fft.forwardReal(m_frames.data() + b * N_FFT, m_spectrum.data(), m_fftIn.data(), m_fftOut.data());
+                m_kernels.powerSpectrum(reinterpret_cast<const float*>(m_spectrum.data()), m_power.data() + b * N_FFT_HALF, N_FFT_HALF);
+            }
+        }
+        for (size_t b = 0; b < block; ++b) {
+            m_kernels.melFilterbank(m_power.data() + b * N_FFT_HALF, MEL_FILTERBANK.bands, MEL_FILTERBANK.weights, m_melOut[b], N_MELS);
+        }
+        total += block;
+    }
+
+    // Outputs are contiguous per job
+    for (size_t j = 0; j < count; ++j) {
+        m_kernels.log10Clamp(jobs[j].outMel, numFrames(jobs[j].numSamples) * N_MELS, LOG_MEL_FLOOR);
+    }
+    return total;
+}
+
+}}}
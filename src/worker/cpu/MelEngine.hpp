@@ -0,0 +1,54 @@
+#ifndef WORKER_CPU_MEL_ENGINE_HPP
+#define WORKER_CPU_MEL_ENGINE_HPP
+
+#include "worker/AudioParams.hpp"
+#include "worker/MelFilterbank.hpp"
+#include "Fft.hpp"
+#include "MelKernels.hpp"
+#include <vector>
+
+namespace app { namespace worker { namespace cpu {
+
+/**
+ * CPU log-mel pipeline, identical to the CUDA one:
+ * Hann(400) window -> R2C FFT -> |X|^2 -> 80-band sparse Slaney mel -> log10(max(x, 1e-10)).
+ * Holds scratch buffers, so one engine per thread.
+ */
+class MelEngine {
+private:
+    const MelKernels& m_kernels;
+    FftPlan m_fft;
+    std::vector<float> m_window;
+
+    std::vector<float> m_frames;      // FRAME_BLOCK windowed frames
+    std::vector<Complex> m_fftIn;
+    std::vector<Complex> m_fftOut;
+    std::vector<Complex> m_spectrum;
+    std::vector<float> m_power;       // FRAME_BLOCK power spectra
+    std::vector<float*> m_melOut;     // destination of each frame in the block
+
+public:
+    // Frames pushed through each stage together, whichever job they come from
+    static constexpr size_t FRAME_BLOCK = 32;
+
+    explicit MelEngine(const MelKernels& kernels = selectKernels());
+
+    const MelKernels& kernels() const { return m_kernels; }
+
+    /**
+     * Computes numFrames(numSamples) frames into outMel, frame-major (N_MELS floats per frame).
+     * Returns the number of frames written.
+     */
+    size_t compute(const float* audio, size_t numSamples, float* outMel);
+
+    /**
+     * Same as compute() for several inputs in one pass: frames of all jobs are
+     * windowed, transformed and filtered block by block, each landing straight
+     * in its job's output. Returns the total number of frames.
+     */
+    size_t computeBatch(const MelJob* jobs, size_t count);
+};
+
+}}}
+
+#endif
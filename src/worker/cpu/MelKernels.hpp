@@ -0,0 +1,47 @@
+#ifndef WORKER_CPU_MEL_KERNELS_HPP
+#define WORKER_CPU_MEL_KERNELS_HPP
+
+#include "worker/MelFilterbank.hpp"
+#include <cstddef>
+
+namespace app { namespace worker { namespace cpu {
+
+/**
+ * Per-stage kernels of the log-mel pipeline.
+ * One table per instruction set; selectKernels() picks the best one for the running CPU.
+ */
+struct MelKernels {
+    const char* name;
+
+    // out[i] = frame[i] * window[i]
+    void (*applyWindow)(const float* frame, const float* window, float* out, size_t n);
+
+    // power[k] = re^2 + im^2 for interleaved complex input
+    void (*powerSpectrum)(const float* spectrum, float* power, size_t bins);
+
+    // mel[m] = sum_i weights[bands[m].offset + i] * power[bands[m].start + i]
+    void (*melFilterbank)(const float* power, const MelBand* bands, const float* weights, float* mel, size_t mels);
+
+    // data[i] = log10(max(data[i], floor))
+    void (*log10Clamp)(float* data, size_t n, float floor);
+
+    // power[f * N_FFT_HALF + k] = |FFT(frames[f * N_FFT ..])[k]|^2 for `count` windowed frames.
+    // Specialised transform for N_FFT (RealFft.hpp); nullptr when N_FFT has none.
+    void (*framePower)(const float* frames, float* power, size_t count);
+};
+
+const MelKernels& scalarKernels();
+
+#if defined(WHISPER_HAVE_AVX2)
+// Only safe to call when the CPU reports AVX2 + FMA
+const MelKernels& avx2Kernels();
+#endif
+
+bool cpuSupportsAvx2();
+
+// Best kernel table for the host, resolved once.
+const MelKernels& selectKernels();
+
+}}}
+
+#endif
@@ -0,0 +1,216 @@
+// Compiled with -mavx2 -mfma (see CMakeLists.txt). Nothing in here may run
+// before cpuSupportsAvx2() has confirmed the host can execute it.
+//
+// Everything defined here stays internal (anonymous namespace, templates only over
+// Avx2Ops). An inline function shared with other TUs, such as std::log10(float), would be
+// emitted here as a weak copy built with AVX, and the linker may keep that one for the
+// scalar kernels too. So the tail calls libm's log10f, not the <cmath> overload.
+#include "MelKernels.hpp"
+#include "RealFft.hpp"
+#include <immintrin.h>
+#include <math.h>
+
+namespace app { namespace worker { namespace cpu {
+
+namespace {
+
+inline float horizontalSum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    __m128 shuf = _mm_movehdup_ps(lo);
+    __m128 sums = _mm_add_ps(lo, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+// Natural log for positive, normal inputs (Cephes logf polynomial, ~1 ulp).
+inline __m256 logPositive(__m256 x) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    __m256i bits = _mm256_castps_si256(x);
+    __m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126));
+    // mantissa in [0.5, 1)
+    bits = _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff));
+    bits = _mm256_or_si256(bits, _mm256_castps_si256(half));
+    x = _mm256_castsi256_ps(bits);
+
+    __m256 e = _mm256_cvtepi32_ps(exponent);
+
+    // if (x < SQRTHF) { e -= 1; x = x + x - 1 } else { x = x - 1 }
+    __m256 mask = _mm256_cmp_ps(x, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+    __m256 tmp = _mm256_and_ps(x, mask);
+    x = _mm256_sub_ps(x, one);
+    e = _mm256_sub_ps(e, _mm256_and_ps(one, mask));
+    x = _mm256_add_ps(x, tmp);
+
+    __m256 z = _mm256_mul_ps(x, x);
+
+    __m256 y = _mm256_set1_ps(7.0376836292e-2f);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.1514610310e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.1676998740e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.2420140846e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.4249322787e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.6668057665e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(2.0000714765e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-2.4999993993e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(3.3333331174e-1f));
+    y = _mm256_mul_ps(y, x);
+    y = _mm256_mul_ps(y, z);
+
+    y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+    y = _mm256_fnmadd_ps(z, half, y);
+
+    x = _mm256_add_ps(x, y);
+    x = _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), x);
+    return x;
+}
+
+void applyWindowAvx2(const float* frame, const float* window, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 f = _mm256_loadu_ps(frame + i);
+        __m256 w = _mm256_loadu_ps(window + i);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(f, w));
+    }
+    for (; i < n; ++i) {
+        out[i] = frame[i] * window[i];
+    }
+}
+
+void powerSpectrumAvx2(const float* spectrum, float* power, size_t bins) {
+    size_t k = 0;
+    for (; k + 8 <= bins; k += 8) {
+        __m256 a = _mm256_loadu_ps(spectrum + 2 * k);
+        __m256 b = _mm256_loadu_ps(spectrum + 2 * k + 8);
+        a = _mm256_mul_ps(a, a);
+        b = _mm256_mul_ps(b, b);
+        // hadd pairs within 128-bit lanes: [a01 a23 b01 b23 | a45 a67 b45 b67]
+        __m256 s = _mm256_hadd_ps(a, b);
+        // restore bin order: [a01 a23 a45 a67 b01 b23 b45 b67]
+        s = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(s), 0xD8));
+        _mm256_storeu_ps(power + k, s);
+    }
+    for (; k < bins; ++k) {
+        float re = spectrum[2 * k];
+        float im = spectrum[2 * k + 1];
+        power[k] = re * re + im * im;
+    }
+}
+
+void melFilterbankAvx2(const float* power, const MelBand* bands, const float* weights, float* mel, size_t mels) {
+    // Bands are at most ~14 bins wide: one or two 8-wide FMAs plus a short tail
+    for (size_t m = 0; m < mels; ++m) {
+        const float* w = weights + bands[m].offset;
+        const float* p = power + bands[m].start;
+        const size_t length = bands[m].length;
+        __m256 acc = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= length; i += 8) {
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(w + i), _mm256_loadu_ps(p + i), acc);
+        }
+        float sum = horizontalSum(acc);
+        for (; i < length; ++i) {
+            sum += w[i] * p[i];
+        }
+        mel[m] = sum;
+    }
+}
+
+void log10ClampAvx2(float* data, size_t n, float floor) {
+    const __m256 vFloor = _mm256_set1_ps(floor);
+    const __m256 invLn10 = _mm256_set1_ps(0.434294481903251827651f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_max_ps(_mm256_loadu_ps(data + i), vFloor);
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(logPositive(v), invLn10));
+    }
+    for (; i < n; ++i) {
+        float v = data[i] < floor ? floor : data[i];
+        data[i] = log10f(v);
+    }
+}
+
+// 8x8 transpose: r[l][j] -> r[j][l]
+inline void transpose8(__m256* r) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+    __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+// Eight frames per vector, one per lane
+struct Avx2Ops {
+    using V = __m256;
+    static constexpr size_t LANES = 8;
+
+    static V set1(float x) { return _mm256_set1_ps(x); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+
+    static void loadTransposed(const float* const* rows, size_t col, V* out) {
+        for (size_t l = 0; l < LANES; ++l) {
+            out[l] = _mm256_loadu_ps(rows[l] + col);
+        }
+        transpose8(out);
+    }
+
+    static void storeTransposed(const V* in, float* const* rows, size_t col) {
+        __m256 r[LANES];
+        for (size_t l = 0; l < LANES; ++l) r[l] = in[l];
+        transpose8(r);
+        for (size_t l = 0; l < LANES; ++l) {
+            _mm256_storeu_ps(rows[l] + col, r[l]);
+        }
+    }
+
+    static void storeLanes(V v, float* const* rows, size_t col) {
+        alignas(32) float lanes[LANES];
+        _mm256_store_ps(lanes, v);
+        for (size_t l = 0; l < LANES; ++l) {
+            rows[l][col] = lanes[l];
+        }
+    }
+};
+
+const MelKernels AVX2_KERNELS = {
+    "avx2",
+    &applyWindowAvx2,
+    &powerSpectrumAvx2,
+    &melFilterbankAvx2,
+    &log10ClampAvx2,
+    framePowerKernel<Avx2Ops>()
+};
+
+}
+
+const MelKernels& avx2Kernels() {
+    return AVX2_KERNELS;
+}
+
+}}}
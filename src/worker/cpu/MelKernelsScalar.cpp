@@ -0,0 +1,100 @@
+#include "MelKernels.hpp"
+#include "RealFft.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace app { namespace worker { namespace cpu {
+
+namespace {
+
+void applyWindowScalar(const float* frame, const float* window, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = frame[i] * window[i];
+    }
+}
+
+void powerSpectrumScalar(const float* spectrum, float* power, size_t bins) {
+    for (size_t k = 0; k < bins; ++k) {
+        float re = spectrum[2 * k];
+        float im = spectrum[2 * k + 1];
+        power[k] = re * re + im * im;
+    }
+}
+
+void melFilterbankScalar(const float* power, const MelBand* bands, const float* weights, float* mel, size_t mels) {
+    for (size_t m = 0; m < mels; ++m) {
+        const float* w = weights + bands[m].offset;
+        const float* p = power + bands[m].start;
+        float sum = 0.0f;
+        for (size_t i = 0; i < bands[m].length; ++i) {
+            sum += w[i] * p[i];
+        }
+        mel[m] = sum;
+    }
+}
+
+void log10ClampScalar(float* data, size_t n, float floor) {
+    for (size_t i = 0; i < n; ++i) {
+        float v = data[i] < floor ? floor : data[i];
+        data[i] = std::log10(v);
+    }
+}
+
+// One frame per "lane"
+struct ScalarOps {
+    using V = float;
+    static constexpr size_t LANES = 1;
+
+    static V set1(float x) { return x; }
+    static V add(V a, V b) { return a + b; }
+    static V sub(V a, V b) { return a - b; }
+    static V mul(V a, V b) { return a * b; }
+
+    static void loadTransposed(const float* const* rows, size_t col, V* out) { out[0] = rows[0][col]; }
+    static void storeTransposed(const V* in, float* const* rows, size_t col) { rows[0][col] = in[0]; }
+    static void storeLanes(V v, float* const* rows, size_t col) { rows[0][col] = v; }
+};
+
+const MelKernels SCALAR_KERNELS = {
+    "scalar",
+    &applyWindowScalar,
+    &powerSpectrumScalar,
+    &melFilterbankScalar,
+    &log10ClampScalar,
+    framePowerKernel<ScalarOps>()
+};
+
+}
+
+const MelKernels& scalarKernels() {
+    return SCALAR_KERNELS;
+}
+
+bool cpuSupportsAvx2() {
+#if defined(WHISPER_HAVE_AVX2)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+const MelKernels& selectKernels() {
+    static const MelKernels& selected = []() -> const MelKernels& {
+        // WHISPER_CPU_KERNELS=scalar pins the portable path (useful when bisecting numeric issues)
+        const char* forced = std::getenv("WHISPER_CPU_KERNELS");
+        if (forced && std::strcmp(forced, "scalar") == 0) {
+            return scalarKernels();
+        }
+#if defined(WHISPER_HAVE_AVX2)
+        if (cpuSupportsAvx2()) {
+            return avx2Kernels();
+        }
+#endif
+        return scalarKernels();
+    }();
+    return selected;
+}
+
+}}}
@@ -0,0 +1,272 @@
+#ifndef WORKER_CPU_REAL_FFT_HPP
+#define WORKER_CPU_REAL_FFT_HPP
+
+#include "worker/AudioParams.hpp"
+#include <cstddef>
+
+namespace app { namespace worker { namespace cpu {
+
+/**
+ * Power spectra of a block of windowed real frames: power[f * (N/2 + 1) + k] = |X_f[k]|^2.
+ *
+ * Only specialised sizes provide run(); everything else goes through the generic
+ * FftPlan (MelEngine checks `specialized`). Ops is the lane type of the ISA the
+ * kernel is compiled for:
+ *
+ *   using V;  static constexpr size_t LANES;
+ *   V set1(float);  V add(V, V);  V sub(V, V);  V mul(V, V);
+ *   void loadTransposed(const float* const* rows, size_t col, V* out);   // out[j][l] = rows[l][col + j]
+ *   void storeTransposed(const V* in, float* const* rows, size_t col);   // rows[l][col + j] = in[j][l]
+ *   void storeLanes(V v, float* const* rows, size_t col);                // rows[l][col] = v[l]
+ *
+ * One lane = one frame, so every butterfly works on LANES frames at once and
+ * there is no shuffling inside the transform itself.
+ */
+template<size_t N, typename Ops>
+struct RealFftPower {
+    static constexpr bool specialized = false;
+};
+
+namespace fftdetail {
+
+constexpr double PI = 3.14159265358979323846264338327950288;
+
+// sin/cos of 2*pi*num/den. <cmath> isn't constexpr; Taylor after reduction to [-pi, pi] is plenty for float tables.
+constexpr double reducedAngle(long num, long den) {
+    num %= den;
+    if (2 * num > den) num -= den;
+    return 2.0 * PI * (double)num / (double)den;
+}
+
+constexpr double constSin(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 20; ++n) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constCos(double x) {
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 20; ++n) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+// W_N^t = exp(-2*pi*i * t / N), t in [0, COUNT)
+template<size_t N, size_t COUNT = N>
+struct Twiddles {
+    float re[COUNT];
+    float im[COUNT];
+};
+
+template<size_t N, size_t COUNT = N>
+constexpr Twiddles<N, COUNT> makeTwiddles() {
+    Twiddles<N, COUNT> table{};
+    for (size_t t = 0; t < COUNT; ++t) {
+        double angle = reducedAngle((long)t, (long)N);
+        table.re[t] = (float)constCos(angle);
+        table.im[t] = (float)-constSin(angle);
+    }
+    return table;
+}
+
+}
+
+/**
+ * N = 400 = 2 * 200, 200 = 4 * 2 * 5 * 5.
+ *
+ * Real input is packed as z[n] = x[2n] + i x[2n+1], so the complex work is a
+ * 200-point transform: Stockham autosort stages of radix 4, 2, 5, 5 with
+ * compile-time twiddles, then the usual split X[k] = E[k] + W_400^k O[k]
+ * straight into |X[k]|^2.
+ */
+template<typename Ops>
+struct RealFftPower<400, Ops> {
+    static constexpr bool specialized = true;
+
+private:
+    using V = typename Ops::V;
+    static constexpr size_t N = 400;
+    static constexpr size_t H = N / 2;
+    static constexpr size_t BINS = H + 1;
+    static constexpr size_t L = Ops::LANES;
+
+    static_assert(N % L == 0 && H % L == 0, "lane count must divide the frame");
+
+    static constexpr fftdetail::Twiddles<H> W_H = fftdetail::makeTwiddles<H>();
+    static constexpr fftdetail::Twiddles<N, BINS> W_N = fftdetail::makeTwiddles<N, BINS>();
+
+    // cos/sin(2*pi/5), cos/sin(4*pi/5)
+    static constexpr float C1 = (float)fftdetail::constCos(2.0 * fftdetail::PI / 5.0);
+    static constexpr float C2 = (float)fftdetail::constCos(4.0 * fftdetail::PI / 5.0);
+    static constexpr float S1 = (float)fftdetail::constSin(2.0 * fftdetail::PI / 5.0);
+    static constexpr float S2 = (float)fftdetail::constSin(4.0 * fftdetail::PI / 5.0);
+
+    // (x + iy) * (wr + i wi)
+    static void twiddle(V& re, V& im, float wr, float wi) {
+        V wrV = Ops::set1(wr);
+        V wiV = Ops::set1(wi);
+        V r = Ops::sub(Ops::mul(re, wrV), Ops::mul(im, wiV));
+        im = Ops::add(Ops::mul(re, wiV), Ops::mul(im, wrV));
+        re = r;
+    }
+
+    static void butterfly2(V* re, V* im) {
+        V r = Ops::sub(re[0], re[1]);
+        V i = Ops::sub(im[0], im[1]);
+        re[0] = Ops::add(re[0], re[1]);
+        im[0] = Ops::add(im[0], im[1]);
+        re[1] = r;
+        im[1] = i;
+    }
+
+    static void butterfly4(V* re, V* im) {
+        V s0r = Ops::add(re[0], re[2]), s0i = Ops::add(im[0], im[2]);
+        V d0r = Ops::sub(re[0], re[2]), d0i = Ops::sub(im[0], im[2]);
+        V s1r = Ops::add(re[1], re[3]), s1i = Ops::add(im[1], im[3]);
+        V d1r = Ops::sub(re[1], re[3]), d1i = Ops::sub(im[1], im[3]);
+
+        re[0] = Ops::add(s0r, s1r); im[0] = Ops::add(s0i, s1i);
+        re[2] = Ops::sub(s0r, s1r); im[2] = Ops::sub(s0i, s1i);
+        // d0 -/+ i * d1
+        re[1] = Ops::add(d0r, d1i); im[1] = Ops::sub(d0i, d1r);
+        re[3] = Ops::sub(d0r, d1i); im[3] = Ops::add(d0i, d1r);
+    }
+
+    static void butterfly5(V* re, V* im) {
+        V c1 = Ops::set1(C1), c2 = Ops::set1(C2), s1 = Ops::set1(S1), s2 = Ops::set1(S2);
+
+        V t1r = Ops::add(re[1], re[4]), t1i = Ops::add(im[1], im[4]);
+        V t2r = Ops::add(re[2], re[3]), t2i = Ops::add(im[2], im[3]);
+        V t3r = Ops::sub(re[1], re[4]), t3i = Ops::sub(im[1], im[4]);
+        V t4r = Ops::sub(re[2], re[3]), t4i = Ops::sub(im[2], im[3]);
+
+        V u1r = Ops::add(re[0], Ops::add(Ops::mul(c1, t1r), Ops::mul(c2, t2r)));
+        V u1i = Ops::add(im[0], Ops::add(Ops::mul(c1, t1i), Ops::mul(c2, t2i)));
+        V u2r = Ops::add(re[0], Ops::add(Ops::mul(c2, t1r), Ops::mul(c1, t2r)));
+        V u2i = Ops::add(im[0], Ops::add(Ops::mul(c2, t1i), Ops::mul(c1, t2i)));
+        V v1r = Ops::add(Ops::mul(s1, t3r), Ops::mul(s2, t4r));
+        V v1i = Ops::add(Ops::mul(s1, t3i), Ops::mul(s2, t4i));
+        V v2r = Ops::sub(Ops::mul(s2, t3r), Ops::mul(s1, t4r));
+        V v2i = Ops::sub(Ops::mul(s2, t3i), Ops::mul(s1, t4i));
+
+        re[0] = Ops::add(re[0], Ops::add(t1r, t2r));
+        im[0] = Ops::add(im[0], Ops::add(t1i, t2i));
+        // b1 = u1 - i v1, b4 = u1 + i v1, b2 = u2 - i v2, b3 = u2 + i v2
+        re[1] = Ops::add(u1r, v1i); im[1] = Ops::sub(u1i, v1r);
+        re[4] = Ops::sub(u1r, v1i); im[4] = Ops::add(u1i, v1r);
+        re[2] = Ops::add(u2r, v2i); im[2] = Ops::sub(u2i, v2r);
+        re[3] = Ops::sub(u2r, v2i); im[3] = Ops::add(u2i, v2r);
+    }
+
+    // One Stockham DIF stage: sub-length n, stride s (n * s == H), radix R
+    template<size_t n, size_t s, size_t R>
+    static void stage(const V* xr, const V* xi, V* yr, V* yi) {
+        constexpr size_t m = n / R;
+        constexpr size_t twStep = H / n;
+        V re[R], im[R];
+        for (size_t p = 0; p < m; ++p) {
+            for (size_t q = 0; q < s; ++q) {
+                for (size_t j = 0; j < R; ++j) {
+                    re[j] = xr[q + s * (p + j * m)];
+                    im[j] = xi[q + s * (p + j * m)];
+                }
+
+                if constexpr (R == 2) butterfly2(re, im);
+                else if constexpr (R == 4) butterfly4(re, im);
+                else butterfly5(re, im);
+
+                yr[q + s * R * p] = re[0];
+                yi[q + s * R * p] = im[0];
+                for (size_t k = 1; k < R; ++k) {
+                    if (p != 0) {
+                        size_t t = (p * k * twStep) % H;
+                        twiddle(re[k], im[k], W_H.re[t], W_H.im[t]);
+                    }
+                    yr[q + s * (R * p + k)] = re[k];
+                    yi[q + s * (R * p + k)] = im[k];
+                }
+            }
+        }
+    }
+
+public:
+    // frames: count * N windowed samples, power: count * (N/2 + 1)
+    static void run(const float* frames, float* power, size_t count) {
+        V re0[H], im0[H], re1[H], im1[H];
+        V group[L];
+        float spare[L][BINS];
+        const float* in[L];
+        float* out[L];
+
+        for (size_t f = 0; f < count; f += L) {
+            // A short last group repeats its last frame and throws the extra lanes away
+            for (size_t l = 0; l < L; ++l) {
+                size_t frame = f + l < count ? f + l : count - 1;
+                in[l] = frames + frame * N;
+                out[l] = f + l < count ? power + frame * BINS : spare[l];
+            }
+
+            // z[n] = x[2n] + i x[2n + 1]
+            for (size_t c = 0; c < N; c += L) {
+                Ops::loadTransposed(in, c, group);
+                for (size_t j = 0; j < L; ++j) {
+                    size_t idx = c + j;
+                    if (idx & 1) im0[idx >> 1] = group[j];
+                    else re0[idx >> 1] = group[j];
+                }
+            }
+
+            stage<200, 1, 4>(re0, im0, re1, im1);
+            stage<50, 4, 2>(re1, im1, re0, im0);
+            stage<25, 8, 5>(re0, im0, re1, im1);
+            stage<5, 40, 5>(re1, im1, re0, im0);
+
+            // X[k] = E[k] + W_N^k O[k], E = (Z[k] + Z*[H-k]) / 2, O = -i (Z[k] - Z*[H-k]) / 2
+            V half = Ops::set1(0.5f);
+            for (size_t k0 = 0; k0 < BINS; k0 += L) {
+                size_t lanes = k0 + L <= BINS ? L : BINS - k0;
+                for (size_t j = 0; j < lanes; ++j) {
+                    size_t k = k0 + j;
+                    size_t a = k % H;
+                    size_t b = (H - k) % H;
+                    V er = Ops::mul(half, Ops::add(re0[a], re0[b]));
+                    V ei = Ops::mul(half, Ops::sub(im0[a], im0[b]));
+                    V orr = Ops::mul(half, Ops::add(im0[a], im0[b]));
+                    V oi = Ops::mul(half, Ops::sub(re0[b], re0[a]));
+                    twiddle(orr, oi, W_N.re[k], W_N.im[k]);
+                    V xr = Ops::add(er, orr);
+                    V xi = Ops::add(ei, oi);
+                    group[j] = Ops::add(Ops::mul(xr, xr), Ops::mul(xi, xi));
+                }
+                if (lanes == L) {
+                    Ops::storeTransposed(group, out, k0);
+                } else {
+                    for (size_t j = 0; j < lanes; ++j) {
+                        Ops::storeLanes(group[j], out, k0 + j);
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Kernel-table entry for N_FFT: the specialised transform, or nullptr (generic FftPlan path).
+template<typename Ops>
+constexpr auto framePowerKernel() -> void (*)(const float*, float*, size_t) {
+    if constexpr (RealFftPower<N_FFT, Ops>::specialized) {
+        return &RealFftPower<N_FFT, Ops>::run;
+    } else {
+        return nullptr;
+    }
+}
+
+}}}
+
+#endif
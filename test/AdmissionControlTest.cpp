@@ -0,0 +1,90 @@
+#include "AdmissionControlTest.hpp"
+#include "service/AdmissionControl.hpp"
+
+namespace app { namespace test {
+
+using namespace app::service;
+
+namespace {
+
+constexpr uint64_t MS = 1000 * 1000;
+constexpr uint64_t S = 1000 * MS;
+
+}
+
+void AdmissionControlTest::onRun() {
+    OATPP_LOGI(TAG, "Testing queue-wait budgets...");
+    {
+        AdmissionControl::Config config;
+        config.budgetMs[AdmissionControl::ROUTE_PROCESS] = 100;
+        config.budgetMs[AdmissionControl::ROUTE_AUDIO] = 1000;
+        config.budgetMs[AdmissionControl::ROUTE_STREAM] = 0;
+        AdmissionControl admission(nullptr, config);
+
+        // 40 tasks x 20 ms over 4 workers = 200 ms of queue
+        OATPP_ASSERT(admission.estimatedWaitNs(40, 20 * MS, 4) == 200 * MS);
+        // Twice the workers after a scale-up, half the wait
+        OATPP_ASSERT(admission.estimatedWaitNs(40, 20 * MS, 8) == 100 * MS);
+
+        auto d = admission.check(AdmissionControl::ROUTE_PROCESS, "a", 40, 20 * MS, 4, 0);
+        OATPP_ASSERT(!d.admitted);
+        OATPP_ASSERT(d.retryAfterSeconds == 1);
+        OATPP_ASSERT(admission.check(AdmissionControl::ROUTE_AUDIO, "a", 40, 20 * MS, 4, 0).admitted);
+        OATPP_ASSERT(admission.check(AdmissionControl::ROUTE_STREAM, "a", 100000, 20 * MS, 4, 0).admitted);
+
+        // Retry-After is the time to drain back under budget: 5 s over -> 5 s
+        d = admission.check(AdmissionControl::ROUTE_AUDIO, "a", 1200, 20 * MS, 4, 0);
+        OATPP_ASSERT(!d.admitted);
+        OATPP_ASSERT(d.retryAfterSeconds == 5);
+
+        // No answer seen yet: nothing to estimate from
+        OATPP_ASSERT(admission.check(AdmissionControl::ROUTE_PROCESS, "a", 1000, 0, 4, 0).admitted);
+    }
+
+    OATPP_LOGI(TAG, "Testing per-client token buckets...");
+    {
+        AdmissionControl::Config config;
+        config.clientRate = 2;
+        config.clientBurst = 3;
+        AdmissionControl admission(nullptr, config);
+        auto check = [&](const char* client, uint64_t now) {
+            return admission.check(AdmissionControl::ROUTE_PROCESS, client, 0, 0, 1, now);
+        };
+
+        for (int i = 0; i < 3; ++i) {
+            OATPP_ASSERT(check("greedy", 0).admitted);
+        }
+        auto d = check("greedy", 0);
+        OATPP_ASSERT(!d.admitted);
+        OATPP_ASSERT(d.retryAfterSeconds == 1);
+
+        // Others are unaffected
+        OATPP_ASSERT(check("polite", 0).admitted);
+
+        // 2 tokens/s: one back after 500 ms, not before
+        OATPP_ASSERT(!check("greedy", 400 * MS).admitted);
+        OATPP_ASSERT(check("greedy", 500 * MS).admitted);
+        OATPP_ASSERT(!check("greedy", 500 * MS).admitted);
+
+        // Refill caps at the burst
+        for (int i = 0; i < 3; ++i) {
+            OATPP_ASSERT(check("greedy", 100 * S).admitted);
+        }
+        OATPP_ASSERT(!check("greedy", 100 * S).admitted);
+        OATPP_ASSERT(admission.trackedClients() == 2);
+    }
+
+    OATPP_LOGI(TAG, "Testing that shed requests cost no tokens...");
+    {
+        AdmissionControl::Config config;
+        config.budgetMs[AdmissionControl::ROUTE_PROCESS] = 10;
+        config.clientRate = 1;
+        config.clientBurst = 1;
+        AdmissionControl admission(nullptr, config);
+
+        OATPP_ASSERT(!admission.check(AdmissionControl::ROUTE_PROCESS, "c", 10, 10 * MS, 1, 0).admitted);
+        OATPP_ASSERT(admission.check(AdmissionControl::ROUTE_PROCESS, "c", 0, 10 * MS, 1, 0).admitted);
+    }
+}
+
+}}
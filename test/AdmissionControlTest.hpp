@@ -0,0 +1,16 @@
+#ifndef AdmissionControlTest_hpp
+#define AdmissionControlTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test {
+
+class AdmissionControlTest : public oatpp::test::UnitTest {
+public:
+    AdmissionControlTest() : oatpp::test::UnitTest("TEST[AdmissionControlTest]") {}
+    void onRun() override;
+};
+
+}}
+
+#endif
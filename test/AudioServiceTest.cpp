@@ -1,13 +1,108 @@
 #include "AudioServiceTest.hpp"
 #include "service/AudioService.hpp"
+#include "service/FeatureStream.hpp"
+#include "service/LiveStream.hpp"
+#include "oatpp/core/async/Executor.hpp"
 #include "worker/WorkerManager.hpp"
 #include "worker/WorkerMain.hpp"
+#include "exception/AppExceptions.hpp"
+#include "utils/FloatJson.hpp"
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <thread>
 #include <vector>
+#include <atomic>
+#include <algorithm>
+#include <memory>
 
 namespace app { namespace test {
 
+namespace {
+
+// Writing side of a FeatureStream / LiveStream: writes the PCM in ragged pieces
+template<class Stream>
+class BodyWriter : public oatpp::async::Coroutine<BodyWriter<Stream>> {
+private:
+    std::shared_ptr<Stream> m_stream;
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+public:
+    BodyWriter(const std::shared_ptr<Stream>& stream, const uint8_t* data, size_t size)
+        : m_stream(stream), m_data(data), m_size(size) {}
+
+    oatpp::async::Action act() override {
+        if (m_pos == m_size) {
+            m_stream->finish();
+            return this->finish();
+        }
+        oatpp::async::Action action;
+        m_pos += m_stream->write(m_data + m_pos, std::min(m_size - m_pos, (size_t)1111), action);
+        if (!action.isNone()) {
+            return action;
+        }
+        return this->repeat();
+    }
+};
+
+// Reading side: collects chunks in order
+template<class Stream>
+class ChunkCollector : public oatpp::async::Coroutine<ChunkCollector<Stream>> {
+private:
+    std::shared_ptr<Stream> m_stream;
+    std::vector<float>* m_features;
+    std::atomic<bool>* m_ended;
+public:
+    ChunkCollector(const std::shared_ptr<Stream>& stream, std::vector<float>* features, std::atomic<bool>* ended)
+        : m_stream(stream), m_features(features), m_ended(ended) {}
+
+    oatpp::async::Action act() override {
+        oatpp::async::Action action;
+        app::service::StreamChunk chunk;
+        switch (m_stream->next(chunk, action)) {
+            case Stream::Next::FEATURES:
+                OATPP_ASSERT(chunk.frameOffset * app::worker::N_MELS == m_features->size());
+                m_features->insert(m_features->end(), chunk.features.data(), chunk.features.data() + chunk.features.count);
+                return this->repeat();
+            case Stream::Next::WAIT:
+                return action;
+            case Stream::Next::END:
+                *m_ended = true;
+                return this->finish();
+            default:
+                return this->finish();
+        }
+    }
+};
+
+// Features of a whole body computed by a single task: what any chunking must match exactly
+app::service::MelFeatures oneTask(const std::shared_ptr<app::worker::WorkerManager>& manager, const oatpp::String& body) {
+    app::service::FeatureUpload upload(manager, body->size() / 2, 1);
+    OATPP_ASSERT(upload.write(body->data(), body->size()) == body->size());
+    upload.finish();
+    upload.oldest()->wait();
+    app::service::MelFeatures features;
+    OATPP_ASSERT(upload.takeReady(features) && upload.done());
+    return features;
+}
+
+// Takes every chunk of a finished upload, in order
+std::vector<float> drain(app::service::FeatureUpload& upload) {
+    std::vector<float> features;
+    app::service::MelFeatures chunk;
+    while (!upload.done()) {
+        if (upload.takeReady(chunk)) {
+            features.insert(features.end(), chunk.data(), chunk.data() + chunk.count);
+        } else {
+            upload.oldest()->wait();
+        }
+    }
+    return features;
+}
+
+}
+
 void AudioServiceTest::onRun() {
     // 1. Setup Host
     auto manager = std::make_shared<app::worker::WorkerManager>();
@@ -34,6 +129,33 @@ void AudioServiceTest::onRun() {
             OATPP_ASSERT(result == "egassem tset"); 
         }
 
+        {
+            // Test: worker statuses surface as the exceptions the error handler maps to HTTP codes
+            auto failWith = [&](uint32_t status) {
+                app::worker::TaskCompletion completion;
+                app::worker::TaskResult result;
+                result.resp.status_code = status;
+                completion.complete(std::move(result));
+                service.finishText(completion);
+            };
+            auto expect = [&](uint32_t status, auto tag) {
+                using Expected = decltype(tag);
+                try {
+                    failWith(status);
+                } catch (const Expected&) {
+                    return;
+                } catch (const std::exception& e) {
+                    OATPP_LOGE("Test", "Status %u: unexpected exception %s", status, e.what());
+                }
+                OATPP_ASSERT(false);
+            };
+            expect(413, app::exception::PayloadTooLargeException(""));
+            expect(499, app::exception::ServiceUnavailableException(""));
+            expect(503, app::exception::ServiceUnavailableException(""));
+            expect(504, app::exception::GatewayTimeoutException(""));
+            expect(400, std::runtime_error(""));
+        }
+
         {
             // Test: extractFeatures
             // Need > 400 samples. 401 samples = 802 bytes.
@@ -42,11 +164,304 @@ void AudioServiceTest::onRun() {
             
             auto features = service.extractFeatures(data);
             
-            // CpuMock returns input.size()/2 items. 
-            // 401 / 2 = 200 items.
-            OATPP_ASSERT(features->size() == 200);
-            OATPP_ASSERT(features->front() == 0.5f);
+            // 401 samples = one 400-sample STFT frame = 80 log-mel values.
+            OATPP_ASSERT(features.count == 80);
+            OATPP_ASSERT(features.frames() == 1);
+            for (size_t i = 0; i < features.count; ++i) {
+                OATPP_ASSERT(features.data()[i] >= -10.0f); // log10(1e-10) floor
+            }
+            std::string json;
+            app::utils::FloatJson::appendArray(json, features.data(), features.count);
+            OATPP_ASSERT(std::count(json.begin(), json.end(), ',') == 79);
+        }
+
+        {
+            // Test: an upload spreads over fanOut chunks at once and stitches to exactly the single-task result
+            std::vector<int16_t> samples(5 * 16000 + 1234);
+            for (size_t i = 0; i < samples.size(); ++i) {
+                samples[i] = (int16_t)(9000 * std::sin(0.013 * i) + 4000 * std::sin(0.47 * i + 0.001 * i * i / 16000));
+            }
+            oatpp::String whole(reinterpret_cast<const char*>(samples.data()), samples.size() * 2);
+            auto reference = oneTask(manager, whole);
+
+            app::service::AudioService fanned(manager, 4);
+            auto upload = fanned.openUpload();
+            size_t written = upload->write(whole->data(), whole->size());
+            OATPP_ASSERT(written < whole->size());
+            OATPP_ASSERT(upload->inFlight() == 4);
+
+            auto stitched = fanned.extractFeatures(whole);
+            OATPP_ASSERT(stitched.count == reference.count);
+            OATPP_ASSERT(stitched.frames() == app::worker::numFrames(samples.size()));
+            OATPP_ASSERT(std::memcmp(stitched.data(), reference.data(), reference.count * sizeof(float)) == 0);
+
+            app::service::AudioService serial(manager, 1);
+            auto one = serial.extractFeatures(whole);
+            OATPP_ASSERT(one.count == reference.count);
+            OATPP_ASSERT(std::memcmp(one.data(), reference.data(), reference.count * sizeof(float)) == 0);
+        }
+
+        {
+            // Test: the same body again comes from the feature cache, chunk by chunk, identical to computing it
+            std::vector<int16_t> samples(3 * 16000);
+            for (size_t i = 0; i < samples.size(); ++i) {
+                samples[i] = (int16_t)(7000 * std::sin(0.021 * i) + 2000 * std::sin(0.9 * i));
+            }
+            oatpp::String body(reinterpret_cast<const char*>(samples.data()), samples.size() * 2);
+            auto before = manager->featureCacheStats();
+            auto computed = service.extractFeatures(body);
+            auto between = manager->featureCacheStats();
+            uint64_t chunks = between.misses - before.misses;
+            OATPP_ASSERT(chunks == 4);
+
+            auto again = service.extractFeatures(body);
+            OATPP_ASSERT(manager->featureCacheStats().hits == between.hits + chunks);
+            OATPP_ASSERT(manager->featureCacheStats().misses == between.misses);
+            OATPP_ASSERT(again.count == computed.count);
+            OATPP_ASSERT(std::memcmp(again.data(), computed.data(), computed.count * sizeof(float)) == 0);
+
+            // The same body uploaded twice at once: each chunk is computed once, the other upload waits for it
+            app::service::AudioService wide(manager, 8);
+            std::vector<int16_t> longer(5 * 16000 + 777);
+            for (size_t i = 0; i < longer.size(); ++i) {
+                longer[i] = (int16_t)(5000 * std::sin(0.017 * i + 0.3));
+            }
+            oatpp::String longBody(reinterpret_cast<const char*>(longer.data()), longer.size() * 2);
+            before = manager->featureCacheStats();
+            auto first = wide.openUpload();
+            auto second = wide.openUpload();
+            OATPP_ASSERT(first->write(longBody->data(), longBody->size()) == longBody->size());
+            OATPP_ASSERT(second->write(longBody->data(), longBody->size()) == longBody->size());
+            first->finish();
+            second->finish();
+            // The first upload's chunks aren't taken yet: their answers alone land the flights
+            auto followed = drain(*second);
+            auto led = drain(*first);
+
+            auto after = manager->featureCacheStats();
+            chunks = after.misses - before.misses;
+            OATPP_ASSERT(chunks == 6);
+            OATPP_ASSERT(after.collapsed + after.hits == before.collapsed + before.hits + chunks);
+            OATPP_ASSERT(followed.size() == app::worker::numFrames(longer.size()) * app::worker::N_MELS);
+            OATPP_ASSERT(followed == led);
         }
+
+        {
+            // Test: streaming session == one-shot computation, split at awkward boundaries
+            std::vector<int16_t> samples(8000);
+            for (size_t i = 0; i < samples.size(); ++i) {
+                samples[i] = (int16_t)(8000 * std::sin(0.05 * i) + 3000 * std::sin(0.31 * i));
+            }
+            oatpp::String whole(reinterpret_cast<const char*>(samples.data()), samples.size() * 2);
+            auto reference = oneTask(manager, whole);
+            OATPP_ASSERT(reference.count == app::worker::numFrames(samples.size()) * app::worker::N_MELS);
+
+            uint64_t sessionId = service.openStream();
+            std::vector<float> streamed;
+            size_t chunkSizes[] = {150, 1601, 399, 2850, 3000};
+            size_t pos = 0;
+            uint64_t expectedOffset = 0;
+            for (size_t chunkSize : chunkSizes) {
+                oatpp::String chunkData(reinterpret_cast<const char*>(samples.data() + pos), chunkSize * 2);
+                auto chunk = service.appendStream(sessionId, chunkData);
+                OATPP_ASSERT(chunk.frameOffset == expectedOffset);
+                expectedOffset += chunk.features.frames();
+                streamed.insert(streamed.end(), chunk.features.data(), chunk.features.data() + chunk.features.count);
+                pos += chunkSize;
+            }
+            OATPP_ASSERT(pos == samples.size());
+            OATPP_ASSERT(streamed.size() == reference.count);
+
+            for (size_t i = 0; i < reference.count; ++i) {
+                OATPP_ASSERT(std::fabs(streamed[i] - reference.data()[i]) < 1e-6f);
+            }
+
+            OATPP_ASSERT(service.closeStream(sessionId) == expectedOffset);
+
+            bool notFound = false;
+            try {
+                service.appendStream(sessionId, whole);
+            } catch (const app::exception::NotFoundException&) {
+                notFound = true;
+            }
+            OATPP_ASSERT(notFound);
+        }
+
+        {
+            // Test: an append dropped before its answer is still computed, so the next one lines up
+            std::vector<int16_t> samples(6000);
+            for (size_t i = 0; i < samples.size(); ++i) {
+                samples[i] = (int16_t)(7000 * std::sin(0.037 * i) + 2500 * std::sin(0.23 * i));
+            }
+            oatpp::String whole(reinterpret_cast<const char*>(samples.data()), samples.size() * 2);
+            auto reference = oneTask(manager, whole);
+
+            const size_t first = 1700, dropped = 2100;
+            uint64_t sessionId = service.openStream();
+            service.appendStream(sessionId, oatpp::String(reinterpret_cast<const char*>(samples.data()), first * 2));
+            {
+                auto pending = service.submitStreamAppend(
+                    sessionId, oatpp::String(reinterpret_cast<const char*>(samples.data() + first), dropped * 2));
+            }
+
+            // The session stays BUSY until the dropped append's answer is in
+            oatpp::String rest(reinterpret_cast<const char*>(samples.data() + first + dropped),
+                               (samples.size() - first - dropped) * 2);
+            app::service::StreamChunk chunk;
+            for (;;) {
+                try {
+                    chunk = service.appendStream(sessionId, rest);
+                    break;
+                } catch (const app::exception::ConflictException&) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            uint64_t offset = app::worker::numFrames(first + dropped);
+            OATPP_ASSERT(chunk.frameOffset == offset);
+            OATPP_ASSERT(chunk.features.count == reference.count - offset * app::worker::N_MELS);
+            for (size_t i = 0; i < chunk.features.count; ++i) {
+                OATPP_ASSERT(std::fabs(chunk.features.data()[i] - reference.data()[offset * app::worker::N_MELS + i]) < 1e-6f);
+            }
+            OATPP_ASSERT(service.closeStream(sessionId) == reference.frames());
+
+            // An owner that goes away mid-append: the session closes once the answer is in
+            sessionId = service.openStream();
+            {
+                auto pending = service.submitStreamAppend(sessionId, rest);
+                service.closeStreamWhenIdle(sessionId);
+            }
+            bool closed = false;
+            while (!closed) {
+                try {
+                    service.closeStream(sessionId);
+                    OATPP_ASSERT(false); // must not still be open once IDLE
+                } catch (const app::exception::ConflictException&) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                } catch (const app::exception::NotFoundException&) {
+                    closed = true;
+                }
+            }
+        }
+
+        {
+            // Test: incremental upload == one-shot, body arriving in ragged pieces (odd sizes split samples)
+            std::vector<int16_t> samples(40000);
+            for (size_t i = 0; i < samples.size(); ++i) {
+                samples[i] = (int16_t)(6000 * std::sin(0.013 * i) + 2000 * std::sin(0.7 * i));
+            }
+            oatpp::String whole(reinterpret_cast<const char*>(samples.data()), samples.size() * 2);
+            auto reference = oneTask(manager, whole);
+
+            // Small chunks and a window of 2 so back-pressure kicks in
+            app::service::FeatureUpload upload(manager, 3000, 2);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(samples.data());
+            size_t total = samples.size() * 2;
+            size_t pieces[] = {1, 4097, 3, 12000, 777};
+            size_t pos = 0;
+            size_t piece = 0;
+            std::vector<float> uploaded;
+            app::service::MelFeatures chunk;
+            bool backPressure = false;
+            while (pos < total) {
+                size_t size = std::min(pieces[piece++ % 5], total - pos);
+                size_t end = pos + size;
+                while (pos < end) {
+                    size_t written = upload.write(bytes + pos, end - pos);
+                    pos += written;
+                    // Results are only taken once the window is full, so this doesn't depend on worker speed
+                    if (written == 0) {
+                        backPressure = true;
+                        upload.oldest()->wait();
+                        while (upload.takeReady(chunk)) {
+                            uploaded.insert(uploaded.end(), chunk.data(), chunk.data() + chunk.count);
+                        }
+                    }
+                }
+            }
+            upload.finish();
+            while (!upload.done()) {
+                upload.oldest()->wait();
+                while (upload.takeReady(chunk)) {
+                    uploaded.insert(uploaded.end(), chunk.data(), chunk.data() + chunk.count);
+                }
+            }
+
+            OATPP_ASSERT(backPressure);
+            OATPP_ASSERT(upload.sampleCount() == samples.size());
+            OATPP_ASSERT(uploaded.size() == reference.count);
+            for (size_t i = 0; i < reference.count; ++i) {
+                OATPP_ASSERT(uploaded[i] == reference.data()[i]);
+            }
+        }
+
+        {
+            // Test: FeatureStream, body and response sides as coroutines running side by side
+            std::vector<int16_t> samples(30000);
+            for (size_t i = 0; i < samples.size(); ++i) {
+                samples[i] = (int16_t)(5000 * std::sin(0.021 * i) + 1500 * std::sin(1.3 * i));
+            }
+            oatpp::String whole(reinterpret_cast<const char*>(samples.data()), samples.size() * 2);
+            auto reference = oneTask(manager, whole);
+
+            auto stream = std::make_shared<app::service::FeatureStream>(manager, 2000, 2);
+            std::vector<float> streamed;
+            std::atomic<bool> ended(false);
+            oatpp::async::Executor executor(1, 1, 1);
+            executor.execute<ChunkCollector<app::service::FeatureStream>>(stream, &streamed, &ended);
+            executor.execute<BodyWriter<app::service::FeatureStream>>(stream, reinterpret_cast<const uint8_t*>(samples.data()), samples.size() * 2);
+            executor.waitTasksFinished();
+            executor.stop();
+            executor.join();
+
+            OATPP_ASSERT(ended);
+            OATPP_ASSERT(stream->sampleCount() == samples.size());
+            OATPP_ASSERT(streamed.size() == reference.count);
+            for (size_t i = 0; i < reference.count; ++i) {
+                OATPP_ASSERT(streamed[i] == reference.data()[i]);
+            }
+        }
+
+        {
+            // Test: LiveStream, small buffer so the writer keeps running into back-pressure
+            std::vector<int16_t> samples(20000);
+            for (size_t i = 0; i < samples.size(); ++i) {
+                samples[i] = (int16_t)(7000 * std::sin(0.017 * i) + 2500 * std::sin(0.9 * i));
+            }
+            oatpp::String whole(reinterpret_cast<const char*>(samples.data()), samples.size() * 2);
+            auto reference = oneTask(manager, whole);
+
+            auto shared = std::make_shared<app::service::AudioService>(manager);
+            auto live = std::make_shared<app::service::LiveStream>(shared, 1500);
+            std::vector<float> streamed;
+            std::atomic<bool> ended(false);
+            oatpp::async::Executor executor(1, 1, 1);
+            executor.execute<ChunkCollector<app::service::LiveStream>>(live, &streamed, &ended);
+            executor.execute<BodyWriter<app::service::LiveStream>>(live, reinterpret_cast<const uint8_t*>(samples.data()), samples.size() * 2);
+            executor.waitTasksFinished();
+            executor.stop();
+            executor.join();
+
+            OATPP_ASSERT(ended);
+            OATPP_ASSERT(live->sampleCount() == samples.size());
+            OATPP_ASSERT(streamed.size() == reference.count);
+            OATPP_ASSERT(std::memcmp(streamed.data(), reference.data(), reference.count * sizeof(float)) == 0);
+        }
+
+        {
+            // The workers counted every task they answered in SHM, for /metrics
+            auto snapshot = std::make_unique<app::worker::LatencyHistogram::Snapshot>();
+            manager->taskMetrics(app::worker::TASK_TEXT_PROCESS)->compute.snapshot(*snapshot);
+            OATPP_ASSERT(snapshot->count >= 1);
+            manager->taskMetrics(app::worker::TASK_AUDIO_PROCESS)->queue_wait.snapshot(*snapshot);
+            OATPP_ASSERT(snapshot->count >= 1);
+            manager->taskMetrics(app::worker::TASK_AUDIO_STREAM)->compute.snapshot(*snapshot);
+            OATPP_ASSERT(snapshot->count >= 1);
+        }
+
+        // Every lease above is out of scope: request and response blocks are all back in the arena,
+        // only the feature cache's own copies are left
+        OATPP_ASSERT(manager->payloadBytesInUse() == manager->featureCacheStats().bytes);
     } catch (const std::exception& e) {
         OATPP_LOGE("Test", "Exception: %s", e.what());
         // Signal shutdown to ensure thread joins
@@ -0,0 +1,154 @@
+#include "FeatureFormatTest.hpp"
+#include "service/FeatureFormat.hpp"
+#include "worker/AudioParams.hpp"
+#include "utils/FloatJson.hpp"
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace app { namespace test {
+
+using namespace app::service;
+
+namespace {
+
+// Reference decoders, to check the encoders round-trip
+float fromFloat16(uint16_t h) {
+    int exponent = (h >> 10) & 0x1F;
+    int mantissa = h & 0x3FF;
+    float value;
+    if (exponent == 0) value = std::ldexp((float)mantissa, -24);
+    else if (exponent == 31) value = mantissa ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+    else value = std::ldexp((float)(mantissa | 0x400), exponent - 25);
+    return (h & 0x8000) ? -value : value;
+}
+
+float fromBfloat16(uint16_t b) {
+    uint32_t x = (uint32_t)b << 16;
+    float value;
+    std::memcpy(&value, &x, sizeof(value));
+    return value;
+}
+
+}
+
+void FeatureFormatTest::onRun() {
+
+    OATPP_LOGI(TAG, "Testing Accept negotiation...");
+    {
+        FeatureFormat none = FeatureFormat::negotiate(nullptr);
+        OATPP_ASSERT(none.encoding == FeatureEncoding::JSON);
+
+        OATPP_ASSERT(FeatureFormat::negotiate("*/*").encoding == FeatureEncoding::JSON);
+        OATPP_ASSERT(FeatureFormat::negotiate("text/html").encoding == FeatureEncoding::JSON);
+        OATPP_ASSERT(FeatureFormat::negotiate("application/x-ndjson").encoding == FeatureEncoding::NDJSON);
+
+        FeatureFormat raw = FeatureFormat::negotiate("application/octet-stream");
+        OATPP_ASSERT(raw.encoding == FeatureEncoding::RAW && raw.dtype == FeatureDtype::FLOAT32);
+
+        FeatureFormat half = FeatureFormat::negotiate("application/octet-stream; dtype=\"float16\"");
+        OATPP_ASSERT(half.encoding == FeatureEncoding::RAW && half.dtype == FeatureDtype::FLOAT16);
+
+        // q wins over order, ties go to the first listed
+        FeatureFormat npy = FeatureFormat::negotiate("application/json;q=0.5, application/x-npy;dtype=f16");
+        OATPP_ASSERT(npy.encoding == FeatureEncoding::NPY && npy.dtype == FeatureDtype::FLOAT16);
+        FeatureFormat first = FeatureFormat::negotiate("application/octet-stream;dtype=bf16, application/x-npy");
+        OATPP_ASSERT(first.encoding == FeatureEncoding::RAW && first.dtype == FeatureDtype::BFLOAT16);
+
+        // .npy has no bfloat16, unknown dtypes and q=0 are skipped
+        OATPP_ASSERT(FeatureFormat::negotiate("application/x-npy;dtype=bfloat16").encoding == FeatureEncoding::JSON);
+        OATPP_ASSERT(FeatureFormat::negotiate("application/octet-stream;dtype=int8").encoding == FeatureEncoding::JSON);
+        OATPP_ASSERT(FeatureFormat::negotiate("application/octet-stream;q=0").encoding == FeatureEncoding::JSON);
+    }
+
+    OATPP_LOGI(TAG, "Testing half-precision conversion...");
+    {
+        OATPP_ASSERT(toFloat16(1.0f) == 0x3C00);
+        OATPP_ASSERT(toFloat16(-2.0f) == 0xC000);
+        OATPP_ASSERT(toFloat16(65504.0f) == 0x7BFF);
+        OATPP_ASSERT(toFloat16(65520.0f) == 0x7C00);
+        OATPP_ASSERT(toFloat16(std::ldexp(1.0f, -24)) == 0x0001);
+        OATPP_ASSERT(toFloat16(std::ldexp(1.0f, -25)) == 0x0000);   // tie, rounds to even
+        OATPP_ASSERT(toFloat16(std::numeric_limits<float>::quiet_NaN()) == 0x7E00);
+        OATPP_ASSERT(toBfloat16(1.0f) == 0x3F80);
+        OATPP_ASSERT(toBfloat16(-std::numeric_limits<float>::infinity()) == 0xFF80);
+
+        // Log-mel values live in [-1.5, 1.5]: half keeps ~3 decimals, bfloat16 ~2
+        for (int i = -1500; i <= 1500; ++i) {
+            float value = i / 1000.0f + 0.000123f;
+            OATPP_ASSERT(std::fabs(fromFloat16(toFloat16(value)) - value) <= std::ldexp(1.0f, -11) * 1.5f);
+            OATPP_ASSERT(std::fabs(fromBfloat16(toBfloat16(value)) - value) <= std::ldexp(1.0f, -8) * 1.5f);
+        }
+    }
+
+    OATPP_LOGI(TAG, "Testing JSON float arrays...");
+    {
+        std::string json;
+        app::utils::FloatJson::appendArray(json, nullptr, 0);
+        OATPP_ASSERT(json == "[]");
+
+        const float special[] = {0.0f, -1.5f, 0.1f, std::numeric_limits<float>::infinity()};
+        json.clear();
+        app::utils::FloatJson::appendArray(json, special, 4);
+        OATPP_ASSERT(json == "[0,-1.5,0.1,null]");
+
+        // Shortest digits still round-trip exactly, including the longest forms
+        std::vector<float> values = {-std::numeric_limits<float>::min(), -std::numeric_limits<float>::max(),
+                                     std::numeric_limits<float>::denorm_min(), -1.23456789e-38f};
+        for (int i = 0; i < 20000; ++i) {
+            values.push_back(std::ldexp((float)(i * 7919 % 20011) - 10005.0f, i % 40 - 30) + 1e-7f * i);
+        }
+        json.clear();
+        app::utils::FloatJson::appendArray(json, values.data(), values.size());
+        OATPP_ASSERT(json.size() <= values.size() * app::utils::FloatJson::MAX_CHARS + 2);
+
+        const char* p = json.c_str() + 1;
+        for (float value : values) {
+            char* end;
+            float parsed = std::strtof(p, &end);
+            OATPP_ASSERT(std::memcmp(&parsed, &value, sizeof(float)) == 0);
+            p = end + 1;
+        }
+        OATPP_ASSERT(*(p - 1) == ']');
+    }
+
+    OATPP_LOGI(TAG, "Testing binary encodings...");
+    {
+        const size_t frames = 3;
+        std::vector<float> mel(frames * app::worker::N_MELS);
+        for (size_t i = 0; i < mel.size(); ++i) {
+            mel[i] = (float)i / 100.0f - 1.0f;
+        }
+
+        FeatureFormat raw = FeatureFormat::negotiate("application/octet-stream");
+        std::string bytes;
+        encodeFeatures(mel.data(), mel.size(), raw, bytes);
+        OATPP_ASSERT(bytes.size() == mel.size() * sizeof(float));
+        OATPP_ASSERT(std::memcmp(bytes.data(), mel.data(), bytes.size()) == 0);
+
+        FeatureFormat npy = FeatureFormat::negotiate("application/x-npy; dtype=float16");
+        bytes.clear();
+        encodeFeatures(mel.data(), mel.size(), npy, bytes);
+
+        OATPP_ASSERT(bytes.compare(0, 6, "\x93NUMPY") == 0);
+        size_t headerLen = (uint8_t)bytes[8] | ((size_t)(uint8_t)bytes[9] << 8);
+        size_t dataStart = 10 + headerLen;
+        OATPP_ASSERT(dataStart % 64 == 0);
+        OATPP_ASSERT(bytes[dataStart - 1] == '\n');
+        std::string header = bytes.substr(10, headerLen);
+        OATPP_ASSERT(header.find("'descr': '<f2'") != std::string::npos);
+        OATPP_ASSERT(header.find("'shape': (3, 80)") != std::string::npos);
+        OATPP_ASSERT(bytes.size() == dataStart + mel.size() * sizeof(uint16_t));
+
+        for (size_t i = 0; i < mel.size(); ++i) {
+            uint16_t h;
+            std::memcpy(&h, bytes.data() + dataStart + i * sizeof(h), sizeof(h));
+            OATPP_ASSERT(h == toFloat16(mel[i]));
+        }
+    }
+}
+
+}}
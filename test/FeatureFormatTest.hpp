@@ -0,0 +1,16 @@
+#ifndef FeatureFormatTest_hpp
+#define FeatureFormatTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test {
+
+class FeatureFormatTest : public oatpp::test::UnitTest {
+public:
+    FeatureFormatTest() : oatpp::test::UnitTest("TEST[FeatureFormatTest]") {}
+    void onRun() override;
+};
+
+}}
+
+#endif
@@ -0,0 +1,81 @@
+#include "MetricsTest.hpp"
+#include "service/Metrics.hpp"
+
+#include <memory>
+#include <string>
+
+namespace app { namespace test {
+
+using namespace app::service;
+using namespace app::worker;
+
+namespace {
+
+constexpr uint64_t US = 1000;
+constexpr uint64_t MS = 1000 * US;
+
+bool contains(const std::string& text, const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+}
+
+}
+
+void MetricsTest::onRun() {
+    OATPP_LOGI(TAG, "Testing histogram buckets...");
+    {
+        // Every bucket is contiguous with the next and at most 1/8 of its values wide
+        for (uint32_t b = 0; b + 1 < LatencyHistogram::BUCKETS; ++b) {
+            uint64_t lower = LatencyHistogram::lowerBound(b);
+            uint64_t upper = LatencyHistogram::upperBound(b);
+            OATPP_ASSERT(LatencyHistogram::bucketOf(lower) == b);
+            OATPP_ASSERT(LatencyHistogram::bucketOf(upper) == b);
+            OATPP_ASSERT(upper + 1 == LatencyHistogram::lowerBound(b + 1));
+            OATPP_ASSERT(upper - lower <= lower / 8);
+        }
+        OATPP_ASSERT(LatencyHistogram::bucketOf(UINT64_MAX) == LatencyHistogram::BUCKETS - 1);
+
+        auto histogram = std::make_unique<LatencyHistogram>();   // value-initialized: all zero
+        for (uint64_t i = 1; i <= 100; ++i) {
+            histogram->record(i * MS);
+        }
+        auto snapshot = std::make_unique<LatencyHistogram::Snapshot>();
+        histogram->snapshot(*snapshot);
+        OATPP_ASSERT(snapshot->count == 100);
+        OATPP_ASSERT(snapshot->sumNs == 5050 * MS);
+
+        // Within a bucket of the exact answer, never below it
+        uint64_t p50 = snapshot->quantile(0.5);
+        uint64_t p99 = snapshot->quantile(0.99);
+        OATPP_ASSERT(p50 >= 50 * MS && p50 <= 50 * MS + 50 * MS / 8);
+        OATPP_ASSERT(p99 >= 99 * MS && p99 <= 99 * MS + 99 * MS / 8);
+        OATPP_ASSERT(snapshot->quantile(1.0) >= 100 * MS);
+
+        // Cumulative counts undercount by less than a bucket
+        uint64_t atOrBelow = snapshot->countAtOrBelow(50 * MS);
+        OATPP_ASSERT(atOrBelow <= 50 && atOrBelow >= 50 - 50 / 8);
+        OATPP_ASSERT(snapshot->countAtOrBelow(UINT64_MAX) == 100);
+    }
+
+    OATPP_LOGI(TAG, "Testing exposition format...");
+    {
+        Metrics metrics;
+        metrics.recordLatency(Metrics::ENDPOINT_PROCESS, 90 * US);
+        metrics.recordLatency(Metrics::ENDPOINT_PROCESS, 3 * MS);
+        metrics.recordSerialization(Metrics::ENDPOINT_SESSION_APPEND, 40 * US);
+
+        // No worker manager: host histograms only
+        std::string text = metrics.render(nullptr);
+        OATPP_ASSERT(contains(text, "# TYPE whisper_request_duration_seconds histogram"));
+        OATPP_ASSERT(contains(text, "whisper_request_duration_seconds_bucket{endpoint=\"process\",le=\"0.0001\"} 1"));
+        OATPP_ASSERT(contains(text, "whisper_request_duration_seconds_bucket{endpoint=\"process\",le=\"0.0025\"} 1"));
+        OATPP_ASSERT(contains(text, "whisper_request_duration_seconds_bucket{endpoint=\"process\",le=\"0.005\"} 2"));
+        OATPP_ASSERT(contains(text, "whisper_request_duration_seconds_bucket{endpoint=\"process\",le=\"+Inf\"} 2"));
+        OATPP_ASSERT(contains(text, "whisper_request_duration_seconds_sum{endpoint=\"process\"} 0.003090000"));
+        OATPP_ASSERT(contains(text, "whisper_request_duration_seconds_count{endpoint=\"process\"} 2"));
+        OATPP_ASSERT(contains(text, "whisper_request_duration_seconds_count{endpoint=\"audio_stream\"} 0"));
+        OATPP_ASSERT(contains(text, "whisper_serialization_seconds_bucket{endpoint=\"session_append\",le=\"5e-05\"} 1"));
+        OATPP_ASSERT(text.find("whisper_task_") == std::string::npos);
+    }
+}
+
+}}
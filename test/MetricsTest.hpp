@@ -0,0 +1,16 @@
+#ifndef MetricsTest_hpp
+#define MetricsTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test {
+
+class MetricsTest : public oatpp::test::UnitTest {
+public:
+    MetricsTest() : oatpp::test::UnitTest("TEST[MetricsTest]") {}
+    void onRun() override;
+};
+
+}}
+
+#endif
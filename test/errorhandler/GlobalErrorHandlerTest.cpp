@@ -38,6 +38,52 @@ void GlobalErrorHandlerTest::onRun() {
         OATPP_ASSERT(response->getBody());
     }
 
+    OATPP_LOGI(TAG, "Testing NotFound / Conflict / PayloadTooLarge / ServiceUnavailable exceptions...");
+    try {
+        throw app::exception::NotFoundException("Unknown stream session");
+    } catch (...) {
+        auto response = errorHandler.handleError(std::current_exception());
+        OATPP_ASSERT(response);
+        OATPP_ASSERT(response->getStatus().code == 404);
+    }
+    try {
+        throw app::exception::ConflictException("Append already in flight");
+    } catch (...) {
+        auto response = errorHandler.handleError(std::current_exception());
+        OATPP_ASSERT(response);
+        OATPP_ASSERT(response->getStatus().code == 409);
+    }
+    try {
+        throw app::exception::PayloadTooLargeException("Audio exceeds max payload");
+    } catch (...) {
+        auto response = errorHandler.handleError(std::current_exception());
+        OATPP_ASSERT(response);
+        OATPP_ASSERT(response->getStatus().code == 413);
+    }
+    try {
+        throw app::exception::ServiceUnavailableException("No free stream sessions");
+    } catch (...) {
+        auto response = errorHandler.handleError(std::current_exception());
+        OATPP_ASSERT(response);
+        OATPP_ASSERT(response->getStatus().code == 503);
+    }
+    try {
+        throw app::exception::GatewayTimeoutException("No answer before the deadline");
+    } catch (...) {
+        auto response = errorHandler.handleError(std::current_exception());
+        OATPP_ASSERT(response);
+        OATPP_ASSERT(response->getStatus().code == 504);
+    }
+    try {
+        throw app::exception::TooManyRequestsException("Server overloaded", 3);
+    } catch (...) {
+        auto response = errorHandler.handleError(std::current_exception());
+        OATPP_ASSERT(response);
+        OATPP_ASSERT(response->getStatus().code == 429);
+        auto retryAfter = response->getHeader("Retry-After");
+        OATPP_ASSERT(retryAfter && *retryAfter == "3");
+    }
+
     OATPP_LOGI(TAG, "Testing Generic std::exception (Security check)...");
     try {
         throw std::runtime_error("Sensitive internal info");
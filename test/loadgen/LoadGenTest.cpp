@@ -0,0 +1,127 @@
+#include "LoadGenTest.hpp"
+#include "HttpClient.hpp"
+#include "LoadReport.hpp"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace app { namespace test { namespace loadgen {
+
+using namespace app::loadgen;
+
+namespace {
+
+// Feeds text in pieces of `step` bytes, the way recv() may hand it over; returns the bytes used
+size_t feedInPieces(HttpResponseParser& parser, const std::string& text, size_t step) {
+    size_t used = 0;
+    while (used < text.size() && !parser.done() && !parser.failed()) {
+        size_t n = std::min(step, text.size() - used);
+        used += parser.feed(text.data() + used, n);
+    }
+    return used;
+}
+
+}
+
+void LoadGenTest::onRun() {
+    OATPP_LOGI(TAG, "Testing response parser...");
+    {
+        const std::string lengthResponse =
+            "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\ncontent-length: 5\r\n\r\nhelloHTTP/1.1 ...";
+        for (size_t step : {1, 3, 1000}) {
+            HttpResponseParser parser;
+            parser.reset(true);
+            size_t used = feedInPieces(parser, lengthResponse, step);
+            OATPP_ASSERT(parser.done());
+            OATPP_ASSERT(used == lengthResponse.find("HTTP/1.1 ..."));   // the next response is left alone
+            OATPP_ASSERT(parser.response().status == 200);
+            OATPP_ASSERT(parser.response().keepAlive);
+            OATPP_ASSERT(parser.response().body == "hello");
+            OATPP_ASSERT(parser.response().firstBodyByteNs != 0);
+        }
+
+        // Chunked, with an extension and a trailer
+        const std::string chunked =
+            "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+            "4;x=1\r\n{\"a\"\r\nB\r\n:1}\n{\"b\":2}\r\n0\r\nX-Trailer: 1\r\n\r\n";
+        for (size_t step : {1, 7, 1000}) {
+            HttpResponseParser parser;
+            parser.reset(true);
+            OATPP_ASSERT(feedInPieces(parser, chunked, step) == chunked.size());
+            OATPP_ASSERT(parser.done());
+            OATPP_ASSERT(parser.response().body == "{\"a\":1}\n{\"b\":2}");
+            OATPP_ASSERT(parser.response().bodyBytes == 15);
+        }
+
+        // No length: the body ends with the connection, which then can't be reused
+        HttpResponseParser parser;
+        parser.reset(false);
+        const std::string untilClose = "HTTP/1.0 503 Service Unavailable\r\n\r\nbusy";
+        feedInPieces(parser, untilClose, 1000);
+        OATPP_ASSERT(!parser.done());
+        parser.finishOnClose();
+        OATPP_ASSERT(parser.done());
+        OATPP_ASSERT(parser.response().status == 503);
+        OATPP_ASSERT(!parser.response().keepAlive);
+        OATPP_ASSERT(parser.response().bodyBytes == 4 && parser.response().body.empty());
+
+        parser.reset(false);
+        const std::string noBody = "HTTP/1.1 204 No Content\r\nConnection: close\r\n\r\n";
+        OATPP_ASSERT(parser.feed(noBody.data(), noBody.size()) == noBody.size());
+        OATPP_ASSERT(parser.done() && !parser.response().keepAlive);
+
+        // Cut short, or not HTTP at all
+        parser.reset(false);
+        const std::string truncated = "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nabc";
+        parser.feed(truncated.data(), truncated.size());
+        parser.finishOnClose();
+        OATPP_ASSERT(parser.failed());
+
+        parser.reset(false);
+        const std::string garbage = "SSH-2.0-OpenSSH\r\n\r\n";
+        parser.feed(garbage.data(), garbage.size());
+        OATPP_ASSERT(parser.failed());
+    }
+
+    OATPP_LOGI(TAG, "Testing request formatting...");
+    {
+        std::string request = formatRequest("POST", "/process", "localhost:8000", "X-Priority: batch\r\n", "{}", false);
+        OATPP_ASSERT(request ==
+                     "POST /process HTTP/1.1\r\nHost: localhost:8000\r\nConnection: close\r\n"
+                     "Content-Length: 2\r\nX-Priority: batch\r\n\r\n{}");
+    }
+
+    OATPP_LOGI(TAG, "Testing coordinated omission correction...");
+    {
+        auto raw = std::make_unique<LoadHistogram::Snapshot>();
+        auto corrected = std::make_unique<LoadHistogram::Snapshot>();
+        std::memset(raw->counts, 0, sizeof(raw->counts));
+
+        // Values below 128 ns have buckets of their own: 99 answers at 10, one stall of 100
+        raw->counts[10] = 99;
+        raw->counts[100] = 1;
+        raw->count = 100;
+        raw->sumNs = 99 * 10 + 100;
+
+        correctCoordinatedOmission(*raw, 0, *corrected);
+        OATPP_ASSERT(corrected->count == 100);
+
+        // The stall hid the requests due at 10, 20, ... 90 ns into it: they waited 90, 80, ... 10
+        correctCoordinatedOmission(*raw, 10, *corrected);
+        OATPP_ASSERT(corrected->count == 109);
+        OATPP_ASSERT(corrected->counts[10] == 100);
+        for (uint32_t v = 20; v <= 100; v += 10) {
+            OATPP_ASSERT(corrected->counts[v] == 1);
+        }
+        OATPP_ASSERT(corrected->sumNs == raw->sumNs + 450);
+        OATPP_ASSERT(raw->quantile(0.95) == 10);
+        OATPP_ASSERT(corrected->quantile(0.95) > 10);
+
+        // Longer than the answers themselves: nothing was held back
+        correctCoordinatedOmission(*raw, 200, *corrected);
+        OATPP_ASSERT(corrected->count == 100);
+    }
+}
+
+}}}
@@ -0,0 +1,16 @@
+#ifndef LoadGenTest_hpp
+#define LoadGenTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace loadgen {
+
+class LoadGenTest : public oatpp::test::UnitTest {
+public:
+    LoadGenTest() : oatpp::test::UnitTest("TEST[LoadGenTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // LoadGenTest_hpp
@@ -1,11 +1,39 @@
 #include "AudioServiceTest.hpp"
+#include "FeatureFormatTest.hpp"
+#include "AdmissionControlTest.hpp"
+#include "MetricsTest.hpp"
 #include "errorhandler/GlobalErrorHandlerTest.hpp"
+#include "worker/MelEngineTest.hpp"
+#include "worker/PayloadArenaTest.hpp"
+#include "worker/MpmcRingTest.hpp"
+#include "worker/TaskCompletionTest.hpp"
+#include "worker/CompletionTableTest.hpp"
+#include "worker/PrioritySchedulingTest.hpp"
+#include "worker/AutoscalerTest.hpp"
+#include "worker/TracerTest.hpp"
+#include "worker/FeatureCacheTest.hpp"
+#include "worker/StreamSessionTableTest.hpp"
+#include "loadgen/LoadGenTest.hpp"
 #include <iostream>
 
 void runTests() {
     // MyControllerTest removed as per request
     OATPP_RUN_TEST(app::test::AudioServiceTest);
+    OATPP_RUN_TEST(app::test::FeatureFormatTest);
+    OATPP_RUN_TEST(app::test::AdmissionControlTest);
+    OATPP_RUN_TEST(app::test::MetricsTest);
     OATPP_RUN_TEST(app::test::errorhandler::GlobalErrorHandlerTest);
+    OATPP_RUN_TEST(app::test::worker::MelEngineTest);
+    OATPP_RUN_TEST(app::test::worker::PayloadArenaTest);
+    OATPP_RUN_TEST(app::test::worker::MpmcRingTest);
+    OATPP_RUN_TEST(app::test::worker::TaskCompletionTest);
+    OATPP_RUN_TEST(app::test::worker::CompletionTableTest);
+    OATPP_RUN_TEST(app::test::worker::PrioritySchedulingTest);
+    OATPP_RUN_TEST(app::test::worker::AutoscalerTest);
+    OATPP_RUN_TEST(app::test::worker::TracerTest);
+    OATPP_RUN_TEST(app::test::worker::FeatureCacheTest);
+    OATPP_RUN_TEST(app::test::worker::StreamSessionTableTest);
+    OATPP_RUN_TEST(app::test::loadgen::LoadGenTest);
 }
 
 int main() {
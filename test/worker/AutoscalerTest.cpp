@@ -0,0 +1,101 @@
+#include "AutoscalerTest.hpp"
+#include "worker/Autoscaler.hpp"
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+
+namespace {
+
+constexpr uint64_t MS = 1000 * 1000;
+constexpr uint64_t TICK = 250 * MS;
+
+Autoscaler::Sample sample(size_t workers, size_t queued, double utilization) {
+    Autoscaler::Sample s;
+    s.workers = workers;
+    s.queued = queued;
+    s.elapsedNs = TICK;
+    s.busyNs = (uint64_t)(utilization * TICK * workers);
+    return s;
+}
+
+// Feeds the same sample for `ms` and returns the first non-zero decision (0 if none)
+int feed(Autoscaler& scaler, const Autoscaler::Sample& s, uint64_t ms) {
+    for (uint64_t t = 0; t < ms * MS; t += TICK) {
+        int delta = scaler.decide(s);
+        if (delta != 0) return delta;
+    }
+    return 0;
+}
+
+ScalingConfig config() {
+    ScalingConfig c;
+    c.minWorkers = 2;
+    c.maxWorkers = 8;
+    c.scaleUpAfterMs = 1000;
+    c.scaleDownAfterMs = 10000;
+    c.cooldownMs = 0;
+    return c;
+}
+
+}
+
+void AutoscalerTest::onRun() {
+    OATPP_LOGI(TAG, "Testing bounds...");
+    {
+        Autoscaler scaler(config());
+        OATPP_ASSERT(scaler.decide(sample(0, 0, 0)) == 2);   // below min: at once, no sustain
+        OATPP_ASSERT(scaler.decide(sample(10, 0, 0)) == -2);
+    }
+
+    OATPP_LOGI(TAG, "Testing sustained pressure...");
+    {
+        Autoscaler scaler(config());
+        // Deep rings, but not for long enough
+        OATPP_ASSERT(feed(scaler, sample(2, 100, 1.0), 750) == 0);
+        // A lull resets the clock
+        OATPP_ASSERT(scaler.decide(sample(2, 0, 0.5)) == 0);
+        OATPP_ASSERT(feed(scaler, sample(2, 100, 1.0), 750) == 0);
+
+        // 100 queued wants 50 workers: at most double, so +2
+        OATPP_ASSERT(feed(scaler, sample(2, 100, 1.0), 2000) == 2);
+        // Then +4, capped by max
+        OATPP_ASSERT(feed(scaler, sample(4, 100, 1.0), 2000) == 4);
+        OATPP_ASSERT(feed(scaler, sample(8, 100, 1.0), 5000) == 0);
+
+        // Busy workers with shallow rings: one at a time
+        Autoscaler busy(config());
+        OATPP_ASSERT(feed(busy, sample(3, 1, 1.0), 5000) == 1);
+    }
+
+    OATPP_LOGI(TAG, "Testing hysteresis and idle retirement...");
+    {
+        Autoscaler scaler(config());
+        // Between the thresholds nothing ever changes
+        OATPP_ASSERT(feed(scaler, sample(4, 0, 0.5), 60000) == 0);
+
+        // Idle: one worker at a time, after scaleDownAfterMs
+        OATPP_ASSERT(feed(scaler, sample(4, 0, 0.0), 5000) == 0);
+        OATPP_ASSERT(feed(scaler, sample(4, 0, 0.0), 10000) == -1);
+        OATPP_ASSERT(feed(scaler, sample(3, 0, 0.0), 11000) == -1);
+        // Never below min
+        OATPP_ASSERT(feed(scaler, sample(2, 0, 0.0), 60000) == 0);
+
+        // A queued request isn't idle, however light the load
+        Autoscaler light(config());
+        OATPP_ASSERT(feed(light, sample(4, 1, 0.0), 60000) == 0);
+    }
+
+    OATPP_LOGI(TAG, "Testing cooldown...");
+    {
+        ScalingConfig c = config();
+        c.cooldownMs = 5000;
+        Autoscaler scaler(c);
+        // The first change waits out the cooldown too (the pool was just started)
+        OATPP_ASSERT(feed(scaler, sample(2, 100, 1.0), 4500) == 0);
+        OATPP_ASSERT(feed(scaler, sample(2, 100, 1.0), 1000) == 2);
+        OATPP_ASSERT(feed(scaler, sample(4, 100, 1.0), 4500) == 0);
+    }
+}
+
+}}}
@@ -0,0 +1,16 @@
+#ifndef AutoscalerTest_hpp
+#define AutoscalerTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class AutoscalerTest : public oatpp::test::UnitTest {
+public:
+    AutoscalerTest() : oatpp::test::UnitTest("TEST[AutoscalerTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // AutoscalerTest_hpp
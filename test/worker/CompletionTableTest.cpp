@@ -0,0 +1,211 @@
+#include "CompletionTableTest.hpp"
+#include "worker/CompletionTable.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+
+namespace {
+
+TaskResult resultFor(uint64_t taskId, uint32_t len) {
+    RespSlot resp = {};
+    resp.task_id = taskId;
+    resp.len = len;
+    return TaskResult{resp, PayloadLease()};
+}
+
+}
+
+void CompletionTableTest::onRun() {
+    OATPP_LOGI(TAG, "Testing claim / complete / take...");
+    {
+        CompletionTable table(4);
+        TaskHandle handle = table.claim();
+        OATPP_ASSERT(handle);
+        OATPP_ASSERT(!handle->isReady());
+        OATPP_ASSERT(table.inFlight() == 1);
+
+        OATPP_ASSERT(table.complete(handle.taskId(), resultFor(handle.taskId(), 42)));
+        OATPP_ASSERT(handle->isReady());
+        OATPP_ASSERT(handle->take().resp.len == 42);
+
+        uint64_t oldId = handle.taskId();
+        handle.reset();
+        OATPP_ASSERT(table.inFlight() == 0);
+
+        // Same entry comes back under a new generation; the old id no longer matches
+        TaskHandle again = table.claim();
+        OATPP_ASSERT(again.taskId() != oldId);
+        OATPP_ASSERT(!table.complete(oldId, resultFor(oldId, 1)));
+        OATPP_ASSERT(!again->isReady());
+    }
+
+    OATPP_LOGI(TAG, "Testing exhaustion and abandoned tasks...");
+    {
+        CompletionTable table(4);
+        std::vector<TaskHandle> handles;
+        for (size_t i = 0; i < table.capacity(); ++i) {
+            handles.push_back(table.claim());
+            OATPP_ASSERT(handles.back());
+        }
+        OATPP_ASSERT(!table.claim());
+
+        // Caller gives up before the worker answers: the entry is recycled by the late answer
+        uint64_t abandonedId = handles[0].taskId();
+        handles[0].reset();
+        OATPP_ASSERT(!table.claim());
+        OATPP_ASSERT(!table.complete(abandonedId, resultFor(abandonedId, 1)));
+        TaskHandle reused = table.claim();
+        OATPP_ASSERT(reused);
+
+        // Shutdown settles everything still pending
+        table.failAll(503);
+        for (size_t i = 1; i < handles.size(); ++i) {
+            OATPP_ASSERT(handles[i]->isReady());
+            OATPP_ASSERT(handles[i]->take().resp.status_code == 503);
+        }
+        handles.clear();
+        reused.reset();
+        OATPP_ASSERT(table.inFlight() == 0);
+    }
+
+    OATPP_LOGI(TAG, "Testing deadlines and cancel flags...");
+    {
+        CompletionTable table(8);
+        std::vector<std::atomic<uint64_t>> flags(CANCEL_SLOTS);
+        for (auto& f : flags) f.store(0);
+        table.attachCancelFlags(flags.data());
+        auto isCancelled = [&](uint64_t taskId) { return flags[taskId & (CANCEL_SLOTS - 1)].load() == taskId; };
+
+        TaskHandle early = table.claim(1000);
+        TaskHandle late = table.claim(5000);
+        TaskHandle forever = table.claim();
+        TaskHandle gone = table.claim(1000);
+        uint64_t goneId = gone.taskId();
+
+        // Dropping an unanswered handle flags the task for the workers
+        gone.reset();
+        OATPP_ASSERT(isCancelled(goneId));
+        OATPP_ASSERT(!isCancelled(early.taskId()));
+
+        OATPP_ASSERT(table.expire(999, 504) == 0);
+        OATPP_ASSERT(!early->isReady());
+
+        // The abandoned one is recycled, only the waiting one counts
+        OATPP_ASSERT(table.expire(1000, 504) == 1);
+        OATPP_ASSERT(early->isReady());
+        OATPP_ASSERT(early->take().resp.status_code == 504);
+        OATPP_ASSERT(isCancelled(early.taskId()));
+        OATPP_ASSERT(!late->isReady());
+        OATPP_ASSERT(table.inFlight() == 3);
+
+        // A worker answering after the deadline is ignored
+        OATPP_ASSERT(!table.complete(early.taskId(), resultFor(early.taskId(), 1)));
+
+        OATPP_ASSERT(table.expire(1000000, 504) == 1);
+        OATPP_ASSERT(late->take().resp.status_code == 504);
+        OATPP_ASSERT(!forever->isReady());
+
+        early.reset();
+        late.reset();
+        OATPP_ASSERT(table.complete(forever.taskId(), resultFor(forever.taskId(), 7)));
+        forever.reset();
+        OATPP_ASSERT(table.inFlight() == 0);
+        table.attachCancelFlags(nullptr);
+    }
+
+    OATPP_LOGI(TAG, "Testing a late answer racing the deadline for a dropped task...");
+    {
+        CompletionTable table(4);
+        for (int round = 0; round < 2000; ++round) {
+            TaskHandle handle = table.claim(1);
+            uint64_t id = handle.taskId();
+            handle.reset();
+
+            std::atomic<int> go(0);
+            std::thread deadline([&] {
+                go++;
+                while (go.load() < 2) std::this_thread::yield();
+                table.expire(2, 504);
+            });
+            go++;
+            while (go.load() < 2) std::this_thread::yield();
+            table.complete(id, resultFor(id, 1));
+            deadline.join();
+
+            // Recycled exactly once: every entry can be claimed once, on distinct slots
+            OATPP_ASSERT(table.inFlight() == 0);
+            std::vector<TaskHandle> all;
+            uint32_t slots = 0;
+            for (size_t i = 0; i < table.capacity(); ++i) {
+                all.push_back(table.claim());
+                OATPP_ASSERT(all.back());
+                slots |= 1u << (all.back().taskId() & (table.capacity() - 1));
+            }
+            OATPP_ASSERT(!table.claim());
+            OATPP_ASSERT(slots == (1u << table.capacity()) - 1);
+            for (TaskHandle& h : all) {
+                table.complete(h.taskId(), resultFor(h.taskId(), 1));
+            }
+        }
+    }
+
+    OATPP_LOGI(TAG, "Testing concurrent submitters against one responder...");
+    {
+        constexpr int THREADS = 4;
+        constexpr int PER_THREAD = 20000;
+        CompletionTable table(64);
+
+        // Submitters publish ids, the responder completes them in whatever order they show up
+        std::vector<std::atomic<uint64_t>> mailbox(THREADS);
+        for (auto& m : mailbox) m.store(0);
+        std::atomic<int> finishedThreads(0);
+        std::atomic<int> mismatches(0);
+
+        std::thread responder([&] {
+            while (finishedThreads.load() < THREADS) {
+                for (auto& m : mailbox) {
+                    uint64_t id = m.exchange(0);
+                    if (id != 0) {
+                        table.complete(id, resultFor(id, (uint32_t)(id & 0xFFFF)));
+                    }
+                }
+            }
+        });
+
+        std::vector<std::thread> submitters;
+        for (int t = 0; t < THREADS; ++t) {
+            submitters.emplace_back([&, t] {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    TaskHandle handle = table.claim();
+                    if (!handle) { --i; continue; }
+                    // Every few tasks give up early, like a dropped connection
+                    if (i % 7 == 0) {
+                        uint64_t id = handle.taskId();
+                        handle.reset();
+                        mailbox[t].store(id);
+                        while (mailbox[t].load() != 0) std::this_thread::yield();
+                        continue;
+                    }
+                    mailbox[t].store(handle.taskId());
+                    handle->wait();
+                    if (handle->take().resp.len != (uint32_t)(handle.taskId() & 0xFFFF)) {
+                        mismatches++;
+                    }
+                }
+                finishedThreads++;
+            });
+        }
+        for (auto& th : submitters) th.join();
+        responder.join();
+
+        OATPP_ASSERT(mismatches == 0);
+        OATPP_ASSERT(table.inFlight() == 0);
+    }
+}
+
+}}}
@@ -0,0 +1,16 @@
+#ifndef CompletionTableTest_hpp
+#define CompletionTableTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class CompletionTableTest : public oatpp::test::UnitTest {
+public:
+    CompletionTableTest() : oatpp::test::UnitTest("TEST[CompletionTableTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // CompletionTableTest_hpp
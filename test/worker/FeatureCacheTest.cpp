@@ -0,0 +1,280 @@
+#include "FeatureCacheTest.hpp"
+#include "worker/FeatureCache.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+
+namespace {
+
+FeatureKey makeKey(uint64_t lo, uint64_t hi) {
+    FeatureKey key;
+    key.lo = lo;
+    key.hi = hi;
+    return key;
+}
+
+bool cached(FeatureCache& cache, const FeatureKey& key) {
+    PayloadLease features;
+    size_t count = 0;
+    return cache.lookup(key, features, count);
+}
+
+}
+
+void FeatureCacheTest::onRun() {
+    // Heap memory stands in for the SHM segment, as in PayloadArenaTest
+    constexpr size_t ARENA_SIZE = 1 << 20;
+    ArenaHeader arenaHeader;
+    std::vector<uint8_t> storage(ARENA_SIZE + ARENA_ALIGN);
+    void* base = storage.data() + (ARENA_ALIGN - (uintptr_t)storage.data() % ARENA_ALIGN) % ARENA_ALIGN;
+    PayloadArena arena;
+    arena.attach(&arenaHeader, base, ARENA_SIZE);
+    arena.format();
+
+    // 200 floats per entry: one 1 KiB block each
+    constexpr size_t COUNT = 200;
+    constexpr uint64_t BLOCK = 1024;
+    std::vector<float> features(COUNT);
+    for (size_t i = 0; i < COUNT; ++i) features[i] = 0.25f * i;
+
+    OATPP_LOGI(TAG, "Testing keys...");
+    {
+        std::vector<float> samples(4000);
+        for (size_t i = 0; i < samples.size(); ++i) samples[i] = (float)((i * 7919) % 1000) / 1000.0f;
+        FeatureKey key = FeatureCache::keyOf(samples.data(), samples.size());
+        OATPP_ASSERT(key);
+        OATPP_ASSERT(FeatureCache::keyOf(samples.data(), samples.size()) == key);
+        OATPP_ASSERT(!(FeatureCache::keyOf(samples.data(), samples.size() - 1) == key));
+        samples[1234] += 1e-6f;
+        OATPP_ASSERT(!(FeatureCache::keyOf(samples.data(), samples.size()) == key));
+        OATPP_ASSERT(FeatureCache::keyOf(nullptr, 0)); // never empty, even for no samples
+    }
+
+    OATPP_LOGI(TAG, "Testing disabled cache...");
+    {
+        auto header = std::unique_ptr<FeatureCacheHeader>(new FeatureCacheHeader());
+        FeatureCache cache(header.get(), &arena);
+        OATPP_ASSERT(!cache.enabled());
+        OATPP_ASSERT(!cache.insert(makeKey(1, 1), features.data(), COUNT));
+        OATPP_ASSERT(!cached(cache, makeKey(1, 1)));
+        OATPP_ASSERT(arena.bytesInUse() == 0);
+    }
+
+    OATPP_LOGI(TAG, "Testing insert / lookup...");
+    {
+        auto header = std::unique_ptr<FeatureCacheHeader>(new FeatureCacheHeader());
+        header->max_bytes = 64 * BLOCK;
+        FeatureCache cache(header.get(), &arena);
+        FeatureKey key = makeKey(11, 42);
+
+        OATPP_ASSERT(cache.insert(key, features.data(), COUNT));
+        OATPP_ASSERT(!cache.insert(key, features.data(), COUNT)); // already there
+        OATPP_ASSERT(!cached(cache, makeKey(12, 42)));
+
+        PayloadLease copy;
+        size_t count = 0;
+        OATPP_ASSERT(cache.lookup(key, copy, count));
+        OATPP_ASSERT(count == COUNT);
+        OATPP_ASSERT(std::memcmp(copy.as<float>(), features.data(), COUNT * sizeof(float)) == 0);
+
+        auto stats = cache.stats();
+        OATPP_ASSERT(stats.inserts == 1);
+        OATPP_ASSERT(stats.entries == 1);
+        OATPP_ASSERT(stats.bytes == BLOCK);
+        // The caller's copy is its own block
+        OATPP_ASSERT(arena.bytesInUse() == 2 * BLOCK);
+        copy.reset();
+        OATPP_ASSERT(arena.bytesInUse() == BLOCK);
+    }
+    arena.format();
+
+    OATPP_LOGI(TAG, "Testing byte budget and CLOCK...");
+    {
+        auto header = std::unique_ptr<FeatureCacheHeader>(new FeatureCacheHeader());
+        header->max_bytes = 4 * BLOCK;
+        FeatureCache cache(header.get(), &arena);
+
+        for (uint64_t k = 1; k <= 4; ++k) {
+            OATPP_ASSERT(cache.insert(makeKey(k, k), features.data(), COUNT));
+        }
+        OATPP_ASSERT(cached(cache, makeKey(1, 1))); // referenced: survives the next sweep
+        OATPP_ASSERT(cache.insert(makeKey(5, 5), features.data(), COUNT));
+        OATPP_ASSERT(cached(cache, makeKey(1, 1)));
+        OATPP_ASSERT(cached(cache, makeKey(5, 5)));
+
+        for (uint64_t k = 6; k <= 40; ++k) {
+            OATPP_ASSERT(cache.insert(makeKey(k, k), features.data(), COUNT));
+        }
+        auto stats = cache.stats();
+        OATPP_ASSERT(stats.entries == 4);
+        OATPP_ASSERT(stats.bytes == 4 * BLOCK);
+        OATPP_ASSERT(stats.evictions == 36);
+        OATPP_ASSERT(arena.bytesInUse() == 4 * BLOCK);
+
+        // Bigger than the whole budget: not stored
+        std::vector<float> huge(2 * 1024);
+        OATPP_ASSERT(!cache.insert(makeKey(99, 99), huge.data(), huge.size()));
+        OATPP_ASSERT(cache.stats().rejected == 1);
+        OATPP_ASSERT(arena.bytesInUse() <= 4 * BLOCK);
+    }
+    arena.format();
+
+    OATPP_LOGI(TAG, "Testing a full set...");
+    {
+        auto header = std::unique_ptr<FeatureCacheHeader>(new FeatureCacheHeader());
+        header->max_bytes = 256 * BLOCK;
+        FeatureCache cache(header.get(), &arena);
+
+        // Same set for every key: the ninth replaces one of the first eight
+        for (uint64_t k = 0; k <= FEATURE_CACHE_WAYS; ++k) {
+            OATPP_ASSERT(cache.insert(makeKey(k + 1, 3 + k * FEATURE_CACHE_SETS), features.data(), COUNT));
+        }
+        auto stats = cache.stats();
+        OATPP_ASSERT(stats.entries == FEATURE_CACHE_WAYS);
+        OATPP_ASSERT(stats.evictions == 1);
+        OATPP_ASSERT(cached(cache, makeKey(FEATURE_CACHE_WAYS + 1, 3 + FEATURE_CACHE_WAYS * FEATURE_CACHE_SETS)));
+    }
+    arena.format();
+
+    OATPP_LOGI(TAG, "Testing concurrent insert / lookup...");
+    {
+        auto header = std::unique_ptr<FeatureCacheHeader>(new FeatureCacheHeader());
+        header->max_bytes = 32 * BLOCK;
+        FeatureCache cache(header.get(), &arena);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t] {
+                uint32_t state = 1234 + t;
+                for (int i = 0; i < 5000; ++i) {
+                    state = state * 1664525u + 1013904223u;
+                    FeatureKey key = makeKey((state >> 8) % 64 + 1, (state >> 16) % 64);
+                    if (state & 1) {
+                        cache.insert(key, features.data(), COUNT);
+                    } else {
+                        PayloadLease copy;
+                        size_t count = 0;
+                        if (cache.lookup(key, copy, count)) {
+                            OATPP_ASSERT(count == COUNT);
+                            OATPP_ASSERT(copy.as<float>()[COUNT - 1] == features[COUNT - 1]);
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        // Every block left in the arena is an entry's, and accounted for
+        auto stats = cache.stats();
+        OATPP_ASSERT(stats.bytes == stats.entries * BLOCK);
+        OATPP_ASSERT(stats.bytes <= 32 * BLOCK);
+        OATPP_ASSERT(arena.bytesInUse() == stats.bytes);
+    }
+
+    arena.format();
+
+    OATPP_LOGI(TAG, "Testing concurrent inserts of the same key...");
+    {
+        auto header = std::unique_ptr<FeatureCacheHeader>(new FeatureCacheHeader());
+        header->max_bytes = 512 * BLOCK;
+        FeatureCache cache(header.get(), &arena);
+
+        // Every thread inserts each key at once; two keys per set, so nothing is evicted
+        constexpr int THREADS = 4;
+        constexpr uint64_t KEYS = 2 * FEATURE_CACHE_SETS;
+        std::atomic<uint64_t> ready(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&] {
+                for (uint64_t k = 0; k < KEYS; ++k) {
+                    ready.fetch_add(1);
+                    while (ready.load() < (k + 1) * THREADS) std::this_thread::yield();
+                    cache.insert(makeKey(k + 1, k), features.data(), COUNT);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        // Each key stored at most once, and every losing block given back
+        auto stats = cache.stats();
+        OATPP_ASSERT(stats.inserts <= KEYS);
+        OATPP_ASSERT(stats.entries == stats.inserts);
+        OATPP_ASSERT(stats.evictions == 0);
+        OATPP_ASSERT(stats.rejected == 0);
+        OATPP_ASSERT(arena.bytesInUse() == stats.bytes);
+        OATPP_ASSERT(stats.bytes == stats.entries * BLOCK);
+
+        // The race itself: another worker is still filling in a way with the same key
+        FeatureKey key = makeKey(77, 5);
+        FeatureCacheEntry& filling = header->entries[5 * FEATURE_CACHE_WAYS + 3];
+        filling.lock.store(1u << 31);
+        filling.claim.store(77);
+        uint64_t bytesBefore = arena.bytesInUse();
+        OATPP_ASSERT(!cache.insert(key, features.data(), COUNT));
+        OATPP_ASSERT(!cached(cache, key));
+        OATPP_ASSERT(cache.stats().rejected == 0);
+        OATPP_ASSERT(arena.bytesInUse() == bytesBefore);
+
+        filling.claim.store(0);
+        filling.lock.store(0);
+        OATPP_ASSERT(cache.insert(key, features.data(), COUNT));
+        OATPP_ASSERT(cached(cache, key));
+    }
+
+    OATPP_LOGI(TAG, "Testing flights...");
+    {
+        FeatureFlights flights;
+        FeatureKey key = makeKey(7, 7);
+
+        FlightLead lead;
+        OATPP_ASSERT(!flights.join(key, lead));
+        OATPP_ASSERT(lead);
+        FlightLead other;
+        auto flight = flights.join(key, other);
+        OATPP_ASSERT(flight && !other);
+        OATPP_ASSERT(!flight->isReady());
+
+        // Only the answer to the lead's own task lands it; the lead dropped later must not land the next flight
+        lead.bind(101);
+        flights.land(key, 100);
+        OATPP_ASSERT(!flight->isReady());
+        flights.land(key, 101);
+        OATPP_ASSERT(flight->isReady());
+        OATPP_ASSERT(flights.size() == 0);
+
+        FlightLead next;
+        OATPP_ASSERT(!flights.join(key, next));
+        auto nextFlight = flights.join(key, other);
+        lead.reset();
+        OATPP_ASSERT(!nextFlight->isReady());
+
+        // A late answer to the old lead's task leaves the new flight in the air
+        next.bind(102);
+        flights.land(key, 101);
+        OATPP_ASSERT(!nextFlight->isReady());
+
+        // A lead that gives up lands its flight too
+        next.reset();
+        OATPP_ASSERT(nextFlight->isReady());
+        OATPP_ASSERT(flights.size() == 0);
+
+        // An answer that beats the lead's bind() lands the flight as it binds
+        FlightLead quick;
+        OATPP_ASSERT(!flights.join(key, quick));
+        auto quickFlight = flights.join(key, other);
+        flights.land(key, 103);
+        OATPP_ASSERT(!quickFlight->isReady());
+        quick.bind(103);
+        OATPP_ASSERT(quickFlight->isReady());
+        OATPP_ASSERT(flights.size() == 0);
+    }
+}
+
+}}}
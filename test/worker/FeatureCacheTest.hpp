@@ -0,0 +1,16 @@
+#ifndef FeatureCacheTest_hpp
+#define FeatureCacheTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class FeatureCacheTest : public oatpp::test::UnitTest {
+public:
+    FeatureCacheTest() : oatpp::test::UnitTest("TEST[FeatureCacheTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // FeatureCacheTest_hpp
@@ -0,0 +1,188 @@
+#include "MelEngineTest.hpp"
+#include "worker/cpu/MelEngine.hpp"
+#include "worker/cpu/Fft.hpp"
+#include "worker/MelFilterbank.hpp"
+
+#include <cmath>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+using namespace app::worker::cpu;
+
+namespace {
+
+// O(n^2) reference DFT in double precision
+double maxDftError(const FftPlan& plan, const std::vector<float>& signal) {
+    size_t n = plan.size();
+    std::vector<Complex> spectrum(n / 2 + 1), scratchIn(n), scratchOut(n);
+    plan.forwardReal(signal.data(), spectrum.data(), scratchIn.data(), scratchOut.data());
+
+    double maxErr = 0.0;
+    for (size_t k = 0; k <= n / 2; ++k) {
+        double re = 0.0, im = 0.0;
+        for (size_t t = 0; t < n; ++t) {
+            double phase = -2.0 * M_PI * (double)(k * t % n) / (double)n;
+            re += signal[t] * std::cos(phase);
+            im += signal[t] * std::sin(phase);
+        }
+        maxErr = std::max(maxErr, std::fabs(re - spectrum[k].re));
+        maxErr = std::max(maxErr, std::fabs(im - spectrum[k].im));
+    }
+    return maxErr;
+}
+
+}
+
+void MelEngineTest::onRun() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    OATPP_LOGI(TAG, "Checking compile-time filterbank against <cmath> Slaney formula...");
+    {
+        auto hzToMel = [](double hz) {
+            return hz >= 1000.0 ? 15.0 + std::log(hz / 1000.0) / (std::log(6.4) / 27.0) : hz * 3.0 / 200.0;
+        };
+        auto melToHz = [](double mel) {
+            return mel >= 15.0 ? 1000.0 * std::exp(std::log(6.4) / 27.0 * (mel - 15.0)) : mel * 200.0 / 3.0;
+        };
+        double edges[N_MELS + 2];
+        for (int i = 0; i < N_MELS + 2; ++i) {
+            edges[i] = melToHz(hzToMel(SAMPLE_RATE / 2.0) * i / (N_MELS + 1));
+        }
+
+        size_t nonZero = 0;
+        for (int m = 0; m < N_MELS; ++m) {
+            const MelBand& band = MEL_FILTERBANK.bands[m];
+            for (int k = 0; k < N_FFT_HALF; ++k) {
+                double freq = (double)k * SAMPLE_RATE / N_FFT;
+                double w = std::min((freq - edges[m]) / (edges[m + 1] - edges[m]),
+                                    (edges[m + 2] - freq) / (edges[m + 2] - edges[m + 1]));
+                w = std::max(0.0, w) * 2.0 / (edges[m + 2] - edges[m]);
+
+                bool inBand = k >= band.start && k < band.start + band.length;
+                double sparse = inBand ? MEL_FILTERBANK.weights[band.offset + k - band.start] : 0.0;
+                OATPP_ASSERT(std::fabs(sparse - w) < 1e-7);
+                if (w > 0.0) ++nonZero;
+            }
+        }
+        OATPP_ASSERT(nonZero == MEL_FILTER_NNZ);
+        // Whisper's mel_filters.npz row 0: a single non-zero weight at bin 1
+        OATPP_ASSERT(MEL_FILTERBANK.bands[0].start == 1 && MEL_FILTERBANK.bands[0].length == 1);
+        OATPP_ASSERT(std::fabs(MEL_FILTERBANK.weights[0] - 0.02486259f) < 1e-7f);
+    }
+
+    OATPP_LOGI(TAG, "Checking FFT against reference DFT...");
+    for (size_t n : {400, 512, 77}) {
+        std::vector<float> signal(n);
+        for (auto& s : signal) s = dist(rng);
+        double err = maxDftError(FftPlan(n), signal);
+        OATPP_LOGD(TAG, "n=%lu max abs error %g", (unsigned long)n, err);
+        OATPP_ASSERT(err < 1e-3);
+    }
+
+    OATPP_LOGI(TAG, "Checking specialised %d-point power spectra against the generic FFT...", N_FFT);
+    for (const MelKernels* kernels : {&scalarKernels(), &selectKernels()}) {
+        if (!kernels->framePower) continue;
+        // Counts around the SIMD lane width, so short lane groups get exercised
+        for (size_t count : {1, 7, 8, 13}) {
+            std::vector<float> frames(count * N_FFT);
+            for (auto& s : frames) s = dist(rng);
+            std::vector<float> power(count * N_FFT_HALF);
+            kernels->framePower(frames.data(), power.data(), count);
+
+            FftPlan plan(N_FFT);
+            std::vector<Complex> spectrum(N_FFT_HALF), scratchIn(N_FFT), scratchOut(N_FFT);
+            double maxRelErr = 0.0;
+            for (size_t f = 0; f < count; ++f) {
+                plan.forwardReal(frames.data() + f * N_FFT, spectrum.data(), scratchIn.data(), scratchOut.data());
+                double peak = 0.0;
+                for (size_t k = 0; k < N_FFT_HALF; ++k) {
+                    peak = std::max(peak, (double)spectrum[k].re * spectrum[k].re + (double)spectrum[k].im * spectrum[k].im);
+                }
+                for (size_t k = 0; k < N_FFT_HALF; ++k) {
+                    double expected = (double)spectrum[k].re * spectrum[k].re + (double)spectrum[k].im * spectrum[k].im;
+                    maxRelErr = std::max(maxRelErr, std::fabs(power[f * N_FFT_HALF + k] - expected) / peak);
+                }
+            }
+            OATPP_LOGD(TAG, "%s count=%lu max error %g (relative to peak bin)", kernels->name, (unsigned long)count, maxRelErr);
+            OATPP_ASSERT(maxRelErr < 1e-5);
+        }
+    }
+
+    OATPP_LOGI(TAG, "Checking frame count and layout...");
+    {
+        MelEngine engine;
+        std::vector<float> audio(SAMPLE_RATE);
+        for (auto& s : audio) s = dist(rng) * 0.1f;
+        std::vector<float> mel(numFrames(audio.size()) * N_MELS);
+        OATPP_ASSERT(engine.compute(audio.data(), audio.size(), mel.data()) == 98);
+        OATPP_ASSERT(numFrames(N_FFT - 1) == 0);
+        OATPP_ASSERT(numFrames(N_FFT) == 1);
+    }
+
+    OATPP_LOGI(TAG, "Checking dispatched kernels ('%s') against scalar...", selectKernels().name);
+    {
+        std::vector<float> audio(4000);
+        for (auto& s : audio) s = dist(rng) * 0.5f;
+        // include digital silence to exercise the log floor
+        std::fill(audio.begin() + 1000, audio.begin() + 1800, 0.0f);
+
+        size_t frames = numFrames(audio.size());
+        std::vector<float> reference(frames * N_MELS), dispatched(frames * N_MELS);
+
+        MelEngine scalar(scalarKernels());
+        MelEngine best(selectKernels());
+        scalar.compute(audio.data(), audio.size(), reference.data());
+        best.compute(audio.data(), audio.size(), dispatched.data());
+
+        for (size_t i = 0; i < reference.size(); ++i) {
+            OATPP_ASSERT(std::fabs(reference[i] - dispatched[i]) < 1e-4f);
+        }
+    }
+
+    OATPP_LOGI(TAG, "Checking batched pass matches one-by-one...");
+    {
+        // Lengths straddle FRAME_BLOCK and include a too-short input
+        size_t lengths[] = {16000, 399, 400, 5000, 160 * 31 + 400, 700};
+        std::vector<std::vector<float>> inputs, single, batched;
+        std::vector<MelJob> jobs;
+        for (size_t len : lengths) {
+            inputs.emplace_back(len);
+            for (auto& s : inputs.back()) s = dist(rng) * 0.3f;
+            single.emplace_back(numFrames(len) * N_MELS);
+            batched.emplace_back(numFrames(len) * N_MELS);
+        }
+        MelEngine engine;
+        size_t expectedFrames = 0;
+        for (size_t j = 0; j < inputs.size(); ++j) {
+            expectedFrames += engine.compute(inputs[j].data(), inputs[j].size(), single[j].data());
+            jobs.push_back(MelJob{inputs[j].data(), inputs[j].size(), batched[j].data()});
+        }
+        OATPP_ASSERT(engine.computeBatch(jobs.data(), jobs.size()) == expectedFrames);
+        for (size_t j = 0; j < inputs.size(); ++j) {
+            OATPP_ASSERT(single[j] == batched[j]);
+        }
+    }
+
+    OATPP_LOGI(TAG, "Checking a 1 kHz tone lands in the 1 kHz mel band...");
+    {
+        std::vector<float> audio(N_FFT * 4);
+        for (size_t i = 0; i < audio.size(); ++i) {
+            audio[i] = 0.5f * std::sin(2.0 * M_PI * 1000.0 * i / SAMPLE_RATE);
+        }
+        std::vector<float> mel(numFrames(audio.size()) * N_MELS);
+        MelEngine engine;
+        engine.compute(audio.data(), audio.size(), mel.data());
+
+        auto peak = std::max_element(mel.begin(), mel.begin() + N_MELS) - mel.begin();
+        OATPP_LOGD(TAG, "peak band %ld", (long)peak);
+        // Slaney band 26 is centred on ~1005 Hz
+        OATPP_ASSERT(peak == 26);
+    }
+}
+
+}}}
@@ -0,0 +1,16 @@
+#ifndef MelEngineTest_hpp
+#define MelEngineTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class MelEngineTest : public oatpp::test::UnitTest {
+public:
+    MelEngineTest() : oatpp::test::UnitTest("TEST[MelEngineTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // MelEngineTest_hpp
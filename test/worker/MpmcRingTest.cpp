@@ -0,0 +1,150 @@
+#include "MpmcRingTest.hpp"
+#include "worker/MpmcRing.hpp"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <sched.h>
+#include <new>
+#include <vector>
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+
+namespace {
+
+struct Item {
+    uint32_t producer;
+    uint32_t seq;
+};
+
+constexpr size_t RING_CAPACITY = 64;   // small, so producers lap consumers constantly
+constexpr uint32_t PRODUCERS = 4;
+constexpr uint32_t CONSUMERS = 4;
+constexpr uint32_t ITEMS_PER_PRODUCER = 200000;
+constexpr uint64_t TOTAL_ITEMS = (uint64_t)PRODUCERS * ITEMS_PER_PRODUCER;
+
+// Everything the forked processes share, in one anonymous MAP_SHARED mapping
+struct StressShared {
+    RingHeader header;
+    std::atomic<uint64_t> consumed;
+    std::atomic<uint64_t> duplicates;
+    std::atomic<uint64_t> corrupt;
+    std::atomic<uint8_t> seen[TOTAL_ITEMS];
+};
+
+void produce(MpmcRing<Item>& ring, uint32_t producer) {
+    for (uint32_t seq = 0; seq < ITEMS_PER_PRODUCER; ++seq) {
+        Item item{producer, seq};
+        while (!ring.tryPush(item)) {
+            sched_yield();
+        }
+    }
+}
+
+void consume(MpmcRing<Item>& ring, StressShared* shared) {
+    Item item;
+    while (shared->consumed.load(std::memory_order_relaxed) < TOTAL_ITEMS) {
+        if (!ring.tryPop(item)) {
+            sched_yield();
+            continue;
+        }
+        shared->consumed.fetch_add(1, std::memory_order_relaxed);
+        if (item.producer >= PRODUCERS || item.seq >= ITEMS_PER_PRODUCER) {
+            shared->corrupt.fetch_add(1);
+            continue;
+        }
+        // Every item must come out exactly once
+        if (shared->seen[(uint64_t)item.producer * ITEMS_PER_PRODUCER + item.seq].exchange(1) != 0) {
+            shared->duplicates.fetch_add(1);
+        }
+    }
+}
+
+}
+
+void MpmcRingTest::onRun() {
+    OATPP_LOGI(TAG, "Testing single-threaded FIFO / full / empty...");
+    {
+        RingHeader header;
+        std::vector<uint8_t> cells(MpmcRing<Item>::bytesFor(4));
+        MpmcRing<Item> ring;
+        ring.attach(&header, cells.data(), 4);
+        ring.format();
+
+        Item item;
+        OATPP_ASSERT(!ring.tryPop(item));
+        for (uint32_t i = 0; i < 4; ++i) {
+            OATPP_ASSERT(ring.tryPush(Item{0, i}));
+        }
+        OATPP_ASSERT(!ring.tryPush(Item{0, 4})); // full, nothing gets overwritten
+        OATPP_ASSERT(ring.size() == 4);
+        for (uint32_t i = 0; i < 4; ++i) {
+            OATPP_ASSERT(ring.tryPop(item));
+            OATPP_ASSERT(item.seq == i);
+        }
+        OATPP_ASSERT(!ring.tryPop(item));
+
+        // Wrap around a few laps
+        for (uint32_t i = 0; i < 10; ++i) {
+            OATPP_ASSERT(ring.tryPush(Item{1, i}));
+            OATPP_ASSERT(ring.tryPop(item));
+            OATPP_ASSERT(item.producer == 1 && item.seq == i);
+        }
+    }
+
+    OATPP_LOGI(TAG, "Stress: %u producer + %u consumer processes, %lu items through a %lu-slot ring...",
+               PRODUCERS, CONSUMERS, (unsigned long)TOTAL_ITEMS, (unsigned long)RING_CAPACITY);
+    {
+        size_t sharedBytes = sizeof(StressShared) + MpmcRing<Item>::bytesFor(RING_CAPACITY);
+        void* mem = mmap(nullptr, sharedBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        OATPP_ASSERT(mem != MAP_FAILED);
+
+        // Anonymous mappings come zeroed: seen[] and the counters start at 0
+        StressShared* shared = new (mem) StressShared;
+        void* cells = static_cast<uint8_t*>(mem) + sizeof(StressShared);
+
+        MpmcRing<Item> ring;
+        ring.attach(&shared->header, cells, RING_CAPACITY);
+        ring.format();
+
+        std::vector<pid_t> children;
+        for (uint32_t c = 0; c < CONSUMERS; ++c) {
+            pid_t pid = fork();
+            OATPP_ASSERT(pid >= 0);
+            if (pid == 0) {
+                consume(ring, shared);
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+        for (uint32_t p = 0; p < PRODUCERS; ++p) {
+            pid_t pid = fork();
+            OATPP_ASSERT(pid >= 0);
+            if (pid == 0) {
+                produce(ring, p);
+                _exit(0);
+            }
+            children.push_back(pid);
+        }
+
+        for (pid_t pid : children) {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            OATPP_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+
+        OATPP_ASSERT(shared->consumed.load() == TOTAL_ITEMS);
+        OATPP_ASSERT(shared->duplicates.load() == 0);
+        OATPP_ASSERT(shared->corrupt.load() == 0);
+        for (uint64_t i = 0; i < TOTAL_ITEMS; ++i) {
+            OATPP_ASSERT(shared->seen[i].load() == 1);
+        }
+        OATPP_ASSERT(ring.size() == 0);
+
+        munmap(mem, sharedBytes);
+    }
+}
+
+}}}
@@ -0,0 +1,16 @@
+#ifndef MpmcRingTest_hpp
+#define MpmcRingTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class MpmcRingTest : public oatpp::test::UnitTest {
+public:
+    MpmcRingTest() : oatpp::test::UnitTest("TEST[MpmcRingTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // MpmcRingTest_hpp
@@ -0,0 +1,16 @@
+#ifndef PayloadArenaTest_hpp
+#define PayloadArenaTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class PayloadArenaTest : public oatpp::test::UnitTest {
+public:
+    PayloadArenaTest() : oatpp::test::UnitTest("TEST[PayloadArenaTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // PayloadArenaTest_hpp
@@ -0,0 +1,98 @@
+#include "PrioritySchedulingTest.hpp"
+#include "worker/IPC.hpp"
+
+#include <string>
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+
+namespace {
+
+ReqSlot request(uint64_t taskId, TaskPriority priority) {
+    ReqSlot req = {};
+    req.task_id = taskId;
+    req.type = TASK_TEXT_PROCESS;
+    req.priority = priority;
+    return req;
+}
+
+// Pops everything queued, as a worker would, and returns the classes in pick order
+std::string drain(IPC& worker) {
+    std::string order;
+    ReqSlot req;
+    while (worker.pollRequest(req, std::chrono::microseconds(0))) {
+        order += "inb"[req.priority];
+    }
+    return order;
+}
+
+size_t count(const std::string& order, size_t picks, char cls) {
+    size_t n = 0;
+    for (size_t i = 0; i < picks && i < order.size(); ++i) {
+        if (order[i] == cls) ++n;
+    }
+    return n;
+}
+
+}
+
+void PrioritySchedulingTest::onRun() {
+    IpcConfig config;
+    config.ringCapacity = 64;
+    config.arenaBytes = 1 << 20;
+    config.maxPayloadBytes = 1 << 16;
+    config.priorityWeights[PRIORITY_INTERACTIVE] = 8;
+    config.priorityWeights[PRIORITY_NORMAL] = 4;
+    config.priorityWeights[PRIORITY_BATCH] = 1;
+
+    IPC host;
+    host.initHost(config);
+    IPC worker;
+    worker.initWorker();
+
+    OATPP_LOGI(TAG, "Testing that interactive work overtakes a batch backlog...");
+    {
+        // Batch was there first, yet only 1 pick in 9 goes to it while both have work
+        for (uint64_t i = 0; i < 20; ++i) OATPP_ASSERT(host.submitRequest(request(i + 1, PRIORITY_BATCH)));
+        for (uint64_t i = 0; i < 16; ++i) OATPP_ASSERT(host.submitRequest(request(i + 100, PRIORITY_INTERACTIVE)));
+        OATPP_ASSERT(worker.requestDepth(PRIORITY_BATCH) == 20);
+        OATPP_ASSERT(worker.requestDepth(PRIORITY_INTERACTIVE) == 16);
+
+        std::string order = drain(worker);
+        OATPP_ASSERT(order.size() == 36);
+        OATPP_ASSERT(count(order, 18, 'i') == 16);
+        OATPP_ASSERT(order.substr(18) == std::string(18, 'b'));
+    }
+
+    OATPP_LOGI(TAG, "Testing weighted shares with every class busy...");
+    {
+        for (uint64_t i = 0; i < 26; ++i) {
+            OATPP_ASSERT(host.submitRequest(request(i + 1, PRIORITY_BATCH)));
+            OATPP_ASSERT(host.submitRequest(request(i + 100, PRIORITY_NORMAL)));
+            OATPP_ASSERT(host.submitRequest(request(i + 200, PRIORITY_INTERACTIVE)));
+        }
+        std::string order = drain(worker);
+        OATPP_ASSERT(order.size() == 78);
+
+        // Three rounds of 13 picks: 8 / 4 / 1 each (give or take the credit left over
+        // from the last test), so batch keeps moving even with everything else busy
+        size_t interactive = count(order, 39, 'i');
+        size_t normal = count(order, 39, 'n');
+        size_t batch = count(order, 39, 'b');
+        OATPP_LOGD(TAG, "first 39 picks: %lu / %lu / %lu", (unsigned long)interactive, (unsigned long)normal, (unsigned long)batch);
+        OATPP_ASSERT(interactive >= 23 && interactive <= 25);
+        OATPP_ASSERT(normal >= 11 && normal <= 13);
+        OATPP_ASSERT(batch >= 2 && batch <= 4);
+    }
+
+    OATPP_LOGI(TAG, "Testing an out-of-range class is refused...");
+    {
+        OATPP_ASSERT(!host.submitRequest(request(1, (TaskPriority)NUM_PRIORITIES)));
+    }
+
+    worker.cleanup();
+    host.cleanup();
+}
+
+}}}
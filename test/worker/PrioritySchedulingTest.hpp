@@ -0,0 +1,16 @@
+#ifndef PrioritySchedulingTest_hpp
+#define PrioritySchedulingTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class PrioritySchedulingTest : public oatpp::test::UnitTest {
+public:
+    PrioritySchedulingTest() : oatpp::test::UnitTest("TEST[PrioritySchedulingTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // PrioritySchedulingTest_hpp
@@ -0,0 +1,73 @@
+#include "StreamSessionTableTest.hpp"
+#include "worker/StreamSessionTable.hpp"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+
+void StreamSessionTableTest::onRun() {
+    // Heap memory stands in for the SHM segment
+    auto shm = std::unique_ptr<SharedMem>(new SharedMem());
+    StreamSessionTable table;
+    table.attach(shm.get());
+    using Status = StreamSessionTable::Status;
+
+    OATPP_LOGI(TAG, "Testing open / acquire / release / close...");
+    {
+        uint64_t id = 0;
+        OATPP_ASSERT(table.open(id) == Status::OK);
+        uint32_t slot = 0;
+        OATPP_ASSERT(table.acquire(id, slot) == Status::OK);
+        uint32_t other = 0;
+        OATPP_ASSERT(table.acquire(id, other) == Status::BUSY);
+        uint64_t frames = 0;
+        OATPP_ASSERT(table.close(id, frames) == Status::BUSY);
+        table.release(slot);
+        OATPP_ASSERT(table.close(id, frames) == Status::OK);
+        OATPP_ASSERT(table.acquire(id, slot) == Status::NOT_FOUND);
+    }
+
+    OATPP_LOGI(TAG, "Testing an append that outlives its deadline...");
+    {
+        uint64_t id = 0;
+        OATPP_ASSERT(table.open(id) == Status::OK);
+        uint32_t slot = 0;
+        OATPP_ASSERT(table.acquire(id, slot) == Status::OK);
+
+        // Idle sessions and appends within the timeout are left alone
+        uint64_t idle = 0;
+        OATPP_ASSERT(table.open(idle) == Status::OK);
+        OATPP_ASSERT(table.expire(60ULL * 1000 * 1000 * 1000) == 0);
+        OATPP_ASSERT(table.expire(0) == 0);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        OATPP_ASSERT(table.expire(1000 * 1000) == 1);
+        OATPP_ASSERT(table.expire(1000 * 1000) == 0);
+
+        // Closed for its owner, but the worker may still be writing the carry: the slot stays taken
+        uint64_t frames = 0;
+        OATPP_ASSERT(table.acquire(id, slot) == Status::NOT_FOUND);
+        OATPP_ASSERT(table.close(id, frames) == Status::NOT_FOUND);
+        OATPP_ASSERT(shm->stream_sessions[slot].state.load() == SESSION_BUSY);
+
+        // The late answer frees it
+        table.release(slot);
+        OATPP_ASSERT(shm->stream_sessions[slot].state.load() == SESSION_FREE);
+        uint64_t reopened = 0;
+        OATPP_ASSERT(table.open(reopened) == Status::OK);
+
+        uint32_t idleSlot = 0;
+        OATPP_ASSERT(table.acquire(idle, idleSlot) == Status::OK);
+        table.release(idleSlot);
+        OATPP_ASSERT(table.close(idle, frames) == Status::OK);
+        OATPP_ASSERT(table.close(reopened, frames) == Status::OK);
+    }
+
+    table.attach(nullptr);
+}
+
+}}}
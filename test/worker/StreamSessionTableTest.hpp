@@ -0,0 +1,16 @@
+#ifndef StreamSessionTableTest_hpp
+#define StreamSessionTableTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class StreamSessionTableTest : public oatpp::test::UnitTest {
+public:
+    StreamSessionTableTest() : oatpp::test::UnitTest("TEST[StreamSessionTableTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // StreamSessionTableTest_hpp
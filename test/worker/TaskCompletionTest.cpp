@@ -0,0 +1,110 @@
+#include "TaskCompletionTest.hpp"
+#include "worker/TaskCompletion.hpp"
+#include "oatpp/core/async/Executor.hpp"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+
+namespace {
+
+// Stands in for an ENDPOINT_ASYNC handler waiting on a worker result
+class AwaitCoroutine : public oatpp::async::Coroutine<AwaitCoroutine> {
+private:
+    std::shared_ptr<TaskCompletion> m_completion;
+    std::atomic<int>* m_done;
+public:
+    AwaitCoroutine(const std::shared_ptr<TaskCompletion>& completion, std::atomic<int>* done)
+        : m_completion(completion)
+        , m_done(done)
+    {}
+
+    Action act() override {
+        if (!m_completion->isReady()) {
+            return Action::createWaitListAction(m_completion->waitList());
+        }
+        TaskResult result = m_completion->take();
+        if (result.resp.status_code == 0) {
+            (*m_done)++;
+        }
+        return finish();
+    }
+};
+
+class TickCoroutine : public oatpp::async::Coroutine<TickCoroutine> {
+private:
+    std::atomic<bool>* m_ran;
+public:
+    TickCoroutine(std::atomic<bool>* ran) : m_ran(ran) {}
+
+    Action act() override {
+        *m_ran = true;
+        return finish();
+    }
+};
+
+TaskResult okResult(uint64_t taskId) {
+    RespSlot resp = {};
+    resp.task_id = taskId;
+    return TaskResult{resp, PayloadLease()};
+}
+
+}
+
+void TaskCompletionTest::onRun() {
+    OATPP_LOGI(TAG, "Testing blocking wait...");
+    {
+        auto completion = std::make_shared<TaskCompletion>();
+        OATPP_ASSERT(!completion->isReady());
+        std::thread responder([completion] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            completion->complete(okResult(7));
+        });
+        completion->wait();
+        OATPP_ASSERT(completion->isReady());
+        OATPP_ASSERT(completion->take().resp.task_id == 7);
+        responder.join();
+    }
+
+    OATPP_LOGI(TAG, "Testing 1000 suspended coroutines on one processor thread...");
+    {
+        constexpr int IN_FLIGHT = 1000;
+        oatpp::async::Executor executor(1, 1, 1);
+
+        std::vector<std::shared_ptr<TaskCompletion>> completions;
+        std::atomic<int> done(0);
+        for (int i = 0; i < IN_FLIGHT; ++i) {
+            completions.push_back(std::make_shared<TaskCompletion>());
+            executor.execute<AwaitCoroutine>(completions.back(), &done);
+        }
+
+        // Everyone is parked on a wait list, so unrelated work still gets the thread
+        std::atomic<bool> ticked(false);
+        executor.execute<TickCoroutine>(&ticked);
+        for (int i = 0; i < 1000 && !ticked; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        OATPP_ASSERT(ticked);
+        OATPP_ASSERT(done == 0);
+
+        // Complete from another thread (like the response loop), racing the coroutines' checks
+        std::thread responder([&completions] {
+            for (size_t i = 0; i < completions.size(); ++i) {
+                completions[i]->complete(okResult(i));
+            }
+        });
+        responder.join();
+
+        executor.waitTasksFinished();
+        OATPP_ASSERT(done == IN_FLIGHT);
+
+        executor.stop();
+        executor.join();
+    }
+}
+
+}}}
@@ -0,0 +1,16 @@
+#ifndef TaskCompletionTest_hpp
+#define TaskCompletionTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class TaskCompletionTest : public oatpp::test::UnitTest {
+public:
+    TaskCompletionTest() : oatpp::test::UnitTest("TEST[TaskCompletionTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // TaskCompletionTest_hpp
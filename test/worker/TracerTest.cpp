@@ -0,0 +1,138 @@
+#include "TracerTest.hpp"
+#include "worker/Tracer.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace app { namespace test { namespace worker {
+
+using namespace app::worker;
+
+namespace {
+
+// Far above anything the completion table hands out in the other tests
+constexpr uint64_t TASK_BASE = 1ULL << 60;
+
+size_t countOf(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+}
+
+void TracerTest::onRun() {
+    OATPP_LOGI(TAG, "Testing trace ring...");
+    {
+        auto ring = std::make_unique<TraceRing>();   // value-initialized: empty
+        std::vector<TraceSpan> spans;
+        ring->read(0, 0, 0, spans);
+        OATPP_ASSERT(spans.empty());
+
+        ring->push(TRACE_COMPUTE, 7, 100, 250);
+        ring->push(TRACE_QUEUE, 8, 300, 200);   // end before start: zero length
+        ring->read(0, 2, 5, spans);
+        OATPP_ASSERT(spans.size() == 2);
+        OATPP_ASSERT(spans[0].taskId == 7 && spans[0].stage == TRACE_COMPUTE);
+        OATPP_ASSERT(spans[0].startNs == 100 && spans[0].durNs == 150);
+        OATPP_ASSERT(spans[0].process == 2 && spans[0].thread == 5);
+        OATPP_ASSERT(spans[1].durNs == 0);
+
+        // sinceNs filters on the end of the span
+        spans.clear();
+        ring->read(260, 0, 0, spans);
+        OATPP_ASSERT(spans.size() == 1 && spans[0].taskId == 8);
+
+        // Wrapped: only the newest capacity - 1 spans are certain not to be overwritten
+        for (uint64_t i = 0; i < 3 * TRACE_RING_CAPACITY; ++i) {
+            ring->push(TRACE_ENQUEUE, i, 1000 + i, 1001 + i);
+        }
+        spans.clear();
+        ring->read(0, 0, 0, spans);
+        OATPP_ASSERT(spans.size() == TRACE_RING_CAPACITY - 1);
+        OATPP_ASSERT(spans.back().taskId == 3 * TRACE_RING_CAPACITY - 1);
+        OATPP_ASSERT(spans.front().taskId == 2 * TRACE_RING_CAPACITY + 1);
+    }
+
+    OATPP_LOGI(TAG, "Testing sampling...");
+    {
+        OATPP_ASSERT(!traceSampled(1, 0));
+        OATPP_ASSERT(traceSampled(12345, 1));
+
+        // Deterministic, and close to 1 in N over consecutive ids
+        size_t sampled = 0;
+        for (uint64_t id = 1; id <= 100000; ++id) {
+            bool first = traceSampled(id, 100);
+            OATPP_ASSERT(first == traceSampled(id, 100));
+            sampled += first ? 1 : 0;
+        }
+        OATPP_ASSERT(sampled > 800 && sampled < 1200);
+    }
+
+    OATPP_LOGI(TAG, "Testing host collection...");
+    {
+        uint32_t previous = Tracer::sampleEvery();
+        Tracer::setSampleEvery(1);
+
+        Tracer::record(TRACE_ENQUEUE, TASK_BASE + 1, 1000, 2000);
+        std::thread other([] {
+            Tracer::record(TRACE_DISPATCH, TASK_BASE + 1, 9000, 9500);
+        });
+        other.join();
+
+        Tracer::setSampleEvery(0);
+        Tracer::record(TRACE_SERIALIZE, TASK_BASE + 1, 9500, 9600);   // tracing off: dropped
+        Tracer::setSampleEvery(previous);
+
+        std::vector<TraceSpan> spans;
+        Tracer::collect(0, spans);
+        spans.erase(std::remove_if(spans.begin(), spans.end(), [](const TraceSpan& span) {
+            return span.taskId != TASK_BASE + 1;
+        }), spans.end());
+        OATPP_ASSERT(spans.size() == 2);
+        OATPP_ASSERT(spans[0].process == 0 && spans[1].process == 0);
+        OATPP_ASSERT(spans[0].thread != spans[1].thread);
+    }
+
+    OATPP_LOGI(TAG, "Testing Chrome trace export...");
+    {
+        std::vector<TraceSpan> spans = {
+            {1000, 500, 42, TRACE_ENQUEUE, 0, 1},
+            {1500, 2000, 42, TRACE_QUEUE, 3, 0},
+            {3500, 4000, 42, TRACE_COMPUTE, 3, 0},
+            {7500, 250, 42, TRACE_DISPATCH, 0, 2},
+            {8000, 100, 43, TRACE_COMPUTE, 1, 0},   // no enqueue or dispatch: no flows
+        };
+        std::string json = Tracer::toChromeJson(spans);
+
+        OATPP_ASSERT(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+        OATPP_ASSERT(json.find("\"pid\":3,\"args\":{\"name\":\"worker 2\"}") != std::string::npos);
+        OATPP_ASSERT(countOf(json, "\"name\":\"process_name\"") == 3);   // host, workers 0 and 2
+        OATPP_ASSERT(countOf(json, "\"ph\":\"X\"") == 5);
+        OATPP_ASSERT(json.find("{\"name\":\"compute\",\"cat\":\"worker\",\"ph\":\"X\",\"pid\":3,\"tid\":0,"
+                               "\"ts\":3.500,\"dur\":4.000,\"args\":{\"task_id\":42}}") != std::string::npos);
+
+        // Enqueue end -> compute start, compute end -> dispatch start
+        OATPP_ASSERT(json.find("\"ph\":\"s\",\"id\":\"42.request\",\"pid\":0,\"tid\":1,\"ts\":1.500}") != std::string::npos);
+        OATPP_ASSERT(json.find("\"ph\":\"f\",\"bp\":\"e\",\"id\":\"42.request\",\"pid\":3,\"tid\":0,\"ts\":3.500}") != std::string::npos);
+        OATPP_ASSERT(json.find("\"ph\":\"s\",\"id\":\"42.reply\",\"pid\":3,\"tid\":0,\"ts\":7.500}") != std::string::npos);
+        OATPP_ASSERT(json.find("\"ph\":\"f\",\"bp\":\"e\",\"id\":\"42.reply\",\"pid\":0,\"tid\":2,\"ts\":7.500}") != std::string::npos);
+        OATPP_ASSERT(countOf(json, "\"cat\":\"task\"") == 4);
+        OATPP_ASSERT(json.find("43.") == std::string::npos);
+
+        // Compute started before the enqueue span ended: the arrow starts at the compute instead
+        spans[0].durNs = 3000;
+        json = Tracer::toChromeJson(spans);
+        OATPP_ASSERT(json.find("\"ph\":\"s\",\"id\":\"42.request\",\"pid\":0,\"tid\":1,\"ts\":3.500}") != std::string::npos);
+
+        std::string empty = Tracer::toChromeJson({});
+        OATPP_ASSERT(countOf(empty, "\"name\":\"process_name\"") == 1);
+        OATPP_ASSERT(empty.find("\"ph\":\"X\"") == std::string::npos);
+    }
+}
+
+}}}
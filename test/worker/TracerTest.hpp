@@ -0,0 +1,16 @@
+#ifndef TracerTest_hpp
+#define TracerTest_hpp
+
+#include "oatpp-test/UnitTest.hpp"
+
+namespace app { namespace test { namespace worker {
+
+class TracerTest : public oatpp::test::UnitTest {
+public:
+    TracerTest() : oatpp::test::UnitTest("TEST[TracerTest]") {}
+    void onRun() override;
+};
+
+}}}
+
+#endif // TracerTest_hpp